@@ -0,0 +1,209 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file exampleIndexFileBuilder.cpp @brief Index file builder benchmark. */
+
+// Include std.
+#include <cstring>
+#include <random>
+
+// Include 3D Forest.
+#include <ArgumentParser.hpp>
+#include <Error.hpp>
+#include <IndexFileBuilder.hpp>
+#include <Time.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "exampleIndexFileBuilder"
+#include <Log.hpp>
+
+#define SCALE 0.001
+
+// Create synthetic LAS file with uniformly distributed points.
+static void createDataSet(const std::string &path, uint64_t nPoints)
+{
+    // Plot 100 x 100 x 30 meters in millimeters.
+    const int32_t sizeXY = 100 * 1000;
+    const int32_t sizeZ = 30 * 1000;
+
+    Box<int32_t> box(0, 0, 0, sizeXY, sizeXY, sizeZ);
+
+    LasFile las;
+    las.create(path);
+    las.header.set(nPoints, box, {SCALE, SCALE, SCALE}, {0, 0, 0}, 7);
+    las.writeHeader();
+
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int32_t> distXY(0, sizeXY);
+    std::uniform_int_distribution<int32_t> distZ(0, sizeZ);
+
+    const uint64_t nPointsPerStep = 1000000;
+    size_t pointSize = las.header.point_data_record_length;
+    std::vector<uint8_t> buffer;
+    buffer.resize(nPointsPerStep * pointSize);
+
+    LasFile::Point pt;
+    std::memset(&pt, 0, sizeof(pt));
+    pt.format = las.header.point_data_record_format;
+    pt.classification = LasFile::CLASS_UNASSIGNED;
+
+    uint64_t nPointsWritten = 0;
+    while (nPointsWritten < nPoints)
+    {
+        uint64_t n = nPoints - nPointsWritten;
+        if (n > nPointsPerStep)
+        {
+            n = nPointsPerStep;
+        }
+
+        for (uint64_t i = 0; i < n; i++)
+        {
+            pt.x = distXY(gen);
+            pt.y = distXY(gen);
+            pt.z = distZ(gen);
+            pt.intensity = static_cast<uint16_t>(pt.z);
+            pt.red = static_cast<uint16_t>(pt.x);
+            pt.green = static_cast<uint16_t>(pt.y);
+            pt.blue = static_cast<uint16_t>(pt.z);
+            las.formatPointToBytes(buffer.data() + (i * pointSize), pt);
+        }
+
+        las.writeBuffer(buffer.data(), n * pointSize);
+        nPointsWritten += n;
+    }
+
+    las.close();
+}
+
+static void exampleIndexFileBuilder(const std::string &path,
+                                    uint64_t nPoints,
+                                    bool randomize,
+                                    const std::string &method,
+                                    size_t sortBufferSize,
+                                    size_t nThreads,
+                                    bool compress)
+{
+    std::cout << "create <" << nPoints << "> points in <" << path << ">"
+              << std::endl;
+    createDataSet(path, nPoints);
+
+    ImportSettings settings;
+    settings.randomizePoints = randomize;
+    if (method == "shuffle")
+    {
+        settings.randomizeMethod = ImportSettings::RandomizeMethod::SHUFFLE;
+    }
+    else if (method == "stride")
+    {
+        settings.randomizeMethod = ImportSettings::RandomizeMethod::STRIDE;
+    }
+    else
+    {
+        THROW("Unknown randomization method '" + method + "'");
+    }
+    settings.sortBufferSize = sortBufferSize * 1024 * 1024;
+    settings.numberOfThreads = nThreads;
+    settings.compressPages = compress;
+    settings.terminalOutput = true;
+
+    double t1 = Time::realTime();
+    IndexFileBuilder::index(path, path, settings);
+    double t2 = Time::realTime();
+
+    LasFile las;
+    las.open(path);
+    las.readHeader();
+    uint64_t nBytes = las.header.pointDataSize();
+    las.close();
+
+    double seconds = t2 - t1;
+    double megabytes = static_cast<double>(nBytes) / (1024.0 * 1024.0);
+
+    std::cout << "point data <" << megabytes << "> MB" << std::endl;
+    if (compress)
+    {
+        File pages;
+        pages.open(PageFile::extension(path));
+        uint64_t nBytesPages = pages.size();
+        pages.close();
+        double ratio = static_cast<double>(nBytes) /
+                       static_cast<double>(nBytesPages > 0 ? nBytesPages : 1);
+        std::cout << "page data <"
+                  << static_cast<double>(nBytesPages) / (1024.0 * 1024.0)
+                  << "> MB" << std::endl;
+        std::cout << "compression ratio <" << ratio << ">" << std::endl;
+    }
+    std::cout << "time <" << seconds << "> s" << std::endl;
+    std::cout << "throughput <" << (megabytes / seconds) << "> MB/s"
+              << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ArgumentParser arg("index file builder benchmark");
+        arg.add("-f",
+                "--file",
+                "benchmark.las",
+                "Path to the synthetic LAS file to be created and indexed.");
+        arg.add("-n",
+                "--points",
+                "100000000",
+                "Number of points in the synthetic LAS file.");
+        arg.add("-r",
+                "--randomize",
+                "true",
+                "Randomize point order during import {true, false}.");
+        arg.add("-m",
+                "--method",
+                "shuffle",
+                "Randomization method {shuffle, stride}.");
+        arg.add("-s",
+                "--sort-buffer",
+                "256",
+                "Size of memory buffer for sorting points [MB].");
+        arg.add("-t",
+                "--threads",
+                "0",
+                "Number of threads, 0 uses all hardware threads.");
+        arg.add("-c",
+                "--compress",
+                "false",
+                "Create compressed page file {true, false}.");
+
+        if (arg.parse(argc, argv))
+        {
+            exampleIndexFileBuilder(arg.toString("--file"),
+                                    arg.toUint64("--points"),
+                                    arg.toBool("--randomize"),
+                                    arg.toString("--method"),
+                                    arg.toSize("--sort-buffer"),
+                                    arg.toSize("--threads"),
+                                    arg.toBool("--compress"));
+        }
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file examplePageFilter.cpp @brief Page filter benchmark. */
+
+// Include std.
+#include <cstdlib>
+#include <random>
+
+// Include 3D Forest.
+#include <Error.hpp>
+#include <PageFilter.hpp>
+#include <Time.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "examplePageFilter"
+#include <Log.hpp>
+
+static void examplePageFilterPrint(const char *name,
+                                   double timeScalar,
+                                   double timeVector,
+                                   size_t nScalar,
+                                   size_t nVector)
+{
+    std::cout << name << " scalar <" << timeScalar << "> s vector <"
+              << timeVector << "> s speedup <" << (timeScalar / timeVector)
+              << "> selected <" << nScalar << "/" << nVector << ">"
+              << std::endl;
+
+    if (nScalar != nVector)
+    {
+        THROW("Scalar and vectorized filters select different points.");
+    }
+}
+
+static void examplePageFilter(size_t nPoints, size_t nRuns)
+{
+    std::cout << "Instruction set <" << PageFilter::instructionSet()
+              << "> points <" << nPoints << "> runs <" << nRuns << ">"
+              << std::endl;
+
+    // Random points in 100 x 100 x 100 m cube with millimeter units.
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int32_t> distribution(0, 100000);
+
+    std::vector<int32_t> position(nPoints * 3);
+    for (size_t i = 0; i < position.size(); i++)
+    {
+        position[i] = distribution(generator);
+    }
+
+    std::vector<uint32_t> selection(nPoints);
+    Vector3<double> translation(1000.0, 2000.0, 300.0);
+
+    // Regions around the center of points.
+    double cx = translation[0] + 50000.0;
+    double cy = translation[1] + 50000.0;
+    double cz = translation[2] + 50000.0;
+    double r = 30000.0;
+
+    Box<double> box(cx - r, cy - r, cz - r, cx + r, cy + r, cz + r);
+    Sphere<double> sphere(cx, cy, cz, r);
+    Cylinder<double> cylinder;
+    cylinder.set(cx, cy, cz - r, cx, cy, cz + r, r);
+    Cone<double> cone;
+    cone.set(cx, cy, cz + r, cz - r, 30.0);
+
+    // Run.
+    for (int i = 0; i < 4; i++)
+    {
+        double time[2];
+        size_t n[2];
+
+        for (int k = 0; k < 2; k++)
+        {
+            bool vectorized = (k == 1);
+            double t = Time::realTime();
+
+            for (size_t run = 0; run < nRuns; run++)
+            {
+                uint32_t *s = selection.data();
+                const int32_t *p = position.data();
+
+                switch (i)
+                {
+                    case 0:
+                        n[k] = PageFilter::box(s,
+                                               p,
+                                               0,
+                                               nPoints,
+                                               translation,
+                                               box,
+                                               vectorized);
+                        break;
+                    case 1:
+                        n[k] = PageFilter::sphere(s,
+                                                  p,
+                                                  0,
+                                                  nPoints,
+                                                  translation,
+                                                  sphere,
+                                                  vectorized);
+                        break;
+                    case 2:
+                        n[k] = PageFilter::cylinder(s,
+                                                    p,
+                                                    0,
+                                                    nPoints,
+                                                    translation,
+                                                    cylinder,
+                                                    vectorized);
+                        break;
+                    case 3:
+                    default:
+                        n[k] = PageFilter::cone(s,
+                                                p,
+                                                0,
+                                                nPoints,
+                                                translation,
+                                                cone,
+                                                vectorized);
+                        break;
+                }
+            }
+
+            time[k] = Time::realTime() - t;
+        }
+
+        const char *names[4] = {"box", "sphere", "cylinder", "cone"};
+        examplePageFilterPrint(names[i], time[0], time[1], n[0], n[1]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nPoints = 1000000;
+    size_t nRuns = 20;
+
+    if (argc > 1)
+    {
+        nPoints = static_cast<size_t>(std::atoll(argv[1]));
+    }
+
+    if (argc > 2)
+    {
+        nRuns = static_cast<size_t>(std::atoll(argv[2]));
+    }
+
+    try
+    {
+        examplePageFilter(nPoints, nRuns);
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
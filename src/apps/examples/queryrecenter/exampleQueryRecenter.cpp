@@ -0,0 +1,166 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file exampleQueryRecenter.cpp @brief Query re-center benchmark. */
+
+// Include std.
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// Include 3D Forest.
+#include <Editor.hpp>
+#include <Error.hpp>
+#include <IndexFileBuilder.hpp>
+#include <Time.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "exampleQueryRecenter"
+#include <Log.hpp>
+
+#define DATA_PATH "exampledataset.las"
+
+static void createDataSet(size_t nPoints)
+{
+    // Random points in 20 x 20 x 20 m cube with millimeter units.
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int32_t> distribution(0, 20000);
+
+    std::vector<LasFile::Point> points;
+    points.resize(nPoints);
+    std::memset(points.data(), 0, sizeof(LasFile::Point) * points.size());
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].x = distribution(generator);
+        points[i].y = distribution(generator);
+        points[i].z = distribution(generator);
+    }
+
+    LasFile::create(DATA_PATH, points, {0.001, 0.001, 0.001}, {0, 0, 0});
+
+    ImportSettings settings;
+    IndexFileBuilder::index(DATA_PATH, DATA_PATH, settings);
+}
+
+static void exampleQueryRecenter(size_t nQueries, double radius, double step)
+{
+    Editor editor;
+    editor.open(DATA_PATH);
+
+    // Sphere centers on a random walk with small steps in point units.
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> distribution(-step, step);
+
+    std::vector<double> centers(nQueries * 3);
+    double c[3] = {10000.0, 10000.0, 10000.0};
+    for (size_t i = 0; i < nQueries; i++)
+    {
+        for (size_t k = 0; k < 3; k++)
+        {
+            c[k] += distribution(generator);
+            c[k] = std::min(20000.0, std::max(0.0, c[k]));
+            centers[i * 3 + k] = c[k];
+        }
+    }
+
+    // Run.
+    double time[2];
+    size_t n[2];
+    size_t nPages[2];
+
+    for (int k = 0; k < 2; k++)
+    {
+        bool recenter = (k == 1);
+
+        Query query(&editor);
+        n[k] = 0;
+        nPages[k] = 0;
+
+        double t = Time::realTime();
+
+        for (size_t i = 0; i < nQueries; i++)
+        {
+            const double *p = &centers[i * 3];
+
+            if (recenter)
+            {
+                query.recenter(p[0], p[1], p[2], radius);
+            }
+            else
+            {
+                query.where().setSphere(p[0], p[1], p[2], radius);
+                query.exec();
+            }
+
+            nPages[k] += query.selectedPages().size();
+
+            while (query.next())
+            {
+                n[k]++;
+            }
+        }
+
+        time[k] = Time::realTime() - t;
+    }
+
+    std::cout << "queries <" << nQueries << "> radius <" << radius
+              << "> step <" << step << ">" << std::endl;
+    std::cout << "exec <" << (static_cast<double>(nQueries) / time[0])
+              << "> queries/s recenter <"
+              << (static_cast<double>(nQueries) / time[1])
+              << "> queries/s speedup <" << (time[0] / time[1])
+              << "> points <" << n[0] << "/" << n[1] << "> pages <"
+              << nPages[0] << "/" << nPages[1] << ">" << std::endl;
+
+    if (n[0] != n[1])
+    {
+        THROW("Exec and recenter select different points.");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nPoints = 1000000;
+    size_t nQueries = 10000;
+
+    if (argc > 1)
+    {
+        nPoints = static_cast<size_t>(std::atoll(argv[1]));
+    }
+
+    if (argc > 2)
+    {
+        nQueries = static_cast<size_t>(std::atoll(argv[2]));
+    }
+
+    try
+    {
+        createDataSet(nPoints);
+        exampleQueryRecenter(nQueries, 100.0, 50.0);
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,219 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file import.cpp @brief Batch import tool. */
+
+// Include std.
+#include <algorithm>
+#include <fstream>
+#include <regex>
+
+// Include 3D Forest.
+#include <ArgumentParser.hpp>
+#include <Editor.hpp>
+#include <Error.hpp>
+#include <IndexFileBuilder.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "import"
+#include <Log.hpp>
+
+static std::vector<std::string> importListFiles(const std::string &inputPath)
+{
+    std::vector<std::string> paths;
+
+    if (std::filesystem::is_directory(inputPath))
+    {
+        // All LAS files in the directory.
+        std::regex pattern(".*\\.las", std::regex_constants::icase);
+        for (const auto &fileName : File::listFiles(inputPath, pattern))
+        {
+            paths.push_back(File::join(inputPath, fileName));
+        }
+
+        std::sort(paths.begin(), paths.end());
+    }
+    else if (toLower(File::fileExtension(inputPath)) == "las")
+    {
+        // Single LAS file.
+        paths.push_back(inputPath);
+    }
+    else
+    {
+        // Text file with one LAS file path per line.
+        std::ifstream file(inputPath);
+        if (!file.good())
+        {
+            THROW("Can't open file list '" + inputPath + "'");
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (!line.empty())
+            {
+                paths.push_back(File::resolvePath(line, inputPath));
+            }
+        }
+    }
+
+    // Use absolute paths in the project file.
+    for (auto &path : paths)
+    {
+        if (!File::absolute(path))
+        {
+            path = File::join(File::currentPath(), path);
+        }
+    }
+
+    return paths;
+}
+
+static size_t importFiles(const std::string &inputPath,
+                          const std::string &outputPath,
+                          size_t nFiles,
+                          size_t nThreads,
+                          bool randomize,
+                          bool compress)
+{
+    std::vector<std::string> paths = importListFiles(inputPath);
+    if (paths.empty())
+    {
+        THROW("No LAS files found in '" + inputPath + "'");
+    }
+
+    ImportSettings settings;
+    settings.randomizePoints = randomize;
+    settings.compressPages = compress;
+    settings.numberOfFiles = nFiles;
+    settings.numberOfThreads = nThreads;
+    settings.terminalOutput = true;
+
+    // Index all files concurrently.
+    std::cout << "index <" << paths.size() << "> files" << std::endl;
+    std::vector<std::string> errors;
+    IndexFileBuilder::index(paths, settings, errors);
+
+    // Create one project with all files which were indexed.
+    Editor editor;
+    size_t nFailed = 0;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        if (errors[i].empty())
+        {
+            try
+            {
+                editor.open(paths[i], settings);
+            }
+            catch (std::exception &e)
+            {
+                errors[i] = e.what();
+            }
+        }
+
+        if (!errors[i].empty())
+        {
+            std::cerr << "error: file <" << paths[i] << ">: " << errors[i]
+                      << std::endl;
+            nFailed++;
+        }
+    }
+
+    if (nFailed == paths.size())
+    {
+        THROW("No LAS file was imported");
+    }
+
+    editor.saveProject(outputPath);
+    std::cout << "project <" << outputPath << "> with <"
+              << (paths.size() - nFailed) << "> files, <" << nFailed
+              << "> failed" << std::endl;
+
+    return nFailed;
+}
+
+int main(int argc, char *argv[])
+{
+    int rc = 1;
+
+    LOGGER_START_FILE("log_import.txt");
+
+    try
+    {
+        ArgumentParser arg("indexes many LAS files and creates one project");
+        arg.add("-i",
+                "--input",
+                "",
+                "Path to a LAS file, a directory with LAS files, or a text "
+                "file with one LAS file path per line.",
+                true);
+        arg.add("-o",
+                "--output",
+                "",
+                "Path to the output .json project file.",
+                true);
+        arg.add("-j",
+                "--files",
+                "0",
+                "Number of files indexed at once, 0 uses the number of "
+                "threads.");
+        arg.add("-t",
+                "--threads",
+                "0",
+                "Number of threads, 0 uses all hardware threads.");
+        arg.add("-r",
+                "--randomize",
+                "true",
+                "Randomize point order during import {true, false}.");
+        arg.add("-c",
+                "--compress",
+                "false",
+                "Create compressed page file for faster reading {true, "
+                "false}.");
+
+        size_t nFailed = 0;
+        if (arg.parse(argc, argv))
+        {
+            nFailed = importFiles(arg.toString("--input"),
+                                  arg.toString("--output"),
+                                  arg.toSize("--files"),
+                                  arg.toSize("--threads"),
+                                  arg.toBool("--randomize"),
+                                  arg.toBool("--compress"));
+        }
+
+        if (nFailed == 0)
+        {
+            rc = 0;
+        }
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+    }
+
+    LOGGER_STOP_FILE;
+
+    return rc;
+}
@@ -36,11 +36,16 @@
 
 static void segmentationCompute(
     const std::string &inputPath,
-    const ComputeSegmentationNNParameters &parameters)
+    const ComputeSegmentationNNParameters &parameters,
+    size_t cacheSize)
 {
     // Open input file in editor.
     Editor editor;
     editor.open(inputPath);
+    if (cacheSize > 0)
+    {
+        editor.setPageCacheSizeMaximum(cacheSize * 1048576);
+    }
 
     // Repeatedly call tree segmentation until it is complete.
     ComputeSegmentationNNAction segmentation(&editor);
@@ -51,6 +56,13 @@ static void segmentationCompute(
     }
 
     editor.saveProject(editor.projectPath());
+
+    PageManager::Statistics statistics = editor.pageCacheStatistics();
+    std::cout << "cached pages      : " << statistics.nPages << std::endl;
+    std::cout << "cache size [MB]   : "
+              << statistics.cacheSizeInMemory / 1048576 << std::endl;
+    std::cout << "evicted pages     : " << statistics.nEvictions << std::endl;
+    std::cout << "written pages     : " << statistics.nWrites << std::endl;
 }
 
 int main(int argc, char *argv[])
@@ -107,6 +119,11 @@ int main(int argc, char *argv[])
                 "--trunks",
                 toString(p.segmentOnlyTrunks),
                 "Segment only trunks (fast preview) {true, false}");
+        arg.add("-m",
+                "--cache-size",
+                "0",
+                "Maximal size of unused pages kept in memory, 0 uses "
+                "application settings [MB]");
 
         if (arg.parse(argc, argv))
         {
@@ -136,7 +153,9 @@ int main(int argc, char *argv[])
             p.zCoordinatesAsElevation = arg.toBool("--z-elevation");
             p.segmentOnlyTrunks = arg.toBool("--trunks");
 
-            segmentationCompute(arg.toString("--file"), p);
+            segmentationCompute(arg.toString("--file"),
+                                p,
+                                arg.toSize("--cache-size"));
         }
 
         rc = 0;
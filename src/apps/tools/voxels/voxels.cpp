@@ -0,0 +1,104 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file voxels.cpp
+    @brief Voxelization benchmark command line tool.
+*/
+
+// Include 3D Forest.
+#include <ArgumentParser.hpp>
+#include <Editor.hpp>
+#include <Error.hpp>
+#include <Time.hpp>
+#include <VoxelGrid.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "voxels"
+#include <Log.hpp>
+
+static void voxelsCompute(const std::string &inputPath,
+                          double voxelSize,
+                          size_t nRepeat)
+{
+    // Open input file in editor.
+    Editor editor;
+    editor.open(inputPath);
+
+    double ppm = editor.settings().unitsSettings().pointsPerMeter()[0];
+
+    // Voxelize all points. The first pass also reads pages from files.
+    VoxelGrid grid(&editor);
+    grid.setAttributes({PageData::ATTRIBUTE_ELEVATION});
+
+    for (size_t i = 0; i < nRepeat + 1; i++)
+    {
+        double t = Time::realTime();
+
+        grid.start(QueryWhere(), voxelSize * ppm, editor.boundary().min());
+        while (!grid.end())
+        {
+            grid.next();
+        }
+
+        t = Time::realTime() - t;
+
+        std::cout << (i == 0 ? "first pass" : "next pass ") << " : "
+                  << static_cast<double>(grid.nPoints()) / t
+                  << " points/s, " << grid.nPoints() << " points, "
+                  << grid.size() << " voxels, " << t << " s" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int rc = 1;
+
+    LOGGER_START_FILE("log_voxels.txt");
+
+    try
+    {
+        ArgumentParser arg("measures voxelization speed");
+        arg.add("-f",
+                "--file",
+                "",
+                "Path to the input file to be processed. Accepted formats "
+                "include .las, and .json project file",
+                true);
+        arg.add("-v", "--voxel", "0.1", "Voxel size [m]");
+        arg.add("-n", "--repeat", "3", "Number of passes with cached pages");
+
+        if (arg.parse(argc, argv))
+        {
+            voxelsCompute(arg.toString("--file"),
+                          arg.toDouble("--voxel"),
+                          arg.toSize("--repeat"));
+        }
+
+        rc = 0;
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+    }
+
+    LOGGER_STOP_FILE;
+
+    return rc;
+}
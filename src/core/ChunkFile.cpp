@@ -32,8 +32,6 @@
 #define LOG_MODULE_NAME "ChunkFile"
 #include <Log.hpp>
 
-#define CHUNK_HEADER_SIZE 16U
-
 ChunkFile::ChunkFile()
 {
 }
@@ -101,6 +99,11 @@ void ChunkFile::write(const uint8_t *buffer, uint64_t nbyte)
     file_.write(buffer, nbyte);
 }
 
+void ChunkFile::read(uint8_t *buffer, uint64_t nbyte, uint64_t offset) const
+{
+    file_.read(buffer, nbyte, offset);
+}
+
 void ChunkFile::read(ChunkFile::Chunk &chunk)
 {
     uint8_t buffer[CHUNK_HEADER_SIZE];
@@ -114,6 +117,19 @@ void ChunkFile::read(ChunkFile::Chunk &chunk)
     chunk.dataLength = ltoh64(&buffer[8]);
 }
 
+void ChunkFile::read(ChunkFile::Chunk &chunk, uint64_t offset) const
+{
+    uint8_t buffer[CHUNK_HEADER_SIZE];
+
+    file_.read(buffer, CHUNK_HEADER_SIZE, offset);
+
+    chunk.type = ltoh32(&buffer[0]);
+    chunk.majorVersion = buffer[4];
+    chunk.minorVersion = buffer[5];
+    chunk.headerLength = ltoh16(&buffer[6]);
+    chunk.dataLength = ltoh64(&buffer[8]);
+}
+
 void ChunkFile::validate(const Chunk &chunk,
                          uint32_t type,
                          uint8_t majorVersion,
@@ -51,6 +51,9 @@ public:
         uint64_t dataLength;
     };
 
+    /** Size of chunk header in file. */
+    static constexpr uint64_t CHUNK_HEADER_SIZE = 16;
+
     ChunkFile();
     ~ChunkFile();
 
@@ -63,6 +66,10 @@ public:
     void read(Chunk &chunk);
     void read(uint8_t *buffer, uint64_t nbyte);
 
+    /** Read at 'offset' without changing file offset. Thread-safe. */
+    void read(Chunk &chunk, uint64_t offset) const;
+    void read(uint8_t *buffer, uint64_t nbyte, uint64_t offset) const;
+
     void write(const Chunk &chunk);
     void write(const uint8_t *buffer, uint64_t nbyte);
 
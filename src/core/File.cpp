@@ -20,10 +20,12 @@
 /** @file File.cpp */
 
 // Include std.
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fcntl.h>
 #include <iostream>
 #include <limits>
@@ -51,6 +53,7 @@ typedef unsigned short mode_t;
     #include <limits.h>
     #include <windows.h>
 #else
+    #include <sys/mman.h>
     #include <sys/stat.h>
     #include <unistd.h>
 #endif /* _MSC_VER */
@@ -76,12 +79,32 @@ typedef unsigned short mode_t;
 const int File::INVALID_DESCRIPTOR = -1;
 #endif
 
-File::File() : fd_(INVALID_DESCRIPTOR), size_(0), offset_(0), path_()
+static std::atomic<uint64_t> fileStatisticsOpen(0);
+static std::atomic<uint64_t> fileStatisticsClose(0);
+static std::atomic<uint64_t> fileStatisticsSeek(0);
+static std::atomic<uint64_t> fileStatisticsRead(0);
+static std::atomic<uint64_t> fileStatisticsWrite(0);
+
+static void fileStatisticsAdd(std::atomic<uint64_t> &counter)
+{
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+File::File()
+    : fd_(INVALID_DESCRIPTOR),
+      size_(0),
+      offset_(0),
+      path_(),
+      map_(nullptr),
+      mapSize_(0),
+      mapHandle_(nullptr)
 {
 }
 
 File::~File()
 {
+    unmap();
+
     if (fd_ != INVALID_DESCRIPTOR)
     {
 #if defined(_MSC_VER)
@@ -89,6 +112,7 @@ File::~File()
 #else
         (void)::close(fd_);
 #endif
+        fileStatisticsAdd(fileStatisticsClose);
     }
 }
 
@@ -96,7 +120,10 @@ File::File(const File &)
     : fd_(INVALID_DESCRIPTOR),
       size_(0),
       offset_(0),
-      path_()
+      path_(),
+      map_(nullptr),
+      mapSize_(0),
+      mapHandle_(nullptr)
 {
     // TBD.
 }
@@ -131,6 +158,8 @@ const std::string &File::path() const
 void File::create()
 {
     // Close.
+    unmap();
+
     if (fd_ != INVALID_DESCRIPTOR)
     {
 #if defined(_MSC_VER)
@@ -138,6 +167,7 @@ void File::create()
 #else
         (void)::close(fd_);
 #endif
+        fileStatisticsAdd(fileStatisticsClose);
     }
 
     // Temporary file with a unique auto-generated fileName, "wb+".
@@ -157,6 +187,7 @@ void File::create()
 #else
     fd_ = ::fileno(tmpf);
 #endif
+    fileStatisticsAdd(fileStatisticsOpen);
     size_ = 0;
     offset_ = 0;
     path_ = "temporary";
@@ -193,6 +224,8 @@ void File::open(const std::string &path, const std::string &mode)
     mode_t omode;
 
     // Close.
+    unmap();
+
     if (fd_ != INVALID_DESCRIPTOR)
     {
 #if defined(_MSC_VER)
@@ -200,6 +233,7 @@ void File::open(const std::string &path, const std::string &mode)
 #else
         (void)::close(fd_);
 #endif
+        fileStatisticsAdd(fileStatisticsClose);
     }
 
     // Open.
@@ -282,6 +316,8 @@ void File::open(const std::string &path, const std::string &mode)
         THROW_ERRNO("Can't open file '" + path + "'");
     }
 
+    fileStatisticsAdd(fileStatisticsOpen);
+
 #if defined(_MSC_VER)
     struct _stat64 st;
     ret = ::_fstat64(fd_, &st);
@@ -304,6 +340,8 @@ void File::close()
 {
     int ret;
 
+    unmap();
+
     if (fd_ != INVALID_DESCRIPTOR)
     {
 #if defined(_MSC_VER)
@@ -311,6 +349,7 @@ void File::close()
 #else
         ret = ::close(fd_);
 #endif
+        fileStatisticsAdd(fileStatisticsClose);
         if (ret != 0)
         {
             THROW_ERRNO("Can't close file '" + path_ + "'");
@@ -325,6 +364,8 @@ void File::close()
 
 int File::seek(int fd, uint64_t offset)
 {
+    fileStatisticsAdd(fileStatisticsSeek);
+
 #if defined(_MSC_VER)
     if (offset > static_cast<uint64_t>((std::numeric_limits<__int64>::max)()))
     {
@@ -384,6 +425,9 @@ void File::truncate(uint64_t newSize)
 {
     int ret;
 
+    // Mapped pages behind the new end of file are not valid.
+    unmap();
+
 #if defined(_MSC_VER)
     ret = ::_chsize_s(fd_, static_cast<__int64>(newSize));
 #else
@@ -396,6 +440,85 @@ void File::truncate(uint64_t newSize)
     }
 }
 
+const uint8_t *File::map(uint64_t offset, uint64_t nbyte)
+{
+    if (offset > size_ || nbyte > size_ - offset)
+    {
+        return nullptr;
+    }
+
+    // Map whole file again when it has grown since the last mapping.
+    if (offset + nbyte > mapSize_)
+    {
+        unmap();
+
+        if (size_ == 0 ||
+            size_ > static_cast<uint64_t>(std::numeric_limits<size_t>::max()))
+        {
+            return nullptr;
+        }
+
+        size_t length = static_cast<size_t>(size_);
+
+#if defined(_MSC_VER)
+        HANDLE file = reinterpret_cast<HANDLE>(::_get_osfhandle(fd_));
+        HANDLE handle = ::CreateFileMappingA(file,
+                                             nullptr,
+                                             PAGE_READONLY,
+                                             static_cast<DWORD>(size_ >> 32),
+                                             static_cast<DWORD>(size_),
+                                             nullptr);
+        if (!handle)
+        {
+            LOG_DEBUG(<< "Can't map file <" << path_ << ">.");
+            return nullptr;
+        }
+
+        void *ptr = ::MapViewOfFile(handle, FILE_MAP_READ, 0, 0, length);
+        if (!ptr)
+        {
+            (void)::CloseHandle(handle);
+            LOG_DEBUG(<< "Can't map file <" << path_ << ">.");
+            return nullptr;
+        }
+
+        mapHandle_ = handle;
+#else
+        void *ptr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd_, 0);
+        if (ptr == MAP_FAILED)
+        {
+            LOG_DEBUG(<< "Can't map file <" << path_ << ">.");
+            return nullptr;
+        }
+#endif
+
+        map_ = static_cast<uint8_t *>(ptr);
+        mapSize_ = size_;
+
+        LOG_DEBUG(<< "Mapped <" << mapSize_ << "> bytes of file <" << path_
+                  << ">.");
+    }
+
+    return map_ + offset;
+}
+
+void File::unmap()
+{
+    if (map_)
+    {
+#if defined(_MSC_VER)
+        (void)::UnmapViewOfFile(map_);
+        (void)::CloseHandle(static_cast<HANDLE>(mapHandle_));
+#else
+        (void)::munmap(map_, static_cast<size_t>(mapSize_));
+#endif
+    }
+
+    map_ = nullptr;
+    mapSize_ = 0;
+    mapHandle_ = nullptr;
+}
+
 std::string File::read(const std::string &path)
 {
     File f;
@@ -443,6 +566,8 @@ void File::read(uint8_t *buffer,
         THROW_ERRNO("Can't open file '" + path + "'");
     }
 
+    fileStatisticsAdd(fileStatisticsOpen);
+
     if (offset != 0)
     {
         ret = seek(fd, offset);
@@ -463,6 +588,7 @@ void File::read(uint8_t *buffer,
 #else
     ret = ::close(fd);
 #endif
+    fileStatisticsAdd(fileStatisticsClose);
     if (ret != 0)
     {
         THROW_ERRNO("Can't close file '" + path + "'");
@@ -495,6 +621,8 @@ int File::read(int fd, uint8_t *buffer, uint64_t nbyte)
 
     assert(buffer);
 
+    fileStatisticsAdd(fileStatisticsRead);
+
     total = 0;
     while (nbyte > 0)
     {
@@ -530,6 +658,92 @@ int File::read(int fd, uint8_t *buffer, uint64_t nbyte)
     return 0;
 }
 
+void File::read(uint8_t *buffer, uint64_t nbyte, uint64_t offset) const
+{
+    int ret;
+
+    if (nbyte == 0)
+    {
+        return;
+    }
+
+    ret = read(fd_, buffer, nbyte, offset);
+    if (ret == -1)
+    {
+        THROW_ERRNO("Can't read file '" + path_ + "'");
+    }
+}
+
+int File::read(int fd, uint8_t *buffer, uint64_t nbyte, uint64_t offset)
+{
+    uint64_t total;
+    uint64_t nread;
+
+    assert(buffer);
+
+    fileStatisticsAdd(fileStatisticsRead);
+
+    total = 0;
+    while (nbyte > 0)
+    {
+        nread = nbyte;
+        if (nread > UINT_MAX)
+        {
+            nread = UINT_MAX;
+        }
+
+#if defined(_MSC_VER)
+        HANDLE handle = reinterpret_cast<HANDLE>(::_get_osfhandle(fd));
+        OVERLAPPED overlapped;
+        std::memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = static_cast<DWORD>(offset + total);
+        overlapped.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+        DWORD n = 0;
+        ssize_t ret;
+        if (::ReadFile(handle,
+                       buffer + total,
+                       static_cast<DWORD>(nread),
+                       &n,
+                       &overlapped))
+        {
+            ret = static_cast<ssize_t>(n);
+        }
+        else if (::GetLastError() == ERROR_HANDLE_EOF)
+        {
+            ret = 0;
+        }
+        else
+        {
+            errno = EIO;
+            ret = -1;
+        }
+#else
+        ssize_t ret = ::pread(fd,
+                              buffer + total,
+                              static_cast<size_t>(nread),
+                              static_cast<off_t>(offset + total));
+#endif
+
+        if (ret == 0)
+        {
+            nbyte = 0;
+        }
+        else if (ret == -1)
+        {
+            if (errno != EINTR)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            total += static_cast<uint64_t>(ret);
+            nbyte -= static_cast<uint64_t>(ret);
+        }
+    }
+    return 0;
+}
+
 void File::write(const std::string &path, const std::string &data)
 {
     File f;
@@ -571,6 +785,8 @@ void File::write(const uint8_t *buffer,
         THROW_ERRNO("Can't open file '" + path + "'");
     }
 
+    fileStatisticsAdd(fileStatisticsOpen);
+
     if (offset != 0)
     {
         ret = seek(fd, offset);
@@ -591,6 +807,7 @@ void File::write(const uint8_t *buffer,
 #else
     ret = ::close(fd);
 #endif
+    fileStatisticsAdd(fileStatisticsClose);
     if (ret != 0)
     {
         THROW_ERRNO("Can't close file '" + path + "'");
@@ -656,6 +873,8 @@ int File::write(int fd, const uint8_t *buffer, uint64_t nbyte)
 
     assert(buffer);
 
+    fileStatisticsAdd(fileStatisticsWrite);
+
     total = 0;
     while (nbyte > 0)
     {
@@ -1061,6 +1280,26 @@ void File::remove(const std::string &path)
     }
 }
 
+File::Statistics File::statistics()
+{
+    File::Statistics ret;
+    ret.nOpen = fileStatisticsOpen.load(std::memory_order_relaxed);
+    ret.nClose = fileStatisticsClose.load(std::memory_order_relaxed);
+    ret.nSeek = fileStatisticsSeek.load(std::memory_order_relaxed);
+    ret.nRead = fileStatisticsRead.load(std::memory_order_relaxed);
+    ret.nWrite = fileStatisticsWrite.load(std::memory_order_relaxed);
+    return ret;
+}
+
+void File::resetStatistics()
+{
+    fileStatisticsOpen.store(0, std::memory_order_relaxed);
+    fileStatisticsClose.store(0, std::memory_order_relaxed);
+    fileStatisticsSeek.store(0, std::memory_order_relaxed);
+    fileStatisticsRead.store(0, std::memory_order_relaxed);
+    fileStatisticsWrite.store(0, std::memory_order_relaxed);
+}
+
 std::ostream &operator<<(std::ostream &out, const File &in)
 {
     return out << "{ \"path\"=\"" << in.path()
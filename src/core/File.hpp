@@ -36,6 +36,16 @@
 class EXPORT_CORE File
 {
 public:
+    /** File Statistics. Number of system calls made by all files. */
+    struct EXPORT_CORE Statistics
+    {
+        uint64_t nOpen;
+        uint64_t nClose;
+        uint64_t nSeek;
+        uint64_t nRead;
+        uint64_t nWrite;
+    };
+
     File();
     ~File();
     File(const File &other);
@@ -50,11 +60,24 @@ public:
     void skip(uint64_t nbyte);
 
     void read(uint8_t *buffer, uint64_t nbyte);
+    /** Read at 'offset' without changing file offset. Thread-safe. */
+    void read(uint8_t *buffer, uint64_t nbyte, uint64_t offset) const;
     void write(const uint8_t *buffer, uint64_t nbyte);
     void write(const std::string &str);
     void write(File &input, uint64_t nbyte);
     void truncate(uint64_t newSize = 0);
 
+    /**
+        Map file content to memory and return pointer to 'nbyte' bytes at
+        'offset'. Returns nullptr when the range is outside of the file or
+        when the file can not be mapped, e.g. it is larger than address
+        space. The caller should then use read(). The pointer is valid until
+        the next call to map(), truncate() or close().
+    */
+    const uint8_t *map(uint64_t offset, uint64_t nbyte);
+    void unmap();
+    bool mapped() const { return map_ != nullptr; }
+
     bool open() const { return fd_ != INVALID_DESCRIPTOR; }
     bool eof() const;
     uint64_t size() const;
@@ -104,17 +127,26 @@ public:
 
     static void remove(const std::string &path);
 
+    static Statistics statistics();
+    static void resetStatistics();
+
 private:
     int fd_;
     uint64_t size_;
     uint64_t offset_;
     std::string path_;
 
+    // Memory mapping.
+    uint8_t *map_;
+    uint64_t mapSize_;
+    void *mapHandle_;
+
     static const int INVALID_DESCRIPTOR;
 
     void create();
     static int seek(int fd, uint64_t offset);
     static int read(int fd, uint8_t *buffer, uint64_t nbyte);
+    static int read(int fd, uint8_t *buffer, uint64_t nbyte, uint64_t offset);
     static int write(int fd, const uint8_t *buffer, uint64_t nbyte);
 };
 
@@ -70,7 +70,7 @@ static void recordFileBufferWrite(std::vector<uint8_t> &dst,
 
 template <class T>
 static void recordFileBufferRead(std::vector<T> &dst,
-                                 const std::vector<uint8_t> &src,
+                                 const uint8_t *src,
                                  RecordFile::Type recordType,
                                  size_t n)
 {
@@ -82,13 +82,13 @@ static void recordFileBufferRead(std::vector<T> &dst,
     switch (recordType)
     {
         case RecordFile::TYPE_U32:
-            ltoh32(dst.data(), src.data(), n);
+            ltoh32(dst.data(), src, n);
             break;
         case RecordFile::TYPE_U64:
-            ltoh64(dst.data(), src.data(), n);
+            ltoh64(dst.data(), src, n);
             break;
         case RecordFile::TYPE_F64:
-            ltohd(dst.data(), src.data(), n);
+            ltohd(dst.data(), src, n);
             break;
         case RecordFile::TYPE_CUSTOM:
         default:
@@ -386,6 +386,54 @@ void RecordFile::readBuffer(RecordFile::Buffer &buffer, uint64_t n)
     readBuffer(buffer.data.data(), nbyte);
 }
 
+const uint8_t *RecordFile::map(uint64_t index, uint64_t n)
+{
+    return file_.map(headerSize_ + (index * recordSize_), n * recordSize_);
+}
+
+template <class T>
+static void recordFileRead(RecordFile &file,
+                           std::vector<T> &v,
+                           uint64_t index,
+                           uint64_t n)
+{
+    // Decode records directly from mapped file if possible.
+    const uint8_t *ptr = file.map(index, n);
+    if (ptr)
+    {
+        recordFileBufferRead(v,
+                             ptr,
+                             file.recordType(),
+                             static_cast<size_t>(n));
+        return;
+    }
+
+    RecordFile::Buffer buffer;
+    file.setIndex(index);
+    file.readBuffer(buffer, n);
+    buffer.read(v);
+}
+
+void RecordFile::read(std::vector<uint32_t> &v, uint64_t index, uint64_t n)
+{
+    recordFileRead(*this, v, index, n);
+}
+
+void RecordFile::read(std::vector<size_t> &v, uint64_t index, uint64_t n)
+{
+    recordFileRead(*this, v, index, n);
+}
+
+void RecordFile::read(std::vector<float> &v, uint64_t index, uint64_t n)
+{
+    recordFileRead(*this, v, index, n);
+}
+
+void RecordFile::read(std::vector<double> &v, uint64_t index, uint64_t n)
+{
+    recordFileRead(*this, v, index, n);
+}
+
 void RecordFile::writeBuffer(const RecordFile::Buffer &buffer,
                              uint64_t n,
                              uint64_t from)
@@ -426,7 +474,7 @@ static void rangeT(T &min,
         }
 
         file.read(buffer.data(), nBytes);
-        recordFileBufferRead(values, buffer, recordType, nValues);
+        recordFileBufferRead(values, buffer.data(), recordType, nValues);
 
         for (size_t i = 0; i < nValues; i++)
         {
@@ -451,24 +499,44 @@ void RecordFile::range(uint32_t &min, uint32_t &max, uint64_t n, uint64_t from)
     rangeT(min, max, file_, recordType_, recordSize_, n);
 }
 
+void RecordFile::Buffer::write(const std::vector<uint32_t> &v)
+{
+    recordFileBufferWrite(data, v, recordType, size);
+}
+
 void RecordFile::Buffer::write(const std::vector<size_t> &v)
 {
     recordFileBufferWrite(data, v, recordType, size);
 }
 
+void RecordFile::Buffer::write(const std::vector<float> &v)
+{
+    recordFileBufferWrite(data, v, recordType, size);
+}
+
 void RecordFile::Buffer::write(const std::vector<double> &v)
 {
     recordFileBufferWrite(data, v, recordType, size);
 }
 
+void RecordFile::Buffer::read(std::vector<uint32_t> &v) const
+{
+    recordFileBufferRead(v, data.data(), recordType, size);
+}
+
 void RecordFile::Buffer::read(std::vector<size_t> &v) const
 {
-    recordFileBufferRead(v, data, recordType, size);
+    recordFileBufferRead(v, data.data(), recordType, size);
+}
+
+void RecordFile::Buffer::read(std::vector<float> &v) const
+{
+    recordFileBufferRead(v, data.data(), recordType, size);
 }
 
 void RecordFile::Buffer::read(std::vector<double> &v) const
 {
-    recordFileBufferRead(v, data, recordType, size);
+    recordFileBufferRead(v, data.data(), recordType, size);
 }
 
 void RecordFile::Buffer::copy(const RecordFile::Buffer &src,
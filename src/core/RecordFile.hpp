@@ -67,10 +67,14 @@ public:
         std::string name;
         std::vector<uint8_t> data;
 
+        void write(const std::vector<uint32_t> &v);
         void write(const std::vector<size_t> &v);
+        void write(const std::vector<float> &v);
         void write(const std::vector<double> &v);
 
+        void read(std::vector<uint32_t> &v) const;
         void read(std::vector<size_t> &v) const;
+        void read(std::vector<float> &v) const;
         void read(std::vector<double> &v) const;
 
         void copy(const RecordFile::Buffer &src,
@@ -120,6 +124,15 @@ public:
                      uint64_t n,
                      uint64_t from = 0);
 
+    /** Map 'n' records from 'index' to memory, nullptr if not possible. */
+    const uint8_t *map(uint64_t index, uint64_t n);
+
+    /** Read 'n' records from 'index' without intermediate buffer. */
+    void read(std::vector<uint32_t> &v, uint64_t index, uint64_t n);
+    void read(std::vector<size_t> &v, uint64_t index, uint64_t n);
+    void read(std::vector<float> &v, uint64_t index, uint64_t n);
+    void read(std::vector<double> &v, uint64_t index, uint64_t n);
+
     void range(uint32_t &min, uint32_t &max, uint64_t n, uint64_t from = 0);
 
 protected:
@@ -45,6 +45,11 @@ public:
 
     const Box<T> &box() const { return box_; }
 
+    T x() const { return x_; }
+    T y() const { return y_; }
+    T z() const { return z_; }
+    T radius() const { return radius_; }
+
     bool contains(T x, T y, T z) const;
 
 protected:
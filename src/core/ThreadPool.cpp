@@ -0,0 +1,181 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file ThreadPool.cpp */
+
+// Include 3D Forest.
+#include <ThreadPool.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "ThreadPool"
+#include <Log.hpp>
+
+ThreadPool::ThreadPool()
+    : exit_(false),
+      task_(nullptr),
+      taskCount_(0),
+      taskNext_(0),
+      taskFinished_(0)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    clear();
+}
+
+void ThreadPool::create(size_t nThreads)
+{
+    clear();
+
+    // Use all hardware threads by default.
+    if (nThreads == 0)
+    {
+        nThreads = static_cast<size_t>(std::thread::hardware_concurrency());
+    }
+
+    LOG_DEBUG(<< "Create <" << nThreads << "> threads.");
+
+    // The calling thread is also used as a worker.
+    for (size_t i = 1; i < nThreads; i++)
+    {
+        threads_.emplace_back(&ThreadPool::runLoop, this);
+    }
+}
+
+void ThreadPool::clear()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        exit_ = true;
+    }
+    condition_.notify_all();
+
+    for (auto &thread : threads_)
+    {
+        thread.join();
+    }
+
+    threads_.clear();
+    exit_ = false;
+}
+
+void ThreadPool::run(size_t nTasks, const std::function<void(size_t)> &task)
+{
+    if (nTasks == 0)
+    {
+        return;
+    }
+
+    // Serial execution.
+    if (threads_.empty() || nTasks == 1)
+    {
+        for (size_t i = 0; i < nTasks; i++)
+        {
+            task(i);
+        }
+
+        return;
+    }
+
+    // Parallel execution.
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    task_ = &task;
+    taskCount_ = nTasks;
+    taskNext_ = 0;
+    taskFinished_ = 0;
+    exception_ = nullptr;
+
+    condition_.notify_all();
+
+    runTasks(lock);
+
+    while (taskFinished_ < taskCount_)
+    {
+        conditionFinished_.wait(lock);
+    }
+
+    task_ = nullptr;
+    taskCount_ = 0;
+    taskNext_ = 0;
+
+    // Rethrow the first exception thrown by some task.
+    std::exception_ptr exception = exception_;
+    exception_ = nullptr;
+    lock.unlock();
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+void ThreadPool::runLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true)
+    {
+        while (!exit_ && taskNext_ >= taskCount_)
+        {
+            condition_.wait(lock);
+        }
+
+        if (exit_)
+        {
+            return;
+        }
+
+        runTasks(lock);
+    }
+}
+
+void ThreadPool::runTasks(std::unique_lock<std::mutex> &lock)
+{
+    while (taskNext_ < taskCount_)
+    {
+        size_t i = taskNext_;
+        taskNext_++;
+
+        lock.unlock();
+
+        try
+        {
+            (*task_)(i);
+        }
+        catch (...)
+        {
+            lock.lock();
+            if (!exception_)
+            {
+                exception_ = std::current_exception();
+            }
+            lock.unlock();
+        }
+
+        lock.lock();
+
+        taskFinished_++;
+        if (taskFinished_ == taskCount_)
+        {
+            conditionFinished_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file ThreadPool.hpp */
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+// Include std.
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Include local.
+#include <ExportCore.hpp>
+#include <WarningsDisable.hpp>
+
+/** Thread Pool.
+
+    Bounded pool of worker threads which executes a batch of independent
+    tasks. The calling thread takes part in the execution, so a pool of
+    size 1 runs all tasks serially in the calling thread.
+*/
+class EXPORT_CORE ThreadPool
+{
+public:
+    ThreadPool();
+    ~ThreadPool();
+
+    void create(size_t nThreads = 0);
+    void clear();
+
+    size_t size() const { return threads_.size() + 1; }
+
+    void run(size_t nTasks, const std::function<void(size_t)> &task);
+
+protected:
+    std::vector<std::thread> threads_;
+
+    // Synchronization.
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::condition_variable conditionFinished_;
+    bool exit_;
+
+    // Current batch of tasks.
+    const std::function<void(size_t)> *task_;
+    size_t taskCount_;
+    size_t taskNext_;
+    size_t taskFinished_;
+    std::exception_ptr exception_;
+
+    void runLoop();
+    void runTasks(std::unique_lock<std::mutex> &lock);
+};
+
+#include <WarningsEnable.hpp>
+
+#endif /* THREAD_POOL_HPP */
@@ -46,3 +46,27 @@ TEST_CASE(TestRecordFileCreateU32)
     TEST(r.index() == 1);
     TEST(rU32 == UINT32_MAX);
 }
+
+TEST_CASE(TestRecordFileReadMapped)
+{
+    // Write 3 integer values.
+    RecordFile f;
+    f.create(TEST_RECORD_FILE_PATH, "foo", RecordFile::TYPE_U64);
+    f.write(static_cast<uint64_t>(10));
+    f.write(static_cast<uint64_t>(11));
+    f.write(static_cast<uint64_t>(12));
+    TEST(f.map(1, 2) != nullptr);
+    TEST(f.map(2, 2) == nullptr);
+
+    // Read the values back from mapped file.
+    std::vector<size_t> v;
+    f.read(v, 1, 2);
+    TEST(v.size() == 2 && v[0] == 11 && v[1] == 12);
+
+    // Append a value.
+    // Expected : the file is mapped again with the new value.
+    f.setIndex(3);
+    f.write(static_cast<uint64_t>(13));
+    f.read(v, 2, 2);
+    TEST(v.size() == 2 && v[0] == 12 && v[1] == 13);
+}
@@ -0,0 +1,90 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file TestThreadPool.cpp */
+
+// Include std.
+#include <stdexcept>
+
+// Include 3D Forest.
+#include <Test.hpp>
+#include <ThreadPool.hpp>
+
+TEST_CASE(TestThreadPoolSerial)
+{
+    ThreadPool pool;
+    pool.create(1);
+    TEST(pool.size() == 1);
+
+    std::vector<size_t> v(100, 0);
+    pool.run(v.size(), [&](size_t i) { v[i] = i + 1; });
+
+    for (size_t i = 0; i < v.size(); i++)
+    {
+        TEST(v[i] == i + 1);
+    }
+}
+
+TEST_CASE(TestThreadPoolParallel)
+{
+    ThreadPool pool;
+    pool.create(4);
+    TEST(pool.size() == 4);
+
+    // Run several batches with the same workers.
+    for (size_t k = 0; k < 10; k++)
+    {
+        std::vector<size_t> v(1000, 0);
+        pool.run(v.size(), [&](size_t i) { v[i] += i + k; });
+
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            TEST(v[i] == i + k);
+        }
+    }
+}
+
+TEST_CASE(TestThreadPoolException)
+{
+    ThreadPool pool;
+    pool.create(4);
+
+    bool thrown = false;
+    try
+    {
+        pool.run(100,
+                 [&](size_t i)
+                 {
+                     if (i == 50)
+                     {
+                         throw std::runtime_error("task");
+                     }
+                 });
+    }
+    catch (std::exception &)
+    {
+        thrown = true;
+    }
+    TEST(thrown);
+
+    // The pool is still usable.
+    std::vector<size_t> v(10, 0);
+    pool.run(v.size(), [&](size_t i) { v[i] = 1; });
+    TEST(v[9] == 1);
+}
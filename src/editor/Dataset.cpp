@@ -30,7 +30,7 @@
 #define LOG_MODULE_DEBUG_ENABLED 1
 #include <Log.hpp>
 
-Dataset::Dataset() : id_(0)
+Dataset::Dataset() : id_(0), mutex_(std::make_shared<std::mutex>())
 {
 }
 
@@ -128,12 +128,74 @@ void Dataset::read()
     index_ = std::make_shared<IndexFile>();
     index_->read(pathIndex);
 
+    // Keep index file open for reading of page indices.
+    indexFile_ = std::make_shared<ChunkFile>();
+    indexFile_->open(pathIndex, "r");
+
     boundaryFile_ = index_->boundaryPoints();
     updateBoundary();
 
     nPoints_ = las_->header.number_of_point_records;
 
     LOG_DEBUG(<< "Number of points <" << nPoints_ << ">.");
+
+    // Compressed pages.
+    pageFile_.reset();
+    const std::string pathPages = PageFile::extension(path_);
+    if (File::exists(pathPages))
+    {
+        // Points are read from LAS file when the page file can not be used.
+        auto pageFile = std::make_shared<PageFile>();
+
+        try
+        {
+            pageFile->open(pathPages);
+
+            if (pageFile->numberOfPages() == index_->size() &&
+                pageFile->numberOfPoints() == nPoints_)
+            {
+                pageFile_ = pageFile;
+            }
+            else
+            {
+                LOG_WARNING(<< "Ignore page file <" << pathPages
+                            << "> which does not match the index.");
+            }
+        }
+        catch (std::exception &e)
+        {
+            LOG_WARNING(<< "Ignore page file <" << pathPages
+                        << "> which can not be read: " << e.what() << ".");
+        }
+    }
+
+    // Page summaries.
+    summaryFile_.reset();
+    const std::string pathSummary = PageSummaryFile::extension(path_);
+    if (File::exists(pathSummary))
+    {
+        auto summaryFile = std::make_shared<PageSummaryFile>();
+
+        try
+        {
+            summaryFile->open(pathSummary);
+
+            if (summaryFile->numberOfPages() == index_->size())
+            {
+                summaryFile_ = summaryFile;
+            }
+            else
+            {
+                LOG_WARNING(<< "Ignore page summary file <" << pathSummary
+                            << "> which does not match the index.");
+            }
+        }
+        catch (std::exception &e)
+        {
+            LOG_WARNING(<< "Ignore page summary file <" << pathSummary
+                        << "> which can not be read: " << e.what() << ".");
+        }
+    }
 }
 
 void Dataset::updateBoundary()
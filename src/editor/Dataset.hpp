@@ -22,12 +22,17 @@
 #ifndef DATASET_HPP
 #define DATASET_HPP
 
+// Include std.
+#include <mutex>
+
 // Include 3D Forest.
 #include <Box.hpp>
 #include <ImportSettings.hpp>
 #include <IndexFile.hpp>
 #include <Json.hpp>
 #include <LasFile.hpp>
+#include <PageFile.hpp>
+#include <PageSummaryFile.hpp>
 
 // Include local.
 #include <ExportEditor.hpp>
@@ -72,12 +77,22 @@ public:
     uint64_t nPoints() const { return nPoints_; }
 
     const IndexFile &index() const { return *index_; }
+    const ChunkFile &indexFile() const { return *indexFile_; }
 
     const LasFile &las() const { return *las_; }
     LasFile &las() { return *las_; }
 
+    const PageFile *pageFile() const { return pageFile_.get(); }
+    PageFile *pageFile() { return pageFile_.get(); }
+
+    const PageSummaryFile *summaryFile() const { return summaryFile_.get(); }
+    PageSummaryFile *summaryFile() { return summaryFile_.get(); }
+
     const Dataset::Range &range() const { return range_; }
 
+    /** Serialize access to dataset files from page loader threads. */
+    std::mutex &mutex() const { return *mutex_; }
+
     // I/O.
     void read(size_t id,
               const std::string &path,
@@ -108,7 +123,11 @@ protected:
     Dataset::Range range_;
 
     std::shared_ptr<IndexFile> index_;
+    std::shared_ptr<ChunkFile> indexFile_;
     std::shared_ptr<LasFile> las_;
+    std::shared_ptr<PageFile> pageFile_;
+    std::shared_ptr<PageSummaryFile> summaryFile_;
+    std::shared_ptr<std::mutex> mutex_;
 
     void setPath(const std::string &path, const std::string &projectPath);
     void read();
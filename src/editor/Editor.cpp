@@ -49,10 +49,12 @@ static const char *EDITOR_KEY_MANAGEMENT_STATUS_FILTER =
 
 static const char *EDITOR_KEY_PLOT_INFO = "plot_info";
 
-Editor::Editor()
+Editor::Editor() : segmentsVersion_(0)
 {
     LOG_DEBUG(<< "Start creating the editor.");
     readSettings();
+    pageManager_.setCacheSizeMaximum(
+        settings_.renderingSettings().cacheSizeMaximum() * 1048576);
     close();
     viewportsResize(1);
     LOG_DEBUG(<< "Finished creating the editor.");
@@ -61,6 +63,24 @@ Editor::Editor()
 Editor::~Editor()
 {
     LOG_DEBUG(<< "Destroy.");
+
+    // Write modified pages which are released by the viewports.
+    try
+    {
+        viewports_.clearContent();
+        pageManager_.cancelPrefetch();
+        pageManager_.clearCache(this);
+    }
+    catch (std::exception &e)
+    {
+        LOG_ERROR(<< "Failed to write modified pages, "
+                  << "error message <" << e.what() << ">.");
+    }
+    catch (...)
+    {
+        LOG_ERROR(<< "Failed to write modified pages, "
+                     "unknown exception is raised.");
+    }
 }
 
 void Editor::readSettings()
@@ -149,6 +169,9 @@ void Editor::close()
     setProjectPath(File::join(File::currentPath(), "untitled.json"));
     projectName_ = "Untitled";
 
+    viewports_.clearContent();
+    pageManager_.cancelPrefetch();
+    pageManager_.clearCache(this);
     datasets_.clear();
     datasetsRange_ = Dataset::Range();
     datasetsFilter_.clear();
@@ -175,6 +198,8 @@ void Editor::close()
     }
     managementStatusFilter_.setEnabled(true);
 
+    segmentsVersion_++;
+
     classifications_.clear();
     classificationsFilter_.clear();
     for (size_t i = 0; i < classifications_.size(); i++)
@@ -185,8 +210,6 @@ void Editor::close()
 
     plotInfo_ = Json();
 
-    viewports_.clearContent();
-
     clipFilter_.clear();
     elevationFilter_.clear();
     descriptorFilter_.set(0.0, 1.0);
@@ -286,6 +309,8 @@ void Editor::openProject(std::string path, bool reload)
             fromJson(managementStatusList_, in[EDITOR_KEY_MANAGEMENT_STATUS]);
         }
 
+        segmentsVersion_++;
+
         // Classifications.
         if (in.contains(EDITOR_KEY_CLASSIFICATIONS))
         {
@@ -419,6 +444,9 @@ void Editor::saveProject(const std::string &path)
     double ppm = settings().unitsSettings().pointsPerMeter()[0];
     double mpp = 1.0 / ppm;
 
+    // Write modified pages.
+    pageManager_.flush(this);
+
     // Save data.
     Json out;
 
@@ -466,6 +494,8 @@ void Editor::openDataset(const std::string &path,
             projectPath = File::replaceExtension(projectPath, ".json");
         }
 
+        pageManager_.cancelPrefetch();
+        pageManager_.clearCache(this);
         datasets_.read(path,
                        projectPath,
                        settings,
@@ -593,6 +623,8 @@ void Editor::setDatasets(const Datasets &datasets)
 
     size_t datasetsSizeOld = datasets_.size();
 
+    pageManager_.cancelPrefetch();
+    pageManager_.clearCache(this);
     datasets_ = datasets;
 
     if (datasetsSizeOld != datasets_.size())
@@ -618,6 +650,7 @@ void Editor::setSegments(const Segments &segments)
 {
     LOG_DEBUG(<< "Set segments.");
     segments_ = segments;
+    segmentsVersion_++;
     unsavedChanges_ = true;
 }
 
@@ -625,6 +658,7 @@ void Editor::setSegment(const Segment &segment)
 {
     LOG_DEBUG(<< "Set segments.");
     segments_[segments_.index(segment.id)] = segment;
+    segmentsVersion_++;
     unsavedChanges_ = true;
 }
 
@@ -682,6 +716,7 @@ void Editor::setSpeciesList(const SpeciesList &speciesList)
 {
     LOG_DEBUG(<< "Set species list.");
     speciesList_ = speciesList;
+    segmentsVersion_++;
     unsavedChanges_ = true;
 }
 
@@ -689,6 +724,7 @@ void Editor::setSpecies(const Species &species)
 {
     LOG_DEBUG(<< "Set species.");
     speciesList_[speciesList_.index(species.id)] = species;
+    segmentsVersion_++;
     unsavedChanges_ = true;
 }
 
@@ -709,6 +745,7 @@ void Editor::setManagementStatusList(
 {
     LOG_DEBUG(<< "Set management status list.");
     managementStatusList_ = managementStatusList;
+    segmentsVersion_++;
     unsavedChanges_ = true;
 }
 
@@ -717,6 +754,7 @@ void Editor::setManagementStatus(const ManagementStatus &managementStatus)
     LOG_DEBUG(<< "Set management status.");
     managementStatusList_[managementStatusList_.index(managementStatus.id)] =
         managementStatus;
+    segmentsVersion_++;
     unsavedChanges_ = true;
 }
 
@@ -794,6 +832,8 @@ void Editor::setApplicationSettings(const ApplicationSettings &settings)
 void Editor::setRenderingSettings(const RenderingSettings &renderingSettings)
 {
     settings_.setRenderingSettings(renderingSettings);
+    pageManager_.setCacheSizeMaximum(
+        settings_.renderingSettings().cacheSizeMaximum() * 1048576);
     writeSettings();
 }
 
@@ -848,3 +888,23 @@ void Editor::erasePage(size_t dataset, size_t index)
 {
     pageManager_.erasePage(this, dataset, index);
 }
+
+bool Editor::prefetchPage(size_t dataset, size_t index)
+{
+    return pageManager_.prefetchPage(this, dataset, index);
+}
+
+void Editor::cancelPrefetch()
+{
+    pageManager_.cancelPrefetch();
+}
+
+void Editor::setPageCacheSizeMaximum(size_t nBytes)
+{
+    pageManager_.setCacheSizeMaximum(nBytes);
+}
+
+PageManager::Statistics Editor::pageCacheStatistics()
+{
+    return pageManager_.statistics();
+}
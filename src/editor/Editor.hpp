@@ -157,6 +157,11 @@ public:
     }
     void setManagementStatusFilter(const QueryFilterSet &filter);
 
+    /** Version of segments, species and management status lists.
+        The version is incremented on every change of these lists.
+    */
+    size_t segmentsVersion() const { return segmentsVersion_; }
+
     // Settings.
     const Settings &settings() const { return settings_; }
     void setApplicationSettings(const ApplicationSettings &settings);
@@ -177,6 +182,12 @@ public:
     // Page.
     std::shared_ptr<PageData> readPage(size_t dataset, size_t index);
     void erasePage(size_t dataset, size_t index);
+    bool prefetchPage(size_t dataset, size_t index);
+    void cancelPrefetch();
+
+    /** Set maximum size of page cache shared by all queries in bytes. */
+    void setPageCacheSizeMaximum(size_t nBytes);
+    PageManager::Statistics pageCacheStatistics();
 
     // Lock.
     std::mutex editorMutex_;
@@ -193,6 +204,7 @@ protected:
     Segments segments_;
     SpeciesList speciesList_;
     ManagementStatusList managementStatusList_;
+    size_t segmentsVersion_;
     Settings settings_;
     Classifications classifications_;
     Json plotInfo_;
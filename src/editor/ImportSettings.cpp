@@ -31,12 +31,17 @@ ImportSettings::ImportSettings()
       translateToOrigin(false),
       convertToVersion1Dot4(false),
       randomizePoints(true),
+      randomizeMethod(RandomizeMethod::SHUFFLE),
       copyExtraBytes(true),
+      compressPages(false),
       terminalOutput(false),
       maxIndexLevel1(0),
       maxIndexLevel1Size({1000, 10 * 1000}),
       maxIndexLevel2(5),
       maxIndexLevel2Size({32}),
-      bufferSize(5 * 1024 * 1024)
+      bufferSize(5 * 1024 * 1024),
+      sortBufferSize(256 * 1024 * 1024),
+      numberOfThreads(0),
+      numberOfFiles(0)
 {
 }
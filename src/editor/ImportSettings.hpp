@@ -34,12 +34,21 @@
 class EXPORT_EDITOR ImportSettings
 {
 public:
+    /** Import Settings Randomization Method. */
+    enum class RandomizeMethod
+    {
+        SHUFFLE,
+        STRIDE
+    };
+
     bool importFilesAsSeparateTrees;
     bool translateToOrigin;
 
     bool convertToVersion1Dot4;
     bool randomizePoints;
+    RandomizeMethod randomizeMethod;
     bool copyExtraBytes;
+    bool compressPages;
 
     bool terminalOutput;
 
@@ -49,6 +58,10 @@ public:
     std::vector<size_t> maxIndexLevel2Size;
 
     size_t bufferSize;
+    size_t sortBufferSize;
+
+    size_t numberOfThreads;
+    size_t numberOfFiles;
 
     ImportSettings();
 };
@@ -612,30 +612,22 @@ size_t IndexFile::countNodes(BuildNode *node) const
 
 uint64_t IndexFile::insert(double x, double y, double z)
 {
+    return insertCode(code(x, y, z));
+}
+
+uint64_t IndexFile::code(double x, double y, double z) const
+{
+    // Octants of the point at all tree levels. The first level is stored
+    // in the highest bits. This function can be called concurrently.
     uint64_t code = 0;
-    uint64_t ecode = 0;
-    uint64_t c;
     double px;
     double py;
     double pz;
     double x1, y1, z1, x2, y2, z2;
     Box<double> octant = boundary_;
-    BuildNode *node = root_.get();
-    size_t maxSize = 0;
 
     for (size_t level = 0; level < maxLevel_; level++)
     {
-        if (level < maxSize_.size())
-        {
-            maxSize = maxSize_[level];
-        }
-
-        if (node->size < maxSize)
-        {
-            node->size++;
-            return ecode;
-        }
-
         octant.center(px, py, pz);
 
         code = code << 3;
@@ -677,6 +669,33 @@ uint64_t IndexFile::insert(double x, double y, double z)
         }
 
         octant.set(x1, y1, z1, x2, y2, z2);
+    }
+
+    return code;
+}
+
+uint64_t IndexFile::insertCode(uint64_t path)
+{
+    uint64_t code = 0;
+    uint64_t ecode = 0;
+    uint64_t c;
+    BuildNode *node = root_.get();
+    size_t maxSize = 0;
+
+    for (size_t level = 0; level < maxLevel_; level++)
+    {
+        if (level < maxSize_.size())
+        {
+            maxSize = maxSize_[level];
+        }
+
+        if (node->size < maxSize)
+        {
+            node->size++;
+            return ecode;
+        }
+
+        code = path >> (3 * (maxLevel_ - 1 - level));
 
         c = code & 7;
 
@@ -734,6 +753,26 @@ void IndexFile::read(ChunkFile &file)
     readPayload(file, chunk);
 }
 
+void IndexFile::read(const ChunkFile &file, uint64_t offset)
+{
+    // Read chunk header.
+    ChunkFile::Chunk chunk;
+    file.read(chunk, offset);
+    file.validate(chunk,
+                  CHUNK_TYPE,
+                  OCTREE_INDEX_CHUNK_MAJOR_VERSION,
+                  OCTREE_INDEX_CHUNK_MINOR_VERSION);
+
+    // Read chunk payload.
+    std::vector<uint8_t> buffer;
+    buffer.resize(chunk.headerLength + chunk.dataLength);
+    file.read(buffer.data(),
+              buffer.size(),
+              offset + ChunkFile::CHUNK_HEADER_SIZE);
+
+    readPayload(buffer.data(), chunk.headerLength);
+}
+
 void IndexFile::readPayload(ChunkFile &file, const ChunkFile::Chunk &chunk)
 {
     file.validate(chunk,
@@ -743,10 +782,15 @@ void IndexFile::readPayload(ChunkFile &file, const ChunkFile::Chunk &chunk)
 
     std::vector<uint8_t> buffer;
     buffer.resize(chunk.headerLength + chunk.dataLength);
-    uint8_t *ptr = buffer.data();
+    file.read(buffer.data(), buffer.size());
 
+    readPayload(buffer.data(), chunk.headerLength);
+}
+
+void IndexFile::readPayload(const uint8_t *buffer, size_t headerLength)
+{
     // Read header.
-    file.read(ptr, chunk.headerLength);
+    const uint8_t *ptr = buffer;
 
     size_t n = static_cast<size_t>(ltoh64(&ptr[0]));
     double wx1 = ltohd(&ptr[8 + (0 * 8)]);
@@ -771,7 +815,7 @@ void IndexFile::readPayload(ChunkFile &file, const ChunkFile::Chunk &chunk)
     nodes_.resize(n);
     std::memset(nodes_.data(), 0, sizeof(Node) * n);
 
-    file.read(ptr, chunk.dataLength);
+    ptr = buffer + headerLength;
 
     for (size_t i = 0; i < nodes_.size(); i++)
     {
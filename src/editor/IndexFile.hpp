@@ -115,6 +115,7 @@ public:
     void read(const std::string &path);
     void read(const std::string &path, uint64_t offset);
     void read(ChunkFile &file);
+    void read(const ChunkFile &file, uint64_t offset);
     void readPayload(ChunkFile &file, const ChunkFile::Chunk &chunk);
     void write(const std::string &path) const;
     void write(ChunkFile &file) const;
@@ -126,6 +127,8 @@ public:
                      size_t maxLevel = 0,
                      bool insertOnlyToLeaves = false);
     uint64_t insert(double x, double y, double z);
+    uint64_t code(double x, double y, double z) const;
+    uint64_t insertCode(uint64_t path);
     void insertEnd();
 
 protected:
@@ -135,6 +138,8 @@ protected:
     Box<double> boundaryPointsFile_;
     std::vector<Node> nodes_;
 
+    void readPayload(const uint8_t *buffer, size_t headerLength);
+
     void selectLeaves(std::vector<SelectionTile> &selection,
                       const Box<double> &window,
                       const Box<double> &boundary,
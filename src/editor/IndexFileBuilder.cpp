@@ -20,11 +20,15 @@
 /** @file IndexFileBuilder.cpp */
 
 // Include std.
+#include <algorithm>
 #include <cstring>
+#include <mutex>
 
 // Include 3D Forest.
 #include <Endian.hpp>
+#include <Error.hpp>
 #include <IndexFileBuilder.hpp>
+#include <PageData.hpp>
 #include <Vector3.hpp>
 
 // Include local.
@@ -80,6 +84,105 @@ void IndexFileBuilder::index(const std::string &outputPath,
     }
 }
 
+void IndexFileBuilder::index(const std::vector<std::string> &paths,
+                             const ImportSettings &settings,
+                             std::vector<std::string> &errors)
+{
+    errors.clear();
+    errors.resize(paths.size());
+
+    // Number of threads and number of files which are indexed at once.
+    size_t nThreads = settings.numberOfThreads;
+    if (nThreads == 0)
+    {
+        nThreads = static_cast<size_t>(std::thread::hardware_concurrency());
+        if (nThreads == 0)
+        {
+            nThreads = 1;
+        }
+    }
+
+    size_t nFiles = settings.numberOfFiles;
+    if (nFiles == 0)
+    {
+        nFiles = nThreads;
+    }
+
+    if (nFiles > paths.size())
+    {
+        nFiles = paths.size();
+    }
+
+    if (nFiles == 0)
+    {
+        return;
+    }
+
+    LOG_INFO(<< "Index <" << paths.size() << "> files, <" << nFiles
+             << "> at once with <" << nThreads << "> threads.");
+
+    // Divide threads and sort memory between files. Each file is indexed
+    // by its own builder with its own pool of threads, because the passes
+    // of one builder are run as batches of tasks which can not be shared
+    // with other builders.
+    ImportSettings fileSettings = settings;
+    fileSettings.terminalOutput = false;
+
+    fileSettings.numberOfThreads = nThreads / nFiles;
+    if (fileSettings.numberOfThreads < 1)
+    {
+        fileSettings.numberOfThreads = 1;
+    }
+
+    fileSettings.sortBufferSize = settings.sortBufferSize / nFiles;
+    if (fileSettings.sortBufferSize < settings.bufferSize)
+    {
+        fileSettings.sortBufferSize = settings.bufferSize;
+    }
+
+    // Index files.
+    std::mutex mutex;
+    size_t nFinished = 0;
+
+    ThreadPool threadPool;
+    threadPool.create(nFiles);
+
+    threadPool.run(
+        paths.size(),
+        [&](size_t i)
+        {
+            try
+            {
+                index(paths[i], paths[i], fileSettings);
+            }
+            catch (std::exception &e)
+            {
+                errors[i] = e.what();
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+
+            nFinished++;
+
+            if (!errors[i].empty())
+            {
+                LOG_ERROR(<< "Failed to index file <" << paths[i] << ">: "
+                          << errors[i]);
+            }
+
+            if (settings.terminalOutput)
+            {
+                std::cout << "\r" << nFinished << "/" << paths.size()
+                          << std::flush;
+            }
+        });
+
+    if (settings.terminalOutput)
+    {
+        std::cout << std::endl;
+    }
+}
+
 double IndexFileBuilder::percent() const
 {
     if (maximumTotal_ == 0)
@@ -109,13 +212,25 @@ void IndexFileBuilder::start(const std::string &outputPath,
     intensityMax_ = 0;
 
     indexMain_.clear();
-    indexNode_.clear();
+    indexNodes_.clear();
     indexMainUsed_.clear();
 
+    sortRuns_.clear();
+    sortRunPoints_ = 0;
+    sortKey_ = 0;
+    sortRun_ = 0;
+
+    shuffleBuckets_ = 0;
+    shufflePoints_ = 0;
+    shuffleIndex_ = 0;
+
     settings_ = settings;
     buffer_.resize(settings_.bufferSize);
     bufferOut_.resize(settings_.bufferSize);
 
+    // Create worker threads.
+    threadPool_.create(settings_.numberOfThreads);
+
     // Open files.
     inputPath_ = inputPath;
     outputPath_ = outputPath;
@@ -269,6 +384,10 @@ void IndexFileBuilder::next()
             stateCopy();
             break;
 
+        case STATE_SHUFFLE_POINTS:
+            stateShufflePoints();
+            break;
+
         case STATE_COPY_POINTS:
             stateCopyPoints();
             break;
@@ -305,6 +424,10 @@ void IndexFileBuilder::next()
             stateMainSort();
             break;
 
+        case STATE_MAIN_MERGE:
+            stateMainMerge();
+            break;
+
         case STATE_NODE_INSERT:
             stateNodeInsert();
             break;
@@ -354,6 +477,17 @@ void IndexFileBuilder::nextState()
             break;
 
         case STATE_COPY_VLR:
+            state_ = STATE_SHUFFLE_POINTS;
+            maximumIndex_ = inputLas_.header.number_of_point_records;
+            if (settings_.randomizePoints &&
+                settings_.randomizeMethod ==
+                    ImportSettings::RandomizeMethod::SHUFFLE)
+            {
+                maximum_ = sizePoints_;
+            }
+            break;
+
+        case STATE_SHUFFLE_POINTS:
             state_ = STATE_COPY_POINTS;
             maximum_ = sizePoints_;
             maximumIndex_ = inputLas_.header.number_of_point_records;
@@ -413,6 +547,11 @@ void IndexFileBuilder::nextState()
             break;
 
         case STATE_MAIN_SORT:
+            state_ = STATE_MAIN_MERGE;
+            maximum_ = sizePointsOut_;
+            break;
+
+        case STATE_MAIN_MERGE:
             state_ = STATE_NODE_INSERT;
             maximum_ = sizePointsOut_;
             maximumIndex_ = indexMain_.size();
@@ -585,6 +724,132 @@ void IndexFileBuilder::formatPoint(uint8_t *pout, const uint8_t *pin) const
     }
 }
 
+void IndexFileBuilder::stateShufflePoints()
+{
+    // Points are shuffled by random key external sort. Each point gets
+    // a random bucket. Buckets are small enough to be shuffled in memory
+    // when the points are copied to the output.
+    if (maximum_ == 0)
+    {
+        return;
+    }
+
+    if (value_ == 0)
+    {
+        size_t recordSize = sizePoint_ + sizeOfAttributesPerPoint_;
+
+        uint64_t nBytesBucket = settings_.sortBufferSize / 2;
+        if (nBytesBucket < recordSize)
+        {
+            nBytesBucket = recordSize;
+        }
+
+        uint64_t nBytes = maximumIndex_ * recordSize;
+        shuffleBuckets_ = (nBytes + nBytesBucket - 1) / nBytesBucket;
+        if (shuffleBuckets_ < 1)
+        {
+            shuffleBuckets_ = 1;
+        }
+
+        shuffleGenerator_.seed();
+        shufflePoints_ = 0;
+        shuffleIndex_ = 0;
+
+        sortBegin(recordSize, shuffleBuckets_);
+
+        inputLas_.seekPoint(0);
+    }
+
+    // Step.
+    uint64_t nPoints = buffer_.size() / sizePoint_;
+    uint64_t nPointsRemain = maximumIndex_ - valueIndex_;
+    if (nPointsRemain < nPoints)
+    {
+        nPoints = nPointsRemain;
+    }
+
+    // Do not overflow the current run.
+    if (sortRunSize_ - sortRunPoints_ < nPoints)
+    {
+        nPoints = sortRunSize_ - sortRunPoints_;
+    }
+    uint64_t nBytes = nPoints * sizePoint_;
+
+    // Read N points.
+    uint8_t *buffer = buffer_.data();
+
+    inputLas_.readBuffer(buffer, nBytes);
+    inputLas_.readAttributesBuffer(attributes_, nPoints);
+
+    // Distribute N points to random buckets.
+    for (uint64_t i = 0; i < nPoints; i++)
+    {
+        uint64_t bucket = shuffleGenerator_() % shuffleBuckets_;
+        sortAppend(bucket, buffer + (i * sizePoint_), i);
+    }
+
+    // Next.
+    value_ += nBytes;
+    valueTotal_ += nBytes;
+    valueIndex_ += nPoints;
+
+    // Keep all points in memory when they fit into one run.
+    if (valueIndex_ == maximumIndex_ && sortRuns_.empty())
+    {
+        return;
+    }
+
+    // Spill the current run when it is full or when the input is finished.
+    if (sortRunPoints_ == sortRunSize_ || valueIndex_ == maximumIndex_)
+    {
+        sortRunWrite();
+    }
+
+    if (valueIndex_ == maximumIndex_)
+    {
+        sortBuffer_.clear();
+        sortBuffer_.shrink_to_fit();
+        sortMergeBegin();
+    }
+}
+
+void IndexFileBuilder::shuffleNextBucket()
+{
+    // Load the next bucket.
+    if (sortRuns_.empty())
+    {
+        shuffleBuffer_.swap(sortBuffer_);
+        shufflePoints_ = sortRunPoints_;
+        sortRunPoints_ = 0;
+    }
+    else
+    {
+        shufflePoints_ = sortMergeNextKey();
+        shuffleBuffer_.resize(shufflePoints_ * sortRecordSize_);
+        (void)sortMergeRead(shuffleBuffer_.data(), shufflePoints_);
+    }
+
+    if (shufflePoints_ == 0)
+    {
+        THROW("Missing shuffled points for file '" + readPath_ + "'");
+    }
+
+    shuffleIndex_ = 0;
+
+    // Fisher-Yates shuffle.
+    uint8_t *data = shuffleBuffer_.data();
+    for (uint64_t i = shufflePoints_ - 1; i > 0; i--)
+    {
+        uint64_t j = shuffleGenerator_() % (i + 1);
+        if (i != j)
+        {
+            std::swap_ranges(data + (i * sortRecordSize_),
+                             data + ((i + 1) * sortRecordSize_),
+                             data + (j * sortRecordSize_));
+        }
+    }
+}
+
 void IndexFileBuilder::stateCopyPoints()
 {
     // Step.
@@ -614,7 +879,45 @@ void IndexFileBuilder::stateCopyPoints()
     // Coordinates without scaling.
     coords_.resize(nPoints * 3);
 
-    if (settings_.randomizePoints)
+    if (settings_.randomizePoints &&
+        settings_.randomizeMethod == ImportSettings::RandomizeMethod::SHUFFLE)
+    {
+        // Process one step of shuffled points.
+        const uint8_t *record;
+
+        for (size_t i = 0; i < nPoints; i++)
+        {
+            if (shuffleIndex_ == shufflePoints_)
+            {
+                shuffleNextBucket();
+            }
+
+            record = shuffleBuffer_.data() + (shuffleIndex_ * sortRecordSize_);
+            shuffleIndex_++;
+
+            // Copy.
+            out = bufferOut + (i * sizePointOut_);
+            std::memcpy(out, record, sizePoint_);
+
+            // Format point data to a different LAS version.
+            if ((inputLas_.header.point_data_record_format < 6) &&
+                (outputLas_.header.point_data_record_format >= 6))
+            {
+                formatPoint(out, record);
+            }
+
+            // Attributes.
+            record += sizePoint_;
+            for (auto &attribute : attributesOut_.attributes)
+            {
+                std::memcpy(attribute.data.data() + (i * attribute.recordSize),
+                            record,
+                            attribute.recordSize);
+                record += attribute.recordSize;
+            }
+        }
+    }
+    else if (settings_.randomizePoints)
     {
         // Process one step of the input.
         for (size_t i = 0; i < nPoints; i++)
@@ -727,6 +1030,13 @@ void IndexFileBuilder::stateCopyPoints()
     value_ += (nPoints * sizePoint_);
     valueTotal_ += (nPoints * sizePoint_);
     valueIndex_ += nPoints;
+
+    if (valueIndex_ == maximumIndex_)
+    {
+        shuffleBuffer_.clear();
+        shuffleBuffer_.shrink_to_fit();
+        sortEnd();
+    }
 }
 
 void IndexFileBuilder::stateMove()
@@ -783,21 +1093,39 @@ void IndexFileBuilder::stateMainInsert()
 
     // Points.
     uint8_t *buffer = buffer_.data();
-    uint8_t *point;
 
     inputLas_.readBuffer(buffer, nBytes);
 
-    double x;
-    double y;
-    double z;
-
+    // Classify N points to octants in parallel.
+    indexCodes_.resize(nPoints);
+
+    size_t nTasks = threadPool_.size();
+    uint64_t nPointsPerTask = (nPoints + nTasks - 1) / nTasks;
+
+    threadPool_.run(nTasks,
+                    [&](size_t task)
+                    {
+                        uint64_t begin = task * nPointsPerTask;
+                        uint64_t end = begin + nPointsPerTask;
+                        if (end > nPoints)
+                        {
+                            end = nPoints;
+                        }
+
+                        for (uint64_t i = begin; i < end; i++)
+                        {
+                            const uint8_t *p = buffer + (i * sizePoint_);
+                            double x = indexFileBuilderCoordinate(p + 0);
+                            double y = indexFileBuilderCoordinate(p + 4);
+                            double z = indexFileBuilderCoordinate(p + 8);
+                            indexCodes_[i] = indexMain_.code(x, y, z);
+                        }
+                    });
+
+    // Insert N points to the tree in the original order.
     for (uint64_t i = 0; i < nPoints; i++)
     {
-        point = buffer + (i * sizePoint_);
-        x = indexFileBuilderCoordinate(point + 0);
-        y = indexFileBuilderCoordinate(point + 4);
-        z = indexFileBuilderCoordinate(point + 8);
-        (void)indexMain_.insert(x, y, z);
+        (void)indexMain_.insertCode(indexCodes_[i]);
     }
 
     // Next.
@@ -809,18 +1137,43 @@ void IndexFileBuilder::stateMainInsert()
 void IndexFileBuilder::stateMainEnd()
 {
     indexMain_.insertEnd();
+    indexCodes_.clear();
+    indexCodes_.shrink_to_fit();
 
     // Write main index.
     std::string indexPath = extension(outputPath_);
     indexFile_.open(indexPath, "w");
     indexMain_.write(indexFile_);
 
+    // Create compressed pages or remove outdated compressed pages.
+    std::string pagesPath = PageFile::extension(outputPath_);
+    if (settings_.compressPages)
+    {
+        pageFile_.create(pagesPath,
+                         indexMain_.size(),
+                         outputLas_.header.number_of_point_records);
+    }
+    else if (File::exists(pagesPath))
+    {
+        File::remove(pagesPath);
+    }
+
+    // Create page summaries.
+    summaryFile_.create(PageSummaryFile::extension(outputPath_),
+                        indexMain_.size());
+
     // Next initial file offset.
     inputLas_.seekPoint(0);
 }
 
 void IndexFileBuilder::stateMainSort()
 {
+    // Start sorting of points by node.
+    if (value_ == 0)
+    {
+        sortBegin(sizePoint_ + sizeOfAttributesPerPoint_, indexMain_.size());
+    }
+
     // Step.
     uint64_t nPoints = buffer_.size() / sizePoint_;
     uint64_t nPointsRemain = maximumIndex_ - valueIndex_;
@@ -828,6 +1181,12 @@ void IndexFileBuilder::stateMainSort()
     {
         nPoints = nPointsRemain;
     }
+
+    // Do not overflow the current run.
+    if (sortRunSize_ - sortRunPoints_ < nPoints)
+    {
+        nPoints = sortRunSize_ - sortRunPoints_;
+    }
     uint64_t nBytes = nPoints * sizePoint_;
 
     // Read N points.
@@ -844,6 +1203,7 @@ void IndexFileBuilder::stateMainSort()
     uint16_t intensity;
     uint16_t color;
     const IndexFile::Node *node;
+    const IndexFile::Node *root = indexMain_.root();
 
     for (uint64_t i = 0; i < nPoints; i++)
     {
@@ -883,12 +1243,8 @@ void IndexFileBuilder::stateMainSort()
         node = indexMain_.selectNode(indexMainUsed_, x, y, z);
         if (node)
         {
-            uint64_t pos = indexMainUsed_[node]++;
-            pos += node->from;
-            // Write 1 point.
-            outputLas_.seekPoint(pos);
-            outputLas_.writeBuffer(point, sizePoint_);
-            outputLas_.writeAttributesBuffer(attributes_, 1, pos);
+            indexMainUsed_[node]++;
+            sortAppend(static_cast<uint64_t>(node - root), point, i);
         }
     }
 
@@ -896,6 +1252,423 @@ void IndexFileBuilder::stateMainSort()
     value_ += nBytes;
     valueTotal_ += nBytes;
     valueIndex_ += nPoints;
+
+    // Write sorted points directly when all points fit into one run.
+    if (valueIndex_ == maximumIndex_ && sortRuns_.empty())
+    {
+        uint64_t nPointsSorted = sortRun(false);
+        uint64_t nPointsStep = buffer_.size() / sizePoint_;
+        uint64_t nPointsWritten = 0;
+        const uint8_t *records = sortBufferOut_.data();
+
+        outputLas_.seekPoint(0);
+
+        while (nPointsWritten < nPointsSorted)
+        {
+            uint64_t n = nPointsSorted - nPointsWritten;
+            if (n > nPointsStep)
+            {
+                n = nPointsStep;
+            }
+
+            sortWritePoints(records + (nPointsWritten * sortRecordSize_), n);
+            nPointsWritten += n;
+        }
+
+        sortEnd();
+        return;
+    }
+
+    // Spill the current run when it is full or when the input is finished.
+    if (sortRunPoints_ == sortRunSize_ || valueIndex_ == maximumIndex_)
+    {
+        sortRunWrite();
+    }
+
+    if (valueIndex_ == maximumIndex_)
+    {
+        sortBuffer_.clear();
+        sortBuffer_.shrink_to_fit();
+        sortMergeBegin();
+        sortBufferOut_.resize((buffer_.size() / sizePoint_) * sortRecordSize_);
+        outputLas_.seekPoint(0);
+    }
+}
+
+void IndexFileBuilder::stateMainMerge()
+{
+    // Nothing to merge when all points were written by the sort.
+    if (sortRuns_.empty())
+    {
+        valueTotal_ += maximum_ - value_;
+        value_ = maximum_;
+        return;
+    }
+
+    // Step.
+    uint64_t nPoints = 0;
+    uint64_t nPointsMax = sortBufferOut_.size() / sortRecordSize_;
+    uint8_t *out = sortBufferOut_.data();
+    bool finished = false;
+
+    // Merge all runs node by node.
+    while (nPoints < nPointsMax)
+    {
+        uint64_t n = sortMergeRead(out + (nPoints * sortRecordSize_),
+                                   nPointsMax - nPoints);
+        if (n == 0 && sortMergeNextKey() == 0)
+        {
+            finished = true;
+            break;
+        }
+
+        nPoints += n;
+    }
+
+    // Write N points.
+    if (nPoints > 0)
+    {
+        sortWritePoints(out, nPoints);
+    }
+
+    // Next.
+    uint64_t nBytes = nPoints * sizePoint_;
+    if (finished)
+    {
+        nBytes = maximum_ - value_;
+    }
+
+    value_ += nBytes;
+    valueTotal_ += nBytes;
+
+    if (value_ == maximum_)
+    {
+        sortEnd();
+    }
+}
+
+void IndexFileBuilder::sortBegin(size_t recordSize, uint64_t nKeys)
+{
+    // Memory is divided between unsorted and sorted copy of each run.
+    sortRecordSize_ = recordSize;
+    sortRunSize_ = settings_.sortBufferSize / (2 * sortRecordSize_);
+    if (sortRunSize_ < 1)
+    {
+        sortRunSize_ = 1;
+    }
+    sortRunPoints_ = 0;
+
+    sortBuffer_.resize(sortRunSize_ * sortRecordSize_);
+    sortKeys_.resize(sortRunSize_);
+    sortCounts_.resize(nKeys);
+    sortRuns_.clear();
+    sortKey_ = 0;
+    sortRun_ = 0;
+}
+
+void IndexFileBuilder::sortEnd()
+{
+    sortRuns_.clear();
+    sortRunPoints_ = 0;
+
+    sortBuffer_.clear();
+    sortBuffer_.shrink_to_fit();
+    sortBufferOut_.clear();
+    sortBufferOut_.shrink_to_fit();
+    sortKeys_.clear();
+    sortKeys_.shrink_to_fit();
+    sortCounts_.clear();
+    sortCounts_.shrink_to_fit();
+
+    if (sortFile_.open())
+    {
+        sortFile_.close();
+        File::remove(sortPath_);
+    }
+}
+
+void IndexFileBuilder::sortAppend(uint64_t key,
+                                  const uint8_t *point,
+                                  uint64_t index)
+{
+    // Append 1 point with its attributes to the current run.
+    sortKeys_[sortRunPoints_] = key;
+
+    uint8_t *record = sortBuffer_.data() + (sortRunPoints_ * sortRecordSize_);
+    std::memcpy(record, point, sizePoint_);
+    record += sizePoint_;
+
+    for (const auto &attribute : attributes_.attributes)
+    {
+        std::memcpy(record,
+                    attribute.data.data() + (index * attribute.recordSize),
+                    attribute.recordSize);
+        record += attribute.recordSize;
+    }
+
+    sortRunPoints_++;
+}
+
+uint64_t IndexFileBuilder::sortRun(bool groups)
+{
+    // Count points with each key.
+    uint64_t nPoints = sortRunPoints_;
+    sortRunPoints_ = 0;
+
+    std::fill(sortCounts_.begin(), sortCounts_.end(), 0);
+    for (uint64_t i = 0; i < nPoints; i++)
+    {
+        sortCounts_[sortKeys_[i]]++;
+    }
+
+    // Sorted run can be stored as groups { key, count, points }.
+    uint64_t nBytesGroupHeader = groups ? 16 : 0;
+
+    uint64_t nBytes = nPoints * sortRecordSize_;
+    for (const auto &count : sortCounts_)
+    {
+        if (count > 0)
+        {
+            nBytes += nBytesGroupHeader;
+        }
+    }
+
+    sortBufferOut_.resize(nBytes);
+    uint8_t *out = sortBufferOut_.data();
+
+    // Convert key counts to key offsets.
+    uint64_t offset = 0;
+    for (size_t i = 0; i < sortCounts_.size(); i++)
+    {
+        uint64_t count = sortCounts_[i];
+        if (count > 0)
+        {
+            if (groups)
+            {
+                htol64(out + offset, static_cast<uint64_t>(i));
+                htol64(out + offset + 8, count);
+                offset += nBytesGroupHeader;
+            }
+
+            sortCounts_[i] = offset;
+            offset += count * sortRecordSize_;
+        }
+    }
+
+    // Stable sort of points by key.
+    for (uint64_t i = 0; i < nPoints; i++)
+    {
+        uint64_t &to = sortCounts_[sortKeys_[i]];
+        std::memcpy(out + to,
+                    sortBuffer_.data() + (i * sortRecordSize_),
+                    sortRecordSize_);
+        to += sortRecordSize_;
+    }
+
+    return nPoints;
+}
+
+void IndexFileBuilder::sortRunWrite()
+{
+    (void)sortRun(true);
+
+    // Append sorted run to the temporary file.
+    if (!sortFile_.open())
+    {
+        sortPath_ = File::tmpname(outputPath_);
+        sortFile_.create(sortPath_);
+    }
+
+    SortRun run;
+    run.offset = sortFile_.size();
+    run.end = run.offset + sortBufferOut_.size();
+    run.key = 0;
+    run.remain = 0;
+    run.bufferBegin = 0;
+    run.bufferEnd = 0;
+
+    sortFile_.seek(run.offset);
+    sortFile_.write(sortBufferOut_.data(), sortBufferOut_.size());
+
+    sortRuns_.push_back(std::move(run));
+}
+
+void IndexFileBuilder::sortRunRead(SortRun &run,
+                                   uint8_t *buffer,
+                                   uint64_t nbyte)
+{
+    while (nbyte > 0)
+    {
+        // Refill the buffer by one sequential read.
+        if (run.bufferBegin == run.bufferEnd)
+        {
+            uint64_t n = run.end - run.offset;
+            if (n > run.buffer.size())
+            {
+                n = run.buffer.size();
+            }
+
+            if (n == 0)
+            {
+                THROW("Unexpected end of sorted run in file '" + sortPath_ +
+                      "'");
+            }
+
+            sortFile_.seek(run.offset);
+            sortFile_.read(run.buffer.data(), n);
+            run.offset += n;
+            run.bufferBegin = 0;
+            run.bufferEnd = static_cast<size_t>(n);
+        }
+
+        // Copy from the buffer.
+        size_t n = run.bufferEnd - run.bufferBegin;
+        if (static_cast<uint64_t>(n) > nbyte)
+        {
+            n = static_cast<size_t>(nbyte);
+        }
+
+        std::memcpy(buffer, run.buffer.data() + run.bufferBegin, n);
+        run.bufferBegin += n;
+        buffer += n;
+        nbyte -= n;
+    }
+}
+
+void IndexFileBuilder::sortRunNext(SortRun &run)
+{
+    // End of run.
+    if (run.offset == run.end && run.bufferBegin == run.bufferEnd)
+    {
+        run.key = sortCounts_.size();
+        run.remain = 0;
+        return;
+    }
+
+    // Read the header of the next group of points.
+    uint8_t header[16];
+    sortRunRead(run, header, sizeof(header));
+    run.key = ltoh64(header);
+    run.remain = ltoh64(header + 8);
+}
+
+void IndexFileBuilder::sortMergeBegin()
+{
+    LOG_DEBUG(<< "Merge <" << sortRuns_.size() << "> sorted runs.");
+
+    // Divide the sort buffer between runs.
+    size_t nBytesRun = settings_.sortBufferSize / sortRuns_.size();
+    if (nBytesRun < sortRecordSize_ + 16)
+    {
+        nBytesRun = sortRecordSize_ + 16;
+    }
+
+    for (auto &run : sortRuns_)
+    {
+        run.buffer.resize(nBytesRun);
+        sortRunNext(run);
+    }
+
+    // No key is selected.
+    sortKey_ = sortCounts_.size();
+    sortRun_ = 0;
+}
+
+uint64_t IndexFileBuilder::sortMergeNextKey()
+{
+    // Select the lowest key which has some points.
+    sortKey_ = sortCounts_.size();
+    for (const auto &run : sortRuns_)
+    {
+        if (run.key < sortKey_)
+        {
+            sortKey_ = run.key;
+        }
+    }
+
+    sortRun_ = 0;
+
+    // Count points with this key.
+    uint64_t nPoints = 0;
+    for (const auto &run : sortRuns_)
+    {
+        if (run.key == sortKey_)
+        {
+            nPoints += run.remain;
+        }
+    }
+
+    return nPoints;
+}
+
+uint64_t IndexFileBuilder::sortMergeRead(uint8_t *buffer, uint64_t nPoints)
+{
+    // Read up to N points with the current key. Runs are visited in
+    // the order in which they were created to keep the order of points.
+    uint64_t nPointsRead = 0;
+
+    while (nPointsRead < nPoints && sortRun_ < sortRuns_.size())
+    {
+        SortRun &run = sortRuns_[sortRun_];
+
+        if (run.key == sortKey_ && run.remain > 0)
+        {
+            uint64_t n = run.remain;
+            if (n > nPoints - nPointsRead)
+            {
+                n = nPoints - nPointsRead;
+            }
+
+            sortRunRead(run,
+                        buffer + (nPointsRead * sortRecordSize_),
+                        n * sortRecordSize_);
+            nPointsRead += n;
+            run.remain -= n;
+
+            if (run.remain == 0)
+            {
+                sortRunNext(run);
+            }
+        }
+        else
+        {
+            sortRun_++;
+        }
+    }
+
+    return nPointsRead;
+}
+
+void IndexFileBuilder::sortWritePoints(const uint8_t *records,
+                                       uint64_t nPoints)
+{
+    // Split point records to point data and attributes.
+    size_t nBytes = static_cast<size_t>(nPoints * sizePoint_);
+    if (bufferOut_.size() < nBytes)
+    {
+        bufferOut_.resize(nBytes);
+    }
+
+    outputLas_.createAttributesBuffer(attributesOut_, nPoints);
+
+    uint8_t *out = bufferOut_.data();
+    for (uint64_t i = 0; i < nPoints; i++)
+    {
+        std::memcpy(out + (i * sizePoint_), records, sizePoint_);
+        records += sizePoint_;
+
+        for (auto &attribute : attributesOut_.attributes)
+        {
+            std::memcpy(attribute.data.data() + (i * attribute.recordSize),
+                        records,
+                        attribute.recordSize);
+            records += attribute.recordSize;
+        }
+    }
+
+    // Write N points sequentially.
+    outputLas_.writeBuffer(out, nBytes);
+    outputLas_.writeAttributesBuffer(attributesOut_, nPoints);
 }
 
 static int FileIndexBuilderCmp(const void *a, const void *b)
@@ -918,57 +1691,138 @@ static int FileIndexBuilderCmp(const void *a, const void *b)
 
 void IndexFileBuilder::stateNodeInsert()
 {
-    // Step.
-    IndexFile::Node *node = indexMain_.at(static_cast<size_t>(valueIndex_));
-    uint64_t nBytesInIndexPage = node->size * sizePoint_;
+    // Step. Nodes are stored one after another in point data, so a batch
+    // of consecutive nodes is read and written by single sequential I/O.
+    size_t recordSize = sizePoint_ + sizeOfAttributesPerPoint_;
+    size_t idxBegin = static_cast<size_t>(valueIndex_);
+    size_t idxEnd = idxBegin;
+    uint64_t nPoints = 0;
+
+    while (idxEnd < maximumIndex_)
+    {
+        uint64_t n = indexMain_.at(idxEnd)->size;
+        if (idxEnd > idxBegin &&
+            (nPoints + n) * recordSize > settings_.sortBufferSize / 2)
+        {
+            break;
+        }
+
+        nPoints += n;
+        idxEnd++;
+    }
+
+    size_t nNodes = idxEnd - idxBegin;
+    uint64_t from = indexMain_.at(idxBegin)->from;
+    uint64_t nBytes = nPoints * sizePoint_;
 
     // Read N points.
-    std::vector<uint8_t> bufferNode;
-    bufferNode.resize(nBytesInIndexPage);
+    buffer_.resize(nBytes);
+    bufferOut_.resize(nBytes);
+
+    outputLas_.seekPoint(from);
+    outputLas_.readBuffer(buffer_.data(), nBytes);
+    outputLas_.readAttributesBuffer(attributes_, nPoints);
+    outputLas_.createAttributesBuffer(attributesOut_, nPoints);
+
+    // Sort points in each node of this batch in parallel.
+    indexNodes_.resize(nNodes);
+    pageBlocks_.resize(nNodes);
+    pageSummaries_.resize(nNodes);
+
+    // Workers only read the output file, their buffers are created here.
+    pageAttributes_.resize(nNodes);
+    for (size_t i = 0; i < nNodes; i++)
+    {
+        outputLas_.createAttributesBuffer(pageAttributes_[i],
+                                          indexMain_.at(idxBegin + i)->size);
+    }
 
-    uint8_t *buffer = bufferNode.data();
-    uint8_t *point;
+    threadPool_.run(nNodes,
+                    [&](size_t task) {
+                        nodeInsert(indexNodes_[task],
+                                   pageBlocks_[task],
+                                   pageSummaries_[task],
+                                   pageAttributes_[task],
+                                   indexMain_.at(idxBegin + task),
+                                   from);
+                    });
+
+    // Write node indices in the same order as serial processing.
+    for (size_t i = 0; i < nNodes; i++)
+    {
+        indexMain_.at(idxBegin + i)->offset = indexFile_.offset();
+        indexNodes_[i].write(indexFile_);
+        indexNodes_[i].clear();
+
+        if (settings_.compressPages)
+        {
+            pageFile_.write(idxBegin + i, pageBlocks_[i]);
+        }
+
+        summaryFile_.write(idxBegin + i, pageSummaries_[i]);
+    }
+
+    // Write N sorted points.
+    outputLas_.seekPoint(from);
+    outputLas_.writeBuffer(bufferOut_.data(), nBytes);
+    outputLas_.writeAttributesBuffer(attributesOut_, nPoints);
 
-    outputLas_.seekPoint(node->from);
-    outputLas_.readBuffer(buffer, nBytesInIndexPage);
-    outputLas_.readAttributesBuffer(attributes_, node->size);
-    outputLas_.createAttributesBuffer(attributesOut_, node->size);
+    // Next.
+    value_ += nBytes;
+    valueTotal_ += nBytes;
+    valueIndex_ += nNodes;
+}
+
+void IndexFileBuilder::nodeInsert(IndexFile &indexNode,
+                                  std::vector<uint8_t> &pageBlock,
+                                  PageSummary &pageSummary,
+                                  LasFile::AttributesBuffer &pageAttributes,
+                                  const IndexFile::Node *node,
+                                  uint64_t from)
+{
+    // Workers run in parallel, the output file is only read.
+    const LasFile &las = outputLas_;
+
+    // Points of this node in the batch buffers.
+    uint64_t first = node->from - from;
+
+    const uint8_t *buffer = buffer_.data() + (first * sizePoint_);
+    const uint8_t *point;
 
     // Actual boundary of this page.
-    coords_.resize(node->size * 3);
+    std::vector<double> coords;
+    coords.resize(node->size * 3);
     for (uint64_t i = 0; i < node->size; i++)
     {
         point = buffer + (i * sizePoint_);
-        coords_[i * 3 + 0] = indexFileBuilderCoordinate(point + 0);
-        coords_[i * 3 + 1] = indexFileBuilderCoordinate(point + 4);
-        coords_[i * 3 + 2] = indexFileBuilderCoordinate(point + 8);
+        coords[i * 3 + 0] = indexFileBuilderCoordinate(point + 0);
+        coords[i * 3 + 1] = indexFileBuilderCoordinate(point + 4);
+        coords[i * 3 + 2] = indexFileBuilderCoordinate(point + 8);
     }
 
     Box<double> box;
-    box.set(coords_);
+    box.set(coords);
 
     // Start new node.
-    indexNode_.clear();
-    indexNode_.insertBegin(box,
-                           box,
-                           settings_.maxIndexLevel2Size,
-                           settings_.maxIndexLevel2,
-                           true);
+    indexNode.clear();
+    indexNode.insertBegin(box,
+                          box,
+                          settings_.maxIndexLevel2Size,
+                          settings_.maxIndexLevel2,
+                          true);
 
     std::vector<uint64_t> bufferCodes;
     bufferCodes.resize(node->size * 2); // pair { code, index }
 
     for (uint64_t i = 0; i < node->size; i++)
     {
-        bufferCodes[i * 2 + 0] = indexNode_.insert(coords_[i * 3 + 0],
-                                                   coords_[i * 3 + 1],
-                                                   coords_[i * 3 + 2]);
+        bufferCodes[i * 2 + 0] = indexNode.insert(coords[i * 3 + 0],
+                                                  coords[i * 3 + 1],
+                                                  coords[i * 3 + 2]);
         bufferCodes[i * 2 + 1] = i;
     }
 
-    indexNode_.insertEnd();
-    node->offset = indexFile_.offset();
-    indexNode_.write(indexFile_);
+    indexNode.insertEnd();
 
     // Get sort order of N points.
     size_t size = sizeof(uint64_t) * 2;
@@ -978,9 +1832,7 @@ void IndexFileBuilder::stateNodeInsert()
 #endif /* INDEX_FILE_BUILDER_DEBUG_SAME_ORDER */
 
     // Reorder N points.
-    std::vector<uint8_t> bufferNodeOut;
-    bufferNodeOut.resize(nBytesInIndexPage);
-    uint8_t *bufferOut = bufferNodeOut.data();
+    uint8_t *bufferOut = bufferOut_.data() + (first * sizePoint_);
     uint8_t *pointOut;
 
     for (uint64_t i = 0; i < node->size; i++)
@@ -992,22 +1844,55 @@ void IndexFileBuilder::stateNodeInsert()
 
     for (uint64_t i = 0; i < node->size; i++)
     {
-        outputLas_.copyAttributesBuffer(attributesOut_,
-                                        attributes_,
-                                        1,
-                                        i,
-                                        bufferCodes[i * 2 + 1]);
+        las.copyAttributesBuffer(attributesOut_,
+                                 attributes_,
+                                 1,
+                                 first + i,
+                                 first + bufferCodes[i * 2 + 1]);
     }
 
-    // Write N sorted points.
-    outputLas_.seekPoint(node->from);
-    outputLas_.writeBuffer(bufferOut, nBytesInIndexPage);
-    outputLas_.writeAttributesBuffer(attributesOut_, node->size);
+    // Summary of sorted points.
+    std::vector<uint16_t> intensity(n);
+    std::vector<uint8_t> classification(n);
+    LasFile::Point lasPoint;
 
-    // Next.
-    value_ += nBytesInIndexPage;
-    valueTotal_ += nBytesInIndexPage;
-    valueIndex_ += 1;
+    for (size_t i = 0; i < n; i++)
+    {
+        las.formatBytesToPoint(lasPoint, bufferOut + (i * sizePoint_));
+        intensity[i] = lasPoint.intensity;
+        classification[i] = lasPoint.classification;
+    }
+
+    pageSummary.clear();
+    pageSummary.setPoints(intensity.data(), classification.data(), n);
+
+    las.copyAttributesBuffer(pageAttributes, attributesOut_, n, 0, first);
+
+    // Attribute files are indexed by page data attribute.
+    const auto &attributes = pageAttributes.attributes;
+
+    std::vector<uint32_t> segment(n);
+    attributes[PageData::ATTRIBUTE_SEGMENT].read(segment);
+    pageSummary.setSegment(segment.data(), n);
+
+    std::vector<float> values(n);
+    attributes[PageData::ATTRIBUTE_ELEVATION].read(values);
+    pageSummary.setElevation(values.data(), n);
+    attributes[PageData::ATTRIBUTE_DESCRIPTOR].read(values);
+    pageSummary.setDescriptor(values.data(), n);
+
+    // Compress sorted points.
+    if (settings_.compressPages)
+    {
+        std::vector<uint8_t> data;
+        PageFile::encode(data,
+                         las,
+                         bufferOut,
+                         attributesOut_,
+                         first,
+                         node->size);
+        PageFile::compress(pageBlock, data, node->size);
+    }
 }
 
 void IndexFileBuilder::stateNodeEnd()
@@ -1015,6 +1900,13 @@ void IndexFileBuilder::stateNodeEnd()
     indexFile_.seek(0);
     indexMain_.write(indexFile_);
     indexFile_.close();
+
+    pageFile_.close();
+    pageBlocks_.clear();
+
+    summaryFile_.close();
+    pageSummaries_.clear();
+    pageAttributes_.clear();
 }
 
 void IndexFileBuilder::stateEnd()
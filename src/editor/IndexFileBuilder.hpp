@@ -24,6 +24,7 @@
 
 // Include std.
 #include <map>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -32,6 +33,9 @@
 #include <ImportSettings.hpp>
 #include <IndexFile.hpp>
 #include <LasFile.hpp>
+#include <PageFile.hpp>
+#include <PageSummaryFile.hpp>
+#include <ThreadPool.hpp>
 
 // Include local.
 #include <ExportEditor.hpp>
@@ -60,6 +64,12 @@ public:
                       const std::string &inputPath,
                       const ImportSettings &settings);
 
+    /** Index many files. Error message of each failed file is set in
+        errors, it is empty for files which were indexed. */
+    static void index(const std::vector<std::string> &paths,
+                      const ImportSettings &settings,
+                      std::vector<std::string> &errors);
+
 protected:
     // Settings.
     ImportSettings settings_;
@@ -79,6 +89,9 @@ protected:
         // Copy VLR file data.
         STATE_COPY_VLR,
 
+        // Distribute points to random buckets.
+        STATE_SHUFFLE_POINTS,
+
         // Copy point and attribute file data.
         STATE_COPY_POINTS,
 
@@ -103,9 +116,12 @@ protected:
         // Write main index.
         STATE_MAIN_END,
 
-        // Distribute points to nodes.
+        // Distribute points to sorted runs.
         STATE_MAIN_SORT,
 
+        // Merge sorted runs to nodes.
+        STATE_MAIN_MERGE,
+
         // Sort points in each index page.
         STATE_NODE_INSERT,
 
@@ -173,16 +189,63 @@ protected:
 
     // Index.
     IndexFile indexMain_;
-    IndexFile indexNode_;
+    std::vector<IndexFile> indexNodes_;
     ChunkFile indexFile_;
     std::map<const IndexFile::Node *, uint64_t> indexMainUsed_;
+    std::vector<uint64_t> indexCodes_;
     std::vector<double> coords_;
 
+    // Compressed pages.
+    PageFile pageFile_;
+    std::vector<std::vector<uint8_t>> pageBlocks_;
+
+    // Page summaries.
+    PageSummaryFile summaryFile_;
+    std::vector<PageSummary> pageSummaries_;
+    std::vector<LasFile::AttributesBuffer> pageAttributes_;
+
+    // Worker threads.
+    ThreadPool threadPool_;
+
+    // External sort.
+    /** Index File Builder Sorted Run. */
+    struct SortRun
+    {
+        uint64_t offset;
+        uint64_t end;
+        uint64_t key;
+        uint64_t remain;
+        std::vector<uint8_t> buffer;
+        size_t bufferBegin;
+        size_t bufferEnd;
+    };
+
+    File sortFile_;
+    std::string sortPath_;
+    size_t sortRecordSize_;
+    uint64_t sortRunSize_;
+    uint64_t sortRunPoints_;
+    std::vector<uint8_t> sortBuffer_;
+    std::vector<uint8_t> sortBufferOut_;
+    std::vector<uint64_t> sortKeys_;
+    std::vector<uint64_t> sortCounts_;
+    std::vector<SortRun> sortRuns_;
+    uint64_t sortKey_;
+    size_t sortRun_;
+
+    // Shuffle.
+    std::mt19937_64 shuffleGenerator_;
+    uint64_t shuffleBuckets_;
+    std::vector<uint8_t> shuffleBuffer_;
+    uint64_t shufflePoints_;
+    uint64_t shuffleIndex_;
+
     void openFiles();
 
     void nextState();
     void stateCreateAttributes();
     void stateCopy();
+    void stateShufflePoints();
     void stateCopyPoints();
     void stateCopyAttributes();
     void stateMove();
@@ -190,11 +253,33 @@ protected:
     void stateMainInsert();
     void stateMainEnd();
     void stateMainSort();
+    void stateMainMerge();
     void stateNodeInsert();
     void stateNodeEnd();
     void stateEnd();
 
     void formatPoint(uint8_t *pout, const uint8_t *pin) const;
+
+    void nodeInsert(IndexFile &indexNode,
+                    std::vector<uint8_t> &pageBlock,
+                    PageSummary &pageSummary,
+                    LasFile::AttributesBuffer &pageAttributes,
+                    const IndexFile::Node *node,
+                    uint64_t from);
+
+    void shuffleNextBucket();
+
+    void sortBegin(size_t recordSize, uint64_t nKeys);
+    void sortEnd();
+    void sortAppend(uint64_t key, const uint8_t *point, uint64_t index);
+    uint64_t sortRun(bool groups);
+    void sortRunWrite();
+    void sortRunRead(SortRun &run, uint8_t *buffer, uint64_t nbyte);
+    void sortRunNext(SortRun &run);
+    void sortMergeBegin();
+    uint64_t sortMergeNextKey();
+    uint64_t sortMergeRead(uint8_t *buffer, uint64_t nPoints);
+    void sortWritePoints(const uint8_t *records, uint64_t nPoints);
 };
 
 #include <WarningsEnable.hpp>
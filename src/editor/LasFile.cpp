@@ -472,6 +472,13 @@ void LasFile::writeBuffer(const uint8_t *buffer, uint64_t nbyte)
     file_.write(buffer, nbyte);
 }
 
+const uint8_t *LasFile::mapPoints(uint64_t index, uint64_t n)
+{
+    uint64_t pointSize = header.point_data_record_length;
+    uint64_t offset = header.offset_to_point_data + (index * pointSize);
+    return file_.map(offset, n * pointSize);
+}
+
 void LasFile::seekPoint(uint64_t index)
 {
     // Seek las.
@@ -974,7 +981,7 @@ void LasFile::formatPointToBytes(uint8_t *buffer, const Point &pt) const
 
 void LasFile::createAttributesBuffer(AttributesBuffer &buffer,
                                      uint64_t n,
-                                     bool setZero)
+                                     bool setZero) const
 {
     buffer.attributes.resize(attributeFiles_.size());
     for (size_t i = 0; i < attributeFiles_.size(); i++)
@@ -991,6 +998,38 @@ void LasFile::readAttributesBuffer(AttributesBuffer &buffer, uint64_t n)
     }
 }
 
+void LasFile::readAttribute(size_t id,
+                            std::vector<uint32_t> &v,
+                            uint64_t index,
+                            uint64_t n)
+{
+    attributeFiles_[id].read(v, index, n);
+}
+
+void LasFile::readAttribute(size_t id,
+                            std::vector<size_t> &v,
+                            uint64_t index,
+                            uint64_t n)
+{
+    attributeFiles_[id].read(v, index, n);
+}
+
+void LasFile::readAttribute(size_t id,
+                            std::vector<float> &v,
+                            uint64_t index,
+                            uint64_t n)
+{
+    attributeFiles_[id].read(v, index, n);
+}
+
+void LasFile::readAttribute(size_t id,
+                            std::vector<double> &v,
+                            uint64_t index,
+                            uint64_t n)
+{
+    attributeFiles_[id].read(v, index, n);
+}
+
 void LasFile::writeAttributesBuffer(const AttributesBuffer &buffer,
                                     uint64_t n,
                                     uint64_t from)
@@ -1001,11 +1040,19 @@ void LasFile::writeAttributesBuffer(const AttributesBuffer &buffer,
     }
 }
 
+void LasFile::writeAttribute(size_t id,
+                             const AttributesBuffer &buffer,
+                             uint64_t n,
+                             uint64_t from)
+{
+    attributeFiles_[id].writeBuffer(buffer.attributes[id], n, from);
+}
+
 void LasFile::copyAttributesBuffer(AttributesBuffer &dst,
                                    const AttributesBuffer &src,
                                    uint64_t n,
                                    uint64_t to,
-                                   uint64_t from)
+                                   uint64_t from) const
 {
     for (size_t i = 0; i < src.attributes.size(); i++)
     {
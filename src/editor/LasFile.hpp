@@ -254,22 +254,45 @@ public:
     void readBuffer(uint8_t *buffer, uint64_t nbyte);
     void writeBuffer(const uint8_t *buffer, uint64_t nbyte);
 
+    /** Map 'n' point records from 'index' to memory or return nullptr. */
+    const uint8_t *mapPoints(uint64_t index, uint64_t n);
+
     void formatBytesToPoint(Point &pt, const uint8_t *buffer) const;
     void formatPointToBytes(uint8_t *buffer, const Point &pt) const;
 
     // Attributes.
     void createAttributesBuffer(AttributesBuffer &buffer,
                                 uint64_t n,
-                                bool setZero = false);
+                                bool setZero = false) const;
     void readAttributesBuffer(AttributesBuffer &buffer, uint64_t n);
+    void readAttribute(size_t id,
+                       std::vector<uint32_t> &v,
+                       uint64_t index,
+                       uint64_t n);
+    void readAttribute(size_t id,
+                       std::vector<size_t> &v,
+                       uint64_t index,
+                       uint64_t n);
+    void readAttribute(size_t id,
+                       std::vector<float> &v,
+                       uint64_t index,
+                       uint64_t n);
+    void readAttribute(size_t id,
+                       std::vector<double> &v,
+                       uint64_t index,
+                       uint64_t n);
     void writeAttributesBuffer(const AttributesBuffer &buffer,
                                uint64_t n,
                                uint64_t from = 0);
+    void writeAttribute(size_t id,
+                        const AttributesBuffer &buffer,
+                        uint64_t n,
+                        uint64_t from = 0);
     void copyAttributesBuffer(AttributesBuffer &dst,
                               const AttributesBuffer &src,
                               uint64_t n,
                               uint64_t to = 0,
-                              uint64_t from = 0);
+                              uint64_t from = 0) const;
 
     const std::vector<RecordFile> &attributeFiles() const
     {
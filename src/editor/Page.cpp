@@ -27,6 +27,7 @@
 #include <File.hpp>
 #include <LasFile.hpp>
 #include <Page.hpp>
+#include <PageFilter.hpp>
 #include <Query.hpp>
 #include <Util.hpp>
 
@@ -35,6 +36,57 @@
 // #define LOG_MODULE_DEBUG_ENABLED 1
 #include <Log.hpp>
 
+static uint8_t pageSelectionBit(QueryWhere::Criterion criterion)
+{
+    return static_cast<uint8_t>(1U << criterion);
+}
+
+// Update 'bit' of all points, or only of 'n' points listed in 'rows'.
+template <class Rejected>
+static void pageSelectionMask(std::vector<uint8_t> &mask,
+                              uint8_t bit,
+                              const uint32_t *rows,
+                              size_t n,
+                              const Rejected &rejected)
+{
+    const uint8_t keep = static_cast<uint8_t>(~bit);
+
+    auto update = [&](size_t i)
+    {
+        if (rejected(i))
+        {
+            mask[i] |= bit;
+        }
+        else
+        {
+            mask[i] &= keep;
+        }
+    };
+
+    if (rows)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            update(rows[i]);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < mask.size(); i++)
+        {
+            update(i);
+        }
+    }
+}
+
+static void pageSelectionMaskClear(std::vector<uint8_t> &mask,
+                                   uint8_t bit,
+                                   const uint32_t *rows,
+                                   size_t n)
+{
+    pageSelectionMask(mask, bit, rows, n, [](size_t) { return false; });
+}
+
 Page::Page(Editor *editor, Query *query, uint32_t datasetId, uint32_t pageId)
     : position(nullptr),
       intensity(nullptr),
@@ -54,8 +106,10 @@ Page::Page(Editor *editor, Query *query, uint32_t datasetId, uint32_t pageId)
       query_(query),
       datasetId_(datasetId),
       pageId_(pageId),
-      state_(Page::STATE_READ)
+      state_(Page::STATE_READ),
+      dataRevision_(0)
 {
+    selectionRevision_.fill(0);
 }
 
 Page::~Page()
@@ -79,9 +133,25 @@ size_t Page::size() const
 
 void Page::setModified()
 {
-    if (pageData_)
+    if (!pageData_)
     {
-        pageData_->setModified();
+        return;
+    }
+
+    // Each modification changes the data revision, even when the page is
+    // already modified, so that selection masks are recomputed.
+    bool modified = pageData_->modified();
+    pageData_->setModified();
+
+    if (!modified)
+    {
+        // Page summary is outdated until the page is written.
+        PageSummaryFile *summaryFile =
+            editor_->datasets().key(datasetId_).summaryFile();
+        if (summaryFile)
+        {
+            summaryFile->setModified(pageId_);
+        }
     }
 }
 
@@ -95,6 +165,43 @@ bool Page::modified() const
     return false;
 }
 
+void Page::readAttribute(PageData::Attribute attribute)
+{
+    pageData_->readAttribute(editor_, attribute);
+    updateAttributes();
+}
+
+void Page::updateAttributes()
+{
+    // Attributes which were not read yet are not available.
+    const PageData &data = *pageData_;
+
+    segment = nullptr;
+    elevation = nullptr;
+    descriptor = nullptr;
+    voxel = nullptr;
+
+    if (data.hasAttribute(PageData::ATTRIBUTE_SEGMENT))
+    {
+        segment = pageData_->segment.data();
+    }
+
+    if (data.hasAttribute(PageData::ATTRIBUTE_ELEVATION))
+    {
+        elevation = pageData_->elevation.data();
+    }
+
+    if (data.hasAttribute(PageData::ATTRIBUTE_DESCRIPTOR))
+    {
+        descriptor = pageData_->descriptor.data();
+    }
+
+    if (data.hasAttribute(PageData::ATTRIBUTE_VOXEL))
+    {
+        voxel = pageData_->voxel.data();
+    }
+}
+
 void Page::resize(size_t n)
 {
     position = pageData_->position.data();
@@ -105,10 +212,7 @@ void Page::resize(size_t n)
     userData = pageData_->userData.data();
     gpsTime = pageData_->gpsTime.data();
     color = pageData_->color.data();
-    segment = pageData_->segment.data();
-    elevation = pageData_->elevation.data();
-    descriptor = pageData_->descriptor.data();
-    voxel = pageData_->voxel.data();
+    updateAttributes();
     renderPosition = pageData_->renderPosition.data();
 
     renderColor.resize(n * 3);
@@ -121,6 +225,10 @@ void Page::resize(size_t n)
     }
 
     selectedNodes_.reserve(64);
+
+    // New page data, all masks are computed again.
+    selectionMask_.resize(n);
+    selectionRevision_.fill(0);
 }
 
 void Page::readPage()
@@ -141,6 +249,20 @@ void Page::readPage()
     runModifiers();
 }
 
+void Page::readSelection()
+{
+    LOG_DEBUG(<< "Read selection datasetId <" << datasetId_ << "> pageId <"
+              << pageId_ << ">.");
+
+    // Modifiers are not applied, so this may run in a worker thread.
+    pageData_ = editor_->readPage(datasetId_, pageId_);
+
+    resize(pageData_->size());
+
+    transform();
+    queryWhere();
+}
+
 void Page::writePage()
 {
     if (pageData_ && pageData_->modified())
@@ -243,21 +365,28 @@ void Page::queryWhere()
     LOG_DEBUG(<< "Select page datasetId <" << datasetId_ << "> pageId <"
               << pageId_ << ">.");
 
-    const Region &region = query_->where().region();
+    if (query_->where().segmentArrayEnabled())
+    {
+        query_->updateSegmentArray();
+    }
 
-    if (region.matchesAll())
+    // Skip pages which can not contain matching points.
+    if (!query_->pageIntersects(datasetId_, pageId_))
     {
-        // Reset selection to mark all points as selected.
-        LOG_DEBUG(<< "Reset selection.");
-        uint32_t n = static_cast<uint32_t>(size());
-        selection.resize(n);
-        selectionSize = n;
-        for (uint32_t i = 0; i < n; i++)
-        {
-            selection[i] = i;
-        }
+        LOG_DEBUG(<< "Skip page by summary.");
+        selectionSize = 0;
+        state_ = Page::STATE_RUN_MODIFIERS;
+        return;
     }
-    else
+
+    const QueryWhere &where = query_->where();
+    const Region &region = where.region();
+    const bool regionAll =
+        region.matchesAll() || region.shape == Region::Shape::NONE;
+
+    // Region filters visit only points in the octants of page index which
+    // intersect the region, so small regions are cheap.
+    if (!regionAll)
     {
         queryWhereBox();
         queryWhereCone();
@@ -265,13 +394,78 @@ void Page::queryWhere()
         queryWhereSphere();
     }
 
-    queryWhereElevation();
-    queryWhereIntensity();
-    queryWhereDescriptor();
-    queryWhereClassification();
-    queryWhereSegment();
-    queryWhereSpecies();
-    queryWhereManagementStatus();
+    // Point data changed since masks were computed. Small regions update
+    // masks only of their points, so modifying points in small spheres does
+    // not cost full page passes. Masks of other points stay outdated until
+    // the next selection of a larger part of the page.
+    uint64_t dataRevision = pageData_->revision();
+    if (dataRevision_ != dataRevision && !regionAll &&
+        selectionSize < size() / 4)
+    {
+        for (size_t i = QueryWhere::CRITERION_ELEVATION;
+             i < QueryWhere::CRITERION_COUNT;
+             i++)
+        {
+            queryWhereCriterion(static_cast<QueryWhere::Criterion>(i),
+                                selection.data(),
+                                selectionSize);
+        }
+    }
+    else
+    {
+        // Point data changed since the last selection, all masks are stale.
+        if (dataRevision_ != dataRevision)
+        {
+            selectionRevision_.fill(0);
+            dataRevision_ = dataRevision;
+        }
+
+        // Recompute only masks of criteria which changed.
+        for (size_t i = QueryWhere::CRITERION_ELEVATION;
+             i < QueryWhere::CRITERION_COUNT;
+             i++)
+        {
+            QueryWhere::Criterion criterion =
+                static_cast<QueryWhere::Criterion>(i);
+
+            if (selectionRevision_[i] == where.revision(criterion))
+            {
+                continue;
+            }
+
+            queryWhereCriterion(criterion, nullptr, 0);
+            selectionRevision_[i] = where.revision(criterion);
+        }
+    }
+
+    // Intersection of region and all other criteria.
+    const uint8_t *mask = selectionMask_.data();
+    size_t nSelected = 0;
+
+    if (regionAll)
+    {
+        size_t n = selectionMask_.size();
+
+        for (size_t i = 0; i < n; i++)
+        {
+            if (mask[i] == 0)
+            {
+                selection[nSelected++] = static_cast<uint32_t>(i);
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < selectionSize; i++)
+        {
+            if (mask[selection[i]] == 0)
+            {
+                selection[nSelected++] = selection[i];
+            }
+        }
+    }
+
+    selectionSize = nSelected;
 
     state_ = Page::STATE_RUN_MODIFIERS;
 }
@@ -334,18 +528,12 @@ void Page::queryWhereBox()
             if (selectedNodes_[i].partial)
             {
                 // Partial selection, apply clip filter.
-                for (size_t j = 0; j < nNodePoints; j++)
-                {
-                    size_t idx = from + j;
-                    double x = position[3 * idx + 0];
-                    double y = position[3 * idx + 1];
-                    double z = position[3 * idx + 2];
-
-                    if (clipBox.contains(x, y, z))
-                    {
-                        selection[nSelected++] = static_cast<uint32_t>(idx);
-                    }
-                }
+                nSelected += PageFilter::box(selection.data() + nSelected,
+                                             position,
+                                             from,
+                                             nNodePoints,
+                                             pageData_->translation,
+                                             clipBox);
             }
             else
             {
@@ -377,22 +565,16 @@ void Page::queryWhereBox()
             if (selectedNodes_[i].partial)
             {
                 // Partial selection, apply clip filter.
-                for (size_t j = 0; j < nNodePoints; j++)
+                nSelected += PageFilter::box(selection.data() + nSelected,
+                                             position,
+                                             from,
+                                             nNodePoints,
+                                             pageData_->translation,
+                                             clipBox);
+                if (nSelected >= max)
                 {
-                    size_t idx = from + j;
-                    double x = position[3 * idx + 0];
-                    double y = position[3 * idx + 1];
-                    double z = position[3 * idx + 2];
-
-                    if (clipBox.contains(x, y, z))
-                    {
-                        selection[nSelected++] = static_cast<uint32_t>(idx);
-                        if (nSelected == max)
-                        {
-                            maxReached = true;
-                            break;
-                        }
-                    }
+                    nSelected = max;
+                    maxReached = true;
                 }
             }
             else
@@ -476,22 +658,16 @@ void Page::queryWhereCone()
         size_t from = static_cast<size_t>(nodeL2->from);
 
         // Partial/Whole selection, apply clip filter.
-        for (size_t j = 0; j < nNodePoints; j++)
+        nSelected += PageFilter::cone(selection.data() + nSelected,
+                                      position,
+                                      from,
+                                      nNodePoints,
+                                      pageData_->translation,
+                                      clipCone);
+        if (max > 0 && nSelected >= max)
         {
-            size_t idx = from + j;
-            double x = position[3 * idx + 0];
-            double y = position[3 * idx + 1];
-            double z = position[3 * idx + 2];
-
-            if (clipCone.contains(x, y, z))
-            {
-                selection[nSelected++] = static_cast<uint32_t>(idx);
-                if (nSelected == max)
-                {
-                    maxReached = true;
-                    break;
-                }
-            }
+            nSelected = max;
+            maxReached = true;
         }
 
         if (maxReached)
@@ -559,22 +735,16 @@ void Page::queryWhereCylinder()
         size_t from = static_cast<size_t>(nodeL2->from);
 
         // Partial/Whole selection, apply clip filter.
-        for (size_t j = 0; j < nNodePoints; j++)
+        nSelected += PageFilter::cylinder(selection.data() + nSelected,
+                                          position,
+                                          from,
+                                          nNodePoints,
+                                          pageData_->translation,
+                                          clipCylinder);
+        if (max > 0 && nSelected >= max)
         {
-            size_t idx = from + j;
-            double x = position[3 * idx + 0];
-            double y = position[3 * idx + 1];
-            double z = position[3 * idx + 2];
-
-            if (clipCylinder.contains(x, y, z))
-            {
-                selection[nSelected++] = static_cast<uint32_t>(idx);
-                if (nSelected == max)
-                {
-                    maxReached = true;
-                    break;
-                }
-            }
+            nSelected = max;
+            maxReached = true;
         }
 
         if (maxReached)
@@ -642,22 +812,16 @@ void Page::queryWhereSphere()
         size_t from = static_cast<size_t>(nodeL2->from);
 
         // Partial/Whole selection, apply clip filter.
-        for (size_t j = 0; j < nNodePoints; j++)
+        nSelected += PageFilter::sphere(selection.data() + nSelected,
+                                        position,
+                                        from,
+                                        nNodePoints,
+                                        pageData_->translation,
+                                        clipSphere);
+        if (max > 0 && nSelected >= max)
         {
-            size_t idx = from + j;
-            double x = position[3 * idx + 0];
-            double y = position[3 * idx + 1];
-            double z = position[3 * idx + 2];
-
-            if (clipSphere.contains(x, y, z))
-            {
-                selection[nSelected++] = static_cast<uint32_t>(idx);
-                if (nSelected == max)
-                {
-                    maxReached = true;
-                    break;
-                }
-            }
+            nSelected = max;
+            maxReached = true;
         }
 
         if (maxReached)
@@ -671,106 +835,123 @@ void Page::queryWhereSphere()
     query_->addResults(nSelected);
 }
 
-void Page::queryWhereElevation()
+void Page::queryWhereCriterion(QueryWhere::Criterion criterion,
+                               const uint32_t *rows,
+                               size_t n)
+{
+    switch (criterion)
+    {
+        case QueryWhere::CRITERION_ELEVATION:
+            queryWhereElevation(rows, n);
+            break;
+        case QueryWhere::CRITERION_DESCRIPTOR:
+            queryWhereDescriptor(rows, n);
+            break;
+        case QueryWhere::CRITERION_INTENSITY:
+            queryWhereIntensity(rows, n);
+            break;
+        case QueryWhere::CRITERION_CLASSIFICATION:
+            queryWhereClassification(rows, n);
+            break;
+        case QueryWhere::CRITERION_SEGMENT:
+            queryWhereSegment(rows, n);
+            break;
+        case QueryWhere::CRITERION_REGION:
+        case QueryWhere::CRITERION_DATASET:
+        case QueryWhere::CRITERION_COUNT:
+        default:
+            break;
+    }
+}
+
+void Page::queryWhereElevation(const uint32_t *rows, size_t n)
 {
     const Range<double> &elevationRange = query_->where().elevation();
+    const uint8_t bit = pageSelectionBit(QueryWhere::CRITERION_ELEVATION);
 
     if (elevationRange.full())
     {
+        pageSelectionMaskClear(selectionMask_, bit, rows, n);
         return;
     }
 
-    LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
-
-    size_t nSelectedNew = 0;
+    readAttribute(PageData::ATTRIBUTE_ELEVATION);
 
-    for (size_t i = 0; i < selectionSize; i++)
-    {
-        double elev = static_cast<double>(elevation[selection[i]]);
-
-        if (!(elev < elevationRange.minimumValue() ||
-              elev > elevationRange.maximumValue()))
-        {
-            if (nSelectedNew != i)
-            {
-                selection[nSelectedNew] = selection[i];
-            }
+    LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
 
-            nSelectedNew++;
-        }
-    }
+    const double min = elevationRange.minimumValue();
+    const double max = elevationRange.maximumValue();
+    const float *data = elevation;
 
-    selectionSize = nSelectedNew;
+    pageSelectionMask(selectionMask_,
+                      bit,
+                      rows,
+                      n,
+                      [&](size_t i) { return data[i] < min || data[i] > max; });
 }
 
-void Page::queryWhereDescriptor()
+void Page::queryWhereDescriptor(const uint32_t *rows, size_t n)
 {
     const Range<double> &descriptorRange = query_->where().descriptor();
+    const uint8_t bit = pageSelectionBit(QueryWhere::CRITERION_DESCRIPTOR);
 
     if (descriptorRange.full())
     {
+        pageSelectionMaskClear(selectionMask_, bit, rows, n);
         return;
     }
 
-    LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
-
-    size_t nSelectedNew = 0;
-
-    for (size_t i = 0; i < selectionSize; i++)
-    {
-        double v = descriptor[selection[i]];
+    readAttribute(PageData::ATTRIBUTE_DESCRIPTOR);
 
-        if (!(v < descriptorRange.minimumValue() ||
-              v > descriptorRange.maximumValue()))
-        {
-            if (nSelectedNew != i)
-            {
-                selection[nSelectedNew] = selection[i];
-            }
+    LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
 
-            nSelectedNew++;
-        }
-    }
+    const double min = descriptorRange.minimumValue();
+    const double max = descriptorRange.maximumValue();
+    const float *data = descriptor;
 
-    selectionSize = nSelectedNew;
+    pageSelectionMask(selectionMask_,
+                      bit,
+                      rows,
+                      n,
+                      [&](size_t i) { return data[i] < min || data[i] > max; });
 }
 
-void Page::queryWhereIntensity()
+void Page::queryWhereIntensity(const uint32_t *rows, size_t n)
 {
     const Range<double> &intensityRange = query_->where().intensity();
+    const uint8_t bit = pageSelectionBit(QueryWhere::CRITERION_INTENSITY);
 
     if (intensityRange.full())
     {
+        pageSelectionMaskClear(selectionMask_, bit, rows, n);
         return;
     }
 
     LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
 
-    size_t nSelectedNew = 0;
-
-    for (size_t i = 0; i < selectionSize; i++)
-    {
-        double v = intensity[selection[i]];
-
-        if (!(v < intensityRange.minimumValue() ||
-              v > intensityRange.maximumValue()))
-        {
-            if (nSelectedNew != i)
-            {
-                selection[nSelectedNew] = selection[i];
-            }
-
-            nSelectedNew++;
-        }
-    }
-
-    selectionSize = nSelectedNew;
+    const double min = intensityRange.minimumValue();
+    const double max = intensityRange.maximumValue();
+    const uint16_t *data = intensity;
+
+    pageSelectionMask(selectionMask_,
+                      bit,
+                      rows,
+                      n,
+                      [&](size_t i)
+                      {
+                          double v = data[i] / 65535.0;
+                          return v < min || v > max;
+                      });
 }
 
-void Page::queryWhereClassification()
+void Page::queryWhereClassification(const uint32_t *rows, size_t n)
 {
+    const uint8_t bit =
+        pageSelectionBit(QueryWhere::CRITERION_CLASSIFICATION);
+
     if (query_->where().classification().matchesAll())
     {
+        pageSelectionMaskClear(selectionMask_, bit, rows, n);
         return;
     }
 
@@ -780,149 +961,55 @@ void Page::queryWhereClassification()
     LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
     LOG_DEBUG(<< "Query classifications <" << classifications << ">.");
 
-    size_t nSelectedNew = 0;
-
-    for (size_t i = 0; i < selectionSize; i++)
-    {
-        uint32_t id = classification[selection[i]];
-        // LOG_DEBUG(<< "Query classification <" << id << "> at <" << i <<
-        // ">.");
-
-        if (id < classifications.size() && classifications[id])
-        {
-            if (nSelectedNew != i)
-            {
-                selection[nSelectedNew] = selection[i];
-            }
-
-            nSelectedNew++;
-        }
-    }
-
-    selectionSize = nSelectedNew;
+    const uint8_t *data = classification;
+
+    pageSelectionMask(selectionMask_,
+                      bit,
+                      rows,
+                      n,
+                      [&](size_t i)
+                      {
+                          uint32_t id = data[i];
+                          return !(id < classifications.size() &&
+                                   classifications[id]);
+                      });
 }
 
-void Page::queryWhereSegment()
+void Page::queryWhereSegment(const uint32_t *rows, size_t n)
 {
-    if (query_->where().segment().matchesAll())
-    {
-        return;
-    }
-
-    const std::unordered_set<size_t> &segmentFilter =
-        query_->where().segment().filter();
-    const Segments &segments = editor_->segments();
-
-    LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
-    LOG_DEBUG(<< "Filter size <" << segmentFilter.size() << ">.");
-
-    size_t nSelectedNew = 0;
-
-    for (size_t i = 0; i < selectionSize; i++)
-    {
-        size_t id = segment[selection[i]];
-
-        if (segmentFilter.find(id) != segmentFilter.end() ||
-            !segments.contains(id))
-        {
-            if (nSelectedNew != i)
-            {
-                selection[nSelectedNew] = selection[i];
-            }
-
-            nSelectedNew++;
-        }
-    }
-
-    LOG_DEBUG(<< "Old selection size <" << selectionSize << ">.");
-    LOG_DEBUG(<< "New selection size <" << nSelectedNew << ">.");
-    selectionSize = nSelectedNew;
-}
-
-void Page::queryWhereSpecies()
-{
-    if (query_->where().species().matchesAll())
-    {
-        return;
-    }
-
     const QueryWhere &where = query_->where();
-    const std::unordered_set<size_t> &speciesFilter = where.species().filter();
-    const SpeciesList &speciesList = editor_->speciesList();
-    const Segments &segments = editor_->segments();
-
-    LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
-    LOG_DEBUG(<< "Filter size <" << speciesFilter.size() << ">.");
-
-    size_t nSelectedNew = 0;
-
-    for (size_t i = 0; i < selectionSize; i++)
-    {
-        size_t segmentId = segment[selection[i]];
-        size_t segmentIndex = segments.index(segmentId, false);
-
-        if (segmentIndex != SIZE_MAX)
-        {
-            size_t speciesId = segments[segmentIndex].speciesId;
-
-            if (speciesFilter.find(speciesId) != speciesFilter.end() ||
-                !speciesList.contains(speciesId))
-            {
-                if (nSelectedNew != i)
-                {
-                    selection[nSelectedNew] = selection[i];
-                }
-                nSelectedNew++;
-            }
-        }
-    }
+    const uint8_t bit = pageSelectionBit(QueryWhere::CRITERION_SEGMENT);
 
-    LOG_DEBUG(<< "Old selection size <" << selectionSize << ">.");
-    LOG_DEBUG(<< "New selection size <" << nSelectedNew << ">.");
-    selectionSize = nSelectedNew;
-}
-
-void Page::queryWhereManagementStatus()
-{
-    if (query_->where().managementStatus().matchesAll())
+    if (!where.segmentArrayEnabled())
     {
+        pageSelectionMaskClear(selectionMask_, bit, rows, n);
         return;
     }
 
-    const std::unordered_set<size_t> &statusFilter =
-        query_->where().managementStatus().filter();
-    const ManagementStatusList &statusList = editor_->managementStatusList();
-    const Segments &segments = editor_->segments();
-
-    LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
-    LOG_DEBUG(<< "Filter size <" << statusFilter.size() << ">.");
-
-    size_t nSelectedNew = 0;
+    readAttribute(PageData::ATTRIBUTE_SEGMENT);
 
-    for (size_t i = 0; i < selectionSize; i++)
-    {
-        size_t segmentId = segment[selection[i]];
-        size_t segmentIndex = segments.index(segmentId, false);
+    // Segment, species and management status filters are compiled into
+    // a single lookup table indexed by segment id.
+    const std::vector<uint8_t> &segmentArray = where.segmentArray();
+    const uint8_t *lookup = segmentArray.data();
+    const size_t lookupSize = segmentArray.size();
+    const uint8_t lookupDefault = where.segmentArrayDefault();
 
-        if (segmentIndex != SIZE_MAX)
-        {
-            size_t statusId = segments[segmentIndex].managementStatusId;
-
-            if (statusFilter.find(statusId) != statusFilter.end() ||
-                !statusList.contains(statusId))
-            {
-                if (nSelectedNew != i)
-                {
-                    selection[nSelectedNew] = selection[i];
-                }
-                nSelectedNew++;
-            }
-        }
-    }
-
-    LOG_DEBUG(<< "Old selection size <" << selectionSize << ">.");
-    LOG_DEBUG(<< "New selection size <" << nSelectedNew << ">.");
-    selectionSize = nSelectedNew;
+    LOG_DEBUG(<< "Page pageId <" << pageId_ << ">.");
+    LOG_DEBUG(<< "Lookup table size <" << lookupSize << ">.");
+
+    const uint32_t *data = segment;
+
+    pageSelectionMask(selectionMask_,
+                      bit,
+                      rows,
+                      n,
+                      [&](size_t i)
+                      {
+                          size_t id = data[i];
+                          return ((id < lookupSize) ? lookup[id]
+                                                    : lookupDefault) == 0;
+                      });
 }
 
 void Page::runModifiers()
@@ -943,11 +1030,13 @@ void Page::runColorModifier()
 
     if (opt.colorSource() == ViewSettings::ColorSource::COLOR)
     {
+        const float s16 = 1.0F / 65535.0F;
+
         for (size_t i = 0; i < n; i++)
         {
-            renderColor[i * 3 + 0] = static_cast<float>(color[i * 3 + 0]);
-            renderColor[i * 3 + 1] = static_cast<float>(color[i * 3 + 1]);
-            renderColor[i * 3 + 2] = static_cast<float>(color[i * 3 + 2]);
+            renderColor[i * 3 + 0] = static_cast<float>(color[i * 3 + 0]) * s16;
+            renderColor[i * 3 + 1] = static_cast<float>(color[i * 3 + 1]) * s16;
+            renderColor[i * 3 + 2] = static_cast<float>(color[i * 3 + 2]) * s16;
         }
     }
     else if (opt.colorSource() == ViewSettings::ColorSource::INTENSITY)
@@ -962,7 +1051,7 @@ void Page::runColorModifier()
         for (size_t i = 0; i < n; i++)
         {
             setColor(i,
-                     static_cast<size_t>(intensity[i] * 255.0),
+                     static_cast<size_t>(intensity[i] / 257U),
                      255,
                      ColorPalette::BlueCyanYellowRed256);
         }
@@ -996,6 +1085,8 @@ void Page::runColorModifier()
     }
     else if (opt.colorSource() == ViewSettings::ColorSource::SEGMENT)
     {
+        readAttribute(PageData::ATTRIBUTE_SEGMENT);
+
         const Segments &segments = editor_->segments();
 
         for (size_t i = 0; i < n; i++)
@@ -1018,6 +1109,8 @@ void Page::runColorModifier()
     }
     else if (opt.colorSource() == ViewSettings::ColorSource::SPECIES)
     {
+        readAttribute(PageData::ATTRIBUTE_SEGMENT);
+
         const Segments &segments = editor_->segments();
         const SpeciesList &species = editor_->speciesList();
 
@@ -1052,6 +1145,8 @@ void Page::runColorModifier()
     }
     else if (opt.colorSource() == ViewSettings::ColorSource::MANAGEMENT_STATUS)
     {
+        readAttribute(PageData::ATTRIBUTE_SEGMENT);
+
         const Segments &segments = editor_->segments();
         const ManagementStatusList &statList = editor_->managementStatusList();
 
@@ -1086,6 +1181,8 @@ void Page::runColorModifier()
     }
     else if (opt.colorSource() == ViewSettings::ColorSource::ELEVATION)
     {
+        readAttribute(PageData::ATTRIBUTE_ELEVATION);
+
         const Range<double> &e = editor_->elevationFilter();
         const Dataset &d = editor_->datasets().key(datasetId_);
         double a = static_cast<double>(d.range().elevationMin);
@@ -1112,6 +1209,8 @@ void Page::runColorModifier()
     }
     else if (opt.colorSource() == ViewSettings::ColorSource::DESCRIPTOR)
     {
+        readAttribute(PageData::ATTRIBUTE_DESCRIPTOR);
+
         for (size_t i = 0; i < n; i++)
         {
             setColor(i,
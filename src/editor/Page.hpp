@@ -22,8 +22,12 @@
 #ifndef PAGE_HPP
 #define PAGE_HPP
 
+// Include std.
+#include <array>
+
 // Include 3D Forest.
 #include <PageData.hpp>
+#include <QueryWhere.hpp>
 class Editor;
 class Query;
 
@@ -39,15 +43,17 @@ public:
     /**@{*/
     /** Point coordinates.
         The data are stored as [x0, y0, z0, x1, y1, ...].
-        These are actual X, Y, or Z coordinates after scaling and offset.
+        These are X, Y, or Z integer values from LAS point records.
+        Use x(), y() and z() to get actual coordinates with translation.
      */
-    double *position;
+    int32_t *position;
 
     /** Pulse return magnitude.
         The data are stored as [i0, i1, ...].
-        The values are in range from 0 (zero intensity) to 1 (full intensity).
+        The values are in range from 0 (zero intensity) to 65535 (full
+        intensity).
     */
-    double *intensity;
+    uint16_t *intensity;
 
     /** Return number.
         Contains values from 0 to 15.
@@ -70,11 +76,11 @@ public:
 
     /** Red, Green, and Blue image channels.
         The data are stored as [r0, g0, b0, r1, g1, ...].
-        Color values are in range from 0 (zero intensity) to 1 (full intensity).
-        When the input data set has no colors, then the colors in this vector
-        are set to full intensity.
+        Color values are in range from 0 (zero intensity) to 65535 (full
+        intensity). When the input data set has no colors, then the colors in
+        this vector are set to full intensity.
     */
-    double *color;
+    uint16_t *color;
     /**@}*/
 
     /** @name 3D Forest Attributes. */
@@ -82,25 +88,25 @@ public:
     /** Segment identification numbers.
         This value is stored in Point Data Record extra bytes.
     */
-    size_t *segment;
+    uint32_t *segment;
 
     /** Point elevation above ground.
         The data are stored as [e0, e1, ...].
         This value is stored in Point Data Record extra bytes.
      */
-    double *elevation;
+    float *elevation;
 
     /** Descriptor values.
         The data are stored as [d0, d1, ...].
         The values are in range from 0 (zero) to 1 (full).
         This value is stored in Point Data Record extra bytes.
     */
-    double *descriptor;
+    float *descriptor;
 
     /** Voxel values.
         This value is stored in Point Data Record extra bytes.
     */
-    size_t *voxel;
+    uint32_t *voxel;
     /**@}*/
 
     /** @name Rendering Data. */
@@ -127,10 +133,25 @@ public:
     uint32_t pageId() const { return pageId_; }
 
     void readPage();
+    void readSelection();
     void writePage();
 
     size_t size() const;
 
+    /** Read 3D Forest attribute if it is not in memory yet. */
+    void readAttribute(PageData::Attribute attribute);
+
+    const Vector3<double> &translation() const
+    {
+        return pageData_->translation;
+    }
+
+    const Box<double> &box() const { return pageData_->box; }
+
+    double x(size_t i) const { return pageData_->x(i); }
+    double y(size_t i) const { return pageData_->y(i); }
+    double z(size_t i) const { return pageData_->z(i); }
+
     void setModified();
     bool modified() const;
 
@@ -168,7 +189,17 @@ private:
     // Buffer.
     std::vector<IndexFile::Selection> selectedNodes_;
 
+    // Selection masks. Bit 'c' of a point is set when the point is rejected
+    // by attribute criterion 'c'. Masks of criteria which did not change
+    // since the last selection are reused. Region is selected by page index.
+    std::vector<uint8_t> selectionMask_;
+    // Masks are valid only for point data revision 'dataRevision_'. After
+    // point data change, small regions update masks only of their points.
+    std::array<uint64_t, QueryWhere::CRITERION_COUNT> selectionRevision_;
+    uint64_t dataRevision_;
+
     void resize(size_t n);
+    void updateAttributes();
 
     void transform();
 
@@ -177,13 +208,14 @@ private:
     void queryWhereCone();
     void queryWhereCylinder();
     void queryWhereSphere();
-    void queryWhereElevation();
-    void queryWhereDescriptor();
-    void queryWhereIntensity();
-    void queryWhereClassification();
-    void queryWhereSegment();
-    void queryWhereSpecies();
-    void queryWhereManagementStatus();
+    void queryWhereCriterion(QueryWhere::Criterion criterion,
+                             const uint32_t *rows,
+                             size_t n);
+    void queryWhereElevation(const uint32_t *rows, size_t n);
+    void queryWhereDescriptor(const uint32_t *rows, size_t n);
+    void queryWhereIntensity(const uint32_t *rows, size_t n);
+    void queryWhereClassification(const uint32_t *rows, size_t n);
+    void queryWhereSegment(const uint32_t *rows, size_t n);
 
     void runModifiers();
     void runColorModifier();
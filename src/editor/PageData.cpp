@@ -19,23 +19,44 @@
 
 /** @file PageData.cpp */
 
+// Include std.
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
 // Include 3D Forest.
 #include <Editor.hpp>
 #include <Endian.hpp>
+#include <Error.hpp>
 #include <File.hpp>
-#include <IndexFileBuilder.hpp>
 #include <LasFile.hpp>
 #include <PageData.hpp>
+#include <PageFile.hpp>
+#include <PageSummaryFile.hpp>
 
 // Include local.
 #define LOG_MODULE_NAME "PageData"
 // #define LOG_MODULE_DEBUG_ENABLED 1
 #include <Log.hpp>
 
+static const uint32_t pageDataAttributesAll = 0xfU;
+
+static std::atomic<uint64_t> pageDataStatisticsSegment(0);
+static std::atomic<uint64_t> pageDataStatisticsElevation(0);
+static std::atomic<uint64_t> pageDataStatisticsDescriptor(0);
+static std::atomic<uint64_t> pageDataStatisticsVoxel(0);
+
+static void pageDataStatisticsAdd(std::atomic<uint64_t> &counter)
+{
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+
 PageData::PageData(uint32_t datasetId, uint32_t pageId)
     : datasetId_(datasetId),
       pageId_(pageId),
-      modified_(false)
+      modified_(false),
+      revision_(0),
+      attributes_(0)
 {
     LOG_DEBUG(<< "Create page <" << pageId_ << "> dataset <" << datasetId_
               << ">.");
@@ -77,13 +98,7 @@ void PageData::resize(size_t n)
     gpsTime.resize(n);
     color.resize(n * 3);
 
-    segment.resize(n);
-    elevation.resize(n);
-    descriptor.resize(n);
-    voxel.resize(n);
-
     renderPosition.resize(n * 3);
-    positionBase_.resize(n * 3);
 }
 
 void PageData::readPage(Editor *editor)
@@ -95,27 +110,63 @@ void PageData::readPage(Editor *editor)
     const IndexFile::Node *node = dataset.index().at(pageId_);
     LasFile &las = dataset.las();
 
-    // Read page buffer from LAS file.
-    las.seekPoint(node->from);
+    // Pages may be read by page loader threads.
+    std::unique_lock<std::mutex> lockFiles(dataset.mutex());
+
+    // Read point data.
+    PageFile *pageFile = dataset.pageFile();
+    if (pageFile)
+    {
+        readPointsCompressed(las, *pageFile, node);
+    }
+    else
+    {
+        readPoints(las, node);
+    }
+
+    // Read page index.
+    octree.read(dataset.indexFile(), node->offset);
+    octree.translate(dataset.translation());
 
+    // Loaded.
+    modified_ = false;
+    revision_++;
+
+    // Apply transformation.
+    transform(editor);
+}
+
+void PageData::readPoints(LasFile &las, const IndexFile::Node *node)
+{
     size_t numberOfPointsInPage = static_cast<size_t>(node->size);
     size_t pointSize = las.header.point_data_record_length;
     size_t bufferLasPageSize = pointSize * numberOfPointsInPage;
     LOG_DEBUG(<< "Page has <" << numberOfPointsInPage << "> points in <"
               << bufferLasPageSize << "> bytes.");
-    // uint8_t fmt = las.header.point_data_record_format;
-    pointDataBuffer_.resize(bufferLasPageSize);
-    las.readBuffer(pointDataBuffer_.data(), bufferLasPageSize);
+
+    // Decode point data directly from mapped LAS file. Read page buffer
+    // from LAS file only when the file can not be mapped.
+    const uint8_t *ptrPointData = las.mapPoints(node->from, node->size);
+    if (ptrPointData)
+    {
+        pointDataBuffer_.clear();
+        pointDataBuffer_.shrink_to_fit();
+    }
+    else
+    {
+        las.seekPoint(node->from);
+        pointDataBuffer_.resize(bufferLasPageSize);
+        las.readBuffer(pointDataBuffer_.data(), bufferLasPageSize);
+        ptrPointData = pointDataBuffer_.data();
+    }
 
     // Create point data.
     resize(numberOfPointsInPage);
 
     // Covert buffer to point data.
-    uint8_t *ptrPointData = pointDataBuffer_.data();
 
     LasFile::Point point;
 
-    const double s16 = 1.0 / 65535.0;
     bool rgbFlag = las.header.hasRgb();
 
     for (size_t i = 0; i < numberOfPointsInPage; i++)
@@ -123,28 +174,24 @@ void PageData::readPage(Editor *editor)
         las.formatBytesToPoint(point, ptrPointData + (pointSize * i));
 
         // XYZ coordinates.
-        positionBase_[3 * i + 0] = static_cast<double>(point.x);
-        positionBase_[3 * i + 1] = static_cast<double>(point.y);
-        positionBase_[3 * i + 2] = static_cast<double>(point.z);
-
-        position[3 * i + 0] = positionBase_[3 * i + 0];
-        position[3 * i + 1] = positionBase_[3 * i + 1];
-        position[3 * i + 2] = positionBase_[3 * i + 2];
+        position[3 * i + 0] = point.x;
+        position[3 * i + 1] = point.y;
+        position[3 * i + 2] = point.z;
 
         // Intensity and color.
-        intensity[i] = static_cast<double>(point.intensity) * s16;
+        intensity[i] = point.intensity;
 
         if (rgbFlag)
         {
-            color[3 * i + 0] = point.red * s16;
-            color[3 * i + 1] = point.green * s16;
-            color[3 * i + 2] = point.blue * s16;
+            color[3 * i + 0] = point.red;
+            color[3 * i + 1] = point.green;
+            color[3 * i + 2] = point.blue;
         }
         else
         {
-            color[3 * i + 0] = 1.0;
-            color[3 * i + 1] = 1.0;
-            color[3 * i + 2] = 1.0;
+            color[3 * i + 0] = UINT16_MAX;
+            color[3 * i + 1] = UINT16_MAX;
+            color[3 * i + 2] = UINT16_MAX;
         }
 
         // Attributes.
@@ -157,26 +204,179 @@ void PageData::readPage(Editor *editor)
         gpsTime[i] = point.gps_time;
     }
 
+    // 3D Forest attributes are read on demand.
+    attributes_ = 0;
+}
+
+void PageData::readPointsCompressed(LasFile &las,
+                                    PageFile &pageFile,
+                                    const IndexFile::Node *node)
+{
+    // Read and decompress page columns.
+    std::vector<uint8_t> data;
+    uint64_t nPoints;
+    pageFile.read(pageId_, data, nPoints);
+
+    if (nPoints != node->size ||
+        data.size() != PageFile::columnsSize(las, nPoints))
+    {
+        THROW("Page " + std::to_string(pageId_) + " in dataset " +
+              std::to_string(datasetId_) + " does not match the index");
+    }
+
+    size_t n = static_cast<size_t>(nPoints);
+    LOG_DEBUG(<< "Page has <" << n << "> compressed points.");
+
+    // LAS point data are read only when the page is written.
+    pointDataBuffer_.clear();
+    pointDataBuffer_.shrink_to_fit();
+
+    // Create point data.
+    resize(n);
+
+    // Covert columns to point data.
+    const uint8_t *ptr = data.data();
+
+    for (size_t c = 0; c < 3; c++)
+    {
+        uint32_t value = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            value += ltoh32(ptr + (i * 4));
+            position[3 * i + c] = static_cast<int32_t>(value);
+        }
+        ptr += n * 4;
+    }
+
+    ltoh16(intensity.data(), ptr, n);
+    ptr += n * 2;
+
+    std::memcpy(returnNumber.data(), ptr, n);
+    ptr += n;
+    std::memcpy(numberOfReturns.data(), ptr, n);
+    ptr += n;
+    std::memcpy(classification.data(), ptr, n);
+    ptr += n;
+    std::memcpy(userData.data(), ptr, n);
+    ptr += n;
+
+    ltohd(gpsTime.data(), ptr, n);
+    ptr += n * 8;
+
+    if (las.header.hasRgb())
+    {
+        for (size_t c = 0; c < 3; c++)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                color[3 * i + c] = ltoh16(ptr + (i * 2));
+            }
+            ptr += n * 2;
+        }
+    }
+    else
+    {
+        std::fill(color.begin(), color.end(), UINT16_MAX);
+        ptr += n * 6;
+    }
+
     // 3D Forest attributes.
     LasFile::AttributesBuffer attributes;
-    las.createAttributesBuffer(attributes, numberOfPointsInPage);
-    las.readAttributesBuffer(attributes, numberOfPointsInPage);
+    las.createAttributesBuffer(attributes, n);
+    for (auto &buffer : attributes.attributes)
+    {
+        size_t nBytes = n * buffer.recordSize;
+        std::memcpy(buffer.data.data(), ptr, nBytes);
+        ptr += nBytes;
+    }
     attributes.attributes[0].read(segment);
     attributes.attributes[1].read(elevation);
     attributes.attributes[2].read(descriptor);
     attributes.attributes[3].read(voxel);
 
-    // Read page index.
-    std::string pathIndex;
-    pathIndex = IndexFileBuilder::extension(dataset.path());
-    octree.read(pathIndex, node->offset);
-    octree.translate(dataset.translation());
+    // All attributes are decompressed with the page.
+    attributes_ = pageDataAttributesAll;
+}
 
-    // Loaded.
-    modified_ = false;
+void PageData::readAttribute(Editor *editor, Attribute attribute)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
 
-    // Apply transformation.
-    transform(editor);
+    uint32_t mask = 1U << attribute;
+    if (attributes_ & mask)
+    {
+        return;
+    }
+
+    LOG_DEBUG(<< "Read attribute <" << attribute << "> page <" << pageId_
+              << "> dataset <" << datasetId_ << ">.");
+
+    Dataset &dataset = editor->datasets().key(datasetId_);
+    const IndexFile::Node *node = dataset.index().at(pageId_);
+    LasFile &las = dataset.las();
+
+    std::unique_lock<std::mutex> lockFiles(dataset.mutex());
+
+    size_t id = static_cast<size_t>(attribute);
+
+    switch (attribute)
+    {
+        case ATTRIBUTE_SEGMENT:
+            segment.resize(size());
+            las.readAttribute(id, segment, node->from, node->size);
+            pageDataStatisticsAdd(pageDataStatisticsSegment);
+            break;
+        case ATTRIBUTE_ELEVATION:
+            elevation.resize(size());
+            las.readAttribute(id, elevation, node->from, node->size);
+            pageDataStatisticsAdd(pageDataStatisticsElevation);
+            break;
+        case ATTRIBUTE_DESCRIPTOR:
+            descriptor.resize(size());
+            las.readAttribute(id, descriptor, node->from, node->size);
+            pageDataStatisticsAdd(pageDataStatisticsDescriptor);
+            break;
+        case ATTRIBUTE_VOXEL:
+        default:
+            voxel.resize(size());
+            las.readAttribute(id, voxel, node->from, node->size);
+            pageDataStatisticsAdd(pageDataStatisticsVoxel);
+            break;
+    }
+
+    attributes_ |= mask;
+    revision_++;
+}
+
+void PageData::setModified()
+{
+    modified_ = true;
+    revision_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool PageData::hasAttribute(Attribute attribute) const
+{
+    return (attributes_ & (1U << attribute)) != 0;
+}
+
+PageData::Statistics PageData::statistics()
+{
+    PageData::Statistics ret;
+    ret.nSegment = pageDataStatisticsSegment.load(std::memory_order_relaxed);
+    ret.nElevation =
+        pageDataStatisticsElevation.load(std::memory_order_relaxed);
+    ret.nDescriptor =
+        pageDataStatisticsDescriptor.load(std::memory_order_relaxed);
+    ret.nVoxel = pageDataStatisticsVoxel.load(std::memory_order_relaxed);
+    return ret;
+}
+
+void PageData::resetStatistics()
+{
+    pageDataStatisticsSegment.store(0, std::memory_order_relaxed);
+    pageDataStatisticsElevation.store(0, std::memory_order_relaxed);
+    pageDataStatisticsDescriptor.store(0, std::memory_order_relaxed);
+    pageDataStatisticsVoxel.store(0, std::memory_order_relaxed);
 }
 
 void PageData::updatePoint(uint8_t *ptr, size_t i, uint8_t fmt)
@@ -187,7 +387,7 @@ void PageData::updatePoint(uint8_t *ptr, size_t i, uint8_t fmt)
     // - etc.
 
     // Update intensity.
-    htol16(&ptr[12], static_cast<uint16_t>(intensity[i] * 65535.0));
+    htol16(&ptr[12], intensity[i]);
 
     // Update classification.
     if (fmt > 5)
@@ -214,6 +414,31 @@ void PageData::writePage(Editor *editor)
     uint8_t fmt = las.header.point_data_record_format;
 
     size_t numberOfPointsInPage = static_cast<size_t>(node->size);
+
+    // Compressed page contains all attributes. Unknown page summary is
+    // created from all attributes.
+    PageFile *pageFile = dataset.pageFile();
+    PageSummaryFile *summaryFile = dataset.summaryFile();
+    bool summaryEmpty = summaryFile && summaryFile->summary(pageId_).empty();
+    if (pageFile || summaryEmpty)
+    {
+        readAttribute(editor, ATTRIBUTE_SEGMENT);
+        readAttribute(editor, ATTRIBUTE_ELEVATION);
+        readAttribute(editor, ATTRIBUTE_DESCRIPTOR);
+        readAttribute(editor, ATTRIBUTE_VOXEL);
+    }
+
+    std::unique_lock<std::mutex> lockFiles(dataset.mutex());
+
+    // Read LAS point data when the page was decoded from mapped LAS file
+    // or from compressed pages.
+    if (pointDataBuffer_.size() != pointSize * numberOfPointsInPage)
+    {
+        pointDataBuffer_.resize(pointSize * numberOfPointsInPage);
+        las.seekPoint(node->from);
+        las.readBuffer(pointDataBuffer_.data(), pointDataBuffer_.size());
+    }
+
     uint8_t *ptrPointData = pointDataBuffer_.data();
 
     for (size_t i = 0; i < numberOfPointsInPage; i++)
@@ -224,14 +449,73 @@ void PageData::writePage(Editor *editor)
     las.seekPoint(node->from);
     las.writeBuffer(pointDataBuffer_.data(), pointDataBuffer_.size());
 
-    // Attributes.
+    // Attributes. Write only attributes which were read.
     LasFile::AttributesBuffer attributes;
     las.createAttributesBuffer(attributes, numberOfPointsInPage);
-    attributes.attributes[0].write(segment);
-    attributes.attributes[1].write(elevation);
-    attributes.attributes[2].write(descriptor);
-    attributes.attributes[3].write(voxel);
-    las.writeAttributesBuffer(attributes, numberOfPointsInPage);
+
+    if (hasAttribute(ATTRIBUTE_SEGMENT))
+    {
+        attributes.attributes[0].write(segment);
+        las.writeAttribute(0, attributes, numberOfPointsInPage);
+    }
+
+    if (hasAttribute(ATTRIBUTE_ELEVATION))
+    {
+        attributes.attributes[1].write(elevation);
+        las.writeAttribute(1, attributes, numberOfPointsInPage);
+    }
+
+    if (hasAttribute(ATTRIBUTE_DESCRIPTOR))
+    {
+        attributes.attributes[2].write(descriptor);
+        las.writeAttribute(2, attributes, numberOfPointsInPage);
+    }
+
+    if (hasAttribute(ATTRIBUTE_VOXEL))
+    {
+        attributes.attributes[3].write(voxel);
+        las.writeAttribute(3, attributes, numberOfPointsInPage);
+    }
+
+    // Update compressed page.
+    if (pageFile)
+    {
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> block;
+        PageFile::encode(data,
+                         las,
+                         pointDataBuffer_.data(),
+                         attributes,
+                         0,
+                         numberOfPointsInPage);
+        PageFile::compress(block, data, numberOfPointsInPage);
+        pageFile->write(pageId_, block);
+    }
+
+    // Update page summary. Attributes which were not read are unchanged.
+    if (summaryFile)
+    {
+        size_t n = numberOfPointsInPage;
+        PageSummary summary = summaryFile->summary(pageId_);
+        summary.setPoints(intensity.data(), classification.data(), n);
+
+        if (hasAttribute(ATTRIBUTE_SEGMENT))
+        {
+            summary.setSegment(segment.data(), n);
+        }
+
+        if (hasAttribute(ATTRIBUTE_ELEVATION))
+        {
+            summary.setElevation(elevation.data(), n);
+        }
+
+        if (hasAttribute(ATTRIBUTE_DESCRIPTOR))
+        {
+            summary.setDescriptor(descriptor.data(), n);
+        }
+
+        summaryFile->write(pageId_, summary);
+    }
 
     // Clear 'modified' flag.
     modified_ = false;
@@ -240,28 +524,22 @@ void PageData::writePage(Editor *editor)
 void PageData::transform(Editor *editor)
 {
     const Dataset &dataset = editor->datasets().key(datasetId_);
-    size_t n = positionBase_.size() / 3;
-    double x;
-    double y;
-    double z;
-    double tx = dataset.translation()[0];
-    double ty = dataset.translation()[1];
-    double tz = dataset.translation()[2];
+    size_t n = position.size() / 3;
+
+    translation = dataset.translation();
+
+    box.clear();
 
     for (size_t i = 0; i < n; i++)
     {
-        x = positionBase_[3 * i + 0] + tx;
-        y = positionBase_[3 * i + 1] + ty;
-        z = positionBase_[3 * i + 2] + tz;
+        double px = x(i);
+        double py = y(i);
+        double pz = z(i);
 
-        renderPosition[3 * i + 0] = static_cast<float>(x);
-        renderPosition[3 * i + 1] = static_cast<float>(y);
-        renderPosition[3 * i + 2] = static_cast<float>(z);
+        renderPosition[3 * i + 0] = static_cast<float>(px);
+        renderPosition[3 * i + 1] = static_cast<float>(py);
+        renderPosition[3 * i + 2] = static_cast<float>(pz);
 
-        position[3 * i + 0] = x;
-        position[3 * i + 1] = y;
-        position[3 * i + 2] = z;
+        box.extend(px, py, pz);
     }
-
-    box.set(position);
 }
@@ -22,9 +22,16 @@
 #ifndef PAGE_DATA_HPP
 #define PAGE_DATA_HPP
 
+// Include std.
+#include <atomic>
+#include <mutex>
+
 // Include 3D Forest.
 #include <IndexFile.hpp>
+#include <Vector3.hpp>
 class Editor;
+class LasFile;
+class PageFile;
 
 // Include local.
 #include <ExportEditor.hpp>
@@ -34,19 +41,42 @@ class Editor;
 class EXPORT_EDITOR PageData
 {
 public:
+    /** Page Data Attribute.
+        3D Forest attributes are empty until readAttribute() reads them.
+        The order matches attribute files in LAS file.
+    */
+    enum Attribute
+    {
+        ATTRIBUTE_SEGMENT,
+        ATTRIBUTE_ELEVATION,
+        ATTRIBUTE_DESCRIPTOR,
+        ATTRIBUTE_VOXEL
+    };
+
+    /** Page Data Statistics. Number of attribute columns read from files. */
+    struct EXPORT_EDITOR Statistics
+    {
+        uint64_t nSegment;
+        uint64_t nElevation;
+        uint64_t nDescriptor;
+        uint64_t nVoxel;
+    };
+
     /** @name Point Data */
     /**@{*/
     /** Point coordinates.
         The data are stored as [x0, y0, z0, x1, y1, ...].
-        These are actual X, Y, or Z coordinates after scaling and offset.
+        These are X, Y, or Z integer values from LAS point records.
+        Use x(), y() and z() to get actual coordinates with translation.
      */
-    std::vector<double> position;
+    std::vector<int32_t> position;
 
     /** Pulse return magnitude.
         The data are stored as [i0, i1, ...].
-        The values are in range from 0 (zero intensity) to 1 (full intensity).
+        The values are in range from 0 (zero intensity) to 65535 (full
+        intensity).
     */
-    std::vector<double> intensity;
+    std::vector<uint16_t> intensity;
 
     /** Return number.
         Contains values from 0 to 15.
@@ -69,11 +99,11 @@ public:
 
     /** Red, Green, and Blue image channels.
         The data are stored as [r0, g0, b0, r1, g1, ...].
-        Color values are in range from 0 (zero intensity) to 1 (full intensity).
-        When the input data set has no colors, then the colors in this vector
-        are set to full intensity.
+        Color values are in range from 0 (zero intensity) to 65535 (full
+        intensity). When the input data set has no colors, then the colors in
+        this vector are set to full intensity.
     */
-    std::vector<double> color;
+    std::vector<uint16_t> color;
     /**@}*/
 
     /** @name Point Data Extra Bytes */
@@ -81,25 +111,25 @@ public:
     /** Segment identification numbers.
         This value is stored in Point Data Record extra bytes.
     */
-    std::vector<size_t> segment;
+    std::vector<uint32_t> segment;
 
     /** Point elevation above ground.
         The data are stored as [e0, e1, ...].
         This value is stored in Point Data Record extra bytes.
      */
-    std::vector<double> elevation;
+    std::vector<float> elevation;
 
     /** Descriptor values.
         The data are stored as [d0, d1, ...].
         The values are in range from 0 (zero) to 1 (full).
         This value is stored in Point Data Record extra bytes.
     */
-    std::vector<double> descriptor;
+    std::vector<float> descriptor;
 
     /** Voxel values.
         This value is stored in Point Data Record extra bytes.
     */
-    std::vector<size_t> voxel;
+    std::vector<uint32_t> voxel;
     /**@}*/
 
     /** @name Rendering */
@@ -110,6 +140,9 @@ public:
     std::vector<float> renderPosition;
     /**@}*/
 
+    /** Translation of point coordinates. */
+    Vector3<double> translation;
+
     /** Bounding box. */
     Box<double> box;
 
@@ -125,15 +158,32 @@ public:
     void readPage(Editor *editor);
     void writePage(Editor *editor);
 
+    void readAttribute(Editor *editor, Attribute attribute);
+    bool hasAttribute(Attribute attribute) const;
+
     void transform(Editor *editor);
 
     size_t size() const { return intensity.size(); }
 
-    void setModified() { modified_ = true; }
+    double x(size_t i) const { return position[3 * i + 0] + translation[0]; }
+    double y(size_t i) const { return position[3 * i + 1] + translation[1]; }
+    double z(size_t i) const { return position[3 * i + 2] + translation[2]; }
+
+    void setModified();
     bool modified() const { return modified_; }
 
+    /** Revision of point data.
+        It is increased when the page is read, when an attribute is read and
+        when the page is modified. Page views use it to detect stale
+        selection masks.
+    */
+    uint64_t revision() const { return revision_; }
+
     static size_t sizeInMemory(uint64_t numberOfPoints);
 
+    static Statistics statistics();
+    static void resetStatistics();
+
 private:
     /** Dataset identifier. */
     uint32_t datasetId_;
@@ -141,16 +191,26 @@ private:
     /** Page identifier in a dataset. */
     uint32_t pageId_;
 
-    /** When true, this page should be written back to hard drive. */
-    bool modified_;
+    /** When true, this page should be written back to hard drive.
+        Pages may be modified by parallel query workers.
+    */
+    std::atomic<bool> modified_;
+
+    /** Revision of point data. */
+    std::atomic<uint64_t> revision_;
+
+    /** Bit mask of attributes which are read. */
+    std::atomic<uint32_t> attributes_;
+    std::mutex mutex_;
 
     /** File buffer to preserve untouched LAS data for updates. */
     std::vector<uint8_t> pointDataBuffer_;
 
-    /** Original xyz position of each point for translations. */
-    std::vector<double> positionBase_;
-
     void resize(size_t n);
+    void readPoints(LasFile &las, const IndexFile::Node *node);
+    void readPointsCompressed(LasFile &las,
+                              PageFile &pageFile,
+                              const IndexFile::Node *node);
     void updatePoint(uint8_t *ptr, size_t i, uint8_t fmt);
 };
 
@@ -0,0 +1,441 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PageFile.cpp */
+
+// Include std.
+#include <algorithm>
+#include <cstring>
+
+// Include 3D Forest.
+#include <Endian.hpp>
+#include <Error.hpp>
+#include <PageFile.hpp>
+
+// Include 3rd party.
+#include <lz4.h>
+
+// Include local.
+#define LOG_MODULE_NAME "PageFile"
+#include <Log.hpp>
+
+#define PAGE_FILE_SIGNATURE "3DFP"
+#define PAGE_FILE_MAJOR_VERSION 1
+#define PAGE_FILE_MINOR_VERSION 0
+#define PAGE_FILE_HEADER_SIZE 32
+#define PAGE_FILE_PAGE_SIZE 16
+#define PAGE_FILE_BLOCK_HEADER_SIZE 16
+
+PageFile::PageFile() : nPoints_(0)
+{
+}
+
+PageFile::~PageFile()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // Empty.
+    }
+}
+
+std::string PageFile::extension(const std::string &path)
+{
+    return File::replaceExtension(path, ".pages");
+}
+
+void PageFile::create(const std::string &path,
+                      uint64_t nPages,
+                      uint64_t nPoints)
+{
+    LOG_DEBUG(<< "Create page file <" << path << "> pages <" << nPages
+              << ">.");
+
+    file_.open(path, "w+");
+
+    nPoints_ = nPoints;
+    pages_.clear();
+    pages_.resize(nPages, {0, 0});
+    blocks_.clear();
+
+    // Header.
+    uint8_t header[PAGE_FILE_HEADER_SIZE];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, PAGE_FILE_SIGNATURE, 4);
+    header[4] = PAGE_FILE_MAJOR_VERSION;
+    header[5] = PAGE_FILE_MINOR_VERSION;
+    htol16(&header[6], PAGE_FILE_HEADER_SIZE);
+    htol64(&header[8], nPages);
+    htol64(&header[16], nPoints);
+    file_.write(header, sizeof(header));
+
+    // Empty page table.
+    std::vector<uint8_t> table;
+    table.resize(nPages * PAGE_FILE_PAGE_SIZE, 0);
+    file_.write(table.data(), table.size());
+}
+
+void PageFile::open(const std::string &path)
+{
+    LOG_DEBUG(<< "Open page file <" << path << ">.");
+
+    file_.open(path, "r+");
+
+    // A file which can not be read is closed without compaction, so that
+    // it is never modified.
+    try
+    {
+        readTable(path);
+    }
+    catch (...)
+    {
+        file_.close();
+        pages_.clear();
+        blocks_.clear();
+        nPoints_ = 0;
+        throw;
+    }
+}
+
+void PageFile::readTable(const std::string &path)
+{
+    // Header.
+    uint8_t header[PAGE_FILE_HEADER_SIZE];
+    if (file_.size() < sizeof(header))
+    {
+        THROW("Page file '" + path + "' is too small");
+    }
+
+    file_.read(header, sizeof(header));
+
+    if (std::memcmp(header, PAGE_FILE_SIGNATURE, 4) != 0 ||
+        header[4] != PAGE_FILE_MAJOR_VERSION ||
+        ltoh16(&header[6]) != PAGE_FILE_HEADER_SIZE)
+    {
+        THROW("Page file '" + path + "' has unknown format");
+    }
+
+    uint64_t nPages = ltoh64(&header[8]);
+    nPoints_ = ltoh64(&header[16]);
+
+    if (nPages > (file_.size() - sizeof(header)) / PAGE_FILE_PAGE_SIZE)
+    {
+        THROW("Page file '" + path + "' has truncated page table");
+    }
+
+    // Page table.
+    std::vector<uint8_t> table;
+    table.resize(nPages * PAGE_FILE_PAGE_SIZE);
+    file_.read(table.data(), table.size());
+
+    pages_.resize(nPages);
+    blocks_.clear();
+    uint64_t start = blocksOffset();
+    for (size_t i = 0; i < pages_.size(); i++)
+    {
+        pages_[i].offset = ltoh64(&table[i * PAGE_FILE_PAGE_SIZE]);
+        pages_[i].size = ltoh64(&table[i * PAGE_FILE_PAGE_SIZE + 8]);
+
+        if (pages_[i].size > 0)
+        {
+            if (pages_[i].offset < start ||
+                pages_[i].offset > file_.size() ||
+                pages_[i].size > file_.size() - pages_[i].offset ||
+                blocks_.count(pages_[i].offset) > 0)
+            {
+                THROW("Page file '" + path + "' has invalid page " +
+                      std::to_string(i));
+            }
+
+            blocks_[pages_[i].offset] = i;
+        }
+    }
+}
+
+void PageFile::close()
+{
+    if (file_.open())
+    {
+        compact();
+    }
+
+    file_.close();
+    pages_.clear();
+    blocks_.clear();
+    nPoints_ = 0;
+}
+
+uint64_t PageFile::blocksOffset() const
+{
+    return PAGE_FILE_HEADER_SIZE + (pages_.size() * PAGE_FILE_PAGE_SIZE);
+}
+
+uint64_t PageFile::unusedSize() const
+{
+    uint64_t used = 0;
+    for (const auto &it : blocks_)
+    {
+        used += pages_[it.second].size;
+    }
+
+    return file_.size() - blocksOffset() - used;
+}
+
+void PageFile::write(uint64_t page, const std::vector<uint8_t> &block)
+{
+    Page &p = pages_[page];
+
+    // The slot of a written page reaches to the next block. The last block
+    // can grow at the end of the file.
+    bool fits = false;
+    if (p.size > 0)
+    {
+        auto next = std::next(blocks_.find(p.offset));
+        fits = next == blocks_.end() || block.size() <= next->first - p.offset;
+    }
+
+    // Otherwise move the page to the end of the file. The old slot is
+    // joined to the slot of the preceding block.
+    if (!fits)
+    {
+        if (p.size > 0)
+        {
+            blocks_.erase(p.offset);
+        }
+
+        p.offset = std::max(file_.size(), blocksOffset());
+        blocks_[p.offset] = page;
+    }
+
+    p.size = block.size();
+
+    file_.seek(p.offset);
+    file_.write(block.data(), block.size());
+
+    writeEntry(page);
+}
+
+void PageFile::writeEntry(uint64_t page)
+{
+    const Page &p = pages_[page];
+
+    uint8_t entry[PAGE_FILE_PAGE_SIZE];
+    htol64(&entry[0], p.offset);
+    htol64(&entry[8], p.size);
+
+    file_.seek(PAGE_FILE_HEADER_SIZE + (page * PAGE_FILE_PAGE_SIZE));
+    file_.write(entry, sizeof(entry));
+}
+
+void PageFile::compact()
+{
+    uint64_t start = blocksOffset();
+    uint64_t unused = unusedSize();
+    if (unused == 0 || unused * 4 <= file_.size() - start)
+    {
+        return;
+    }
+
+    LOG_DEBUG(<< "Compact page file <" << file_.path() << "> unused <"
+              << unused << "> bytes.");
+
+    // Move blocks down in file order. A block is never moved over a block
+    // which was not moved yet.
+    std::map<uint64_t, uint64_t> blocks;
+    uint64_t offset = start;
+
+    for (const auto &it : blocks_)
+    {
+        Page &p = pages_[it.second];
+
+        if (p.offset != offset)
+        {
+            block_.resize(p.size);
+            file_.seek(p.offset);
+            file_.read(block_.data(), block_.size());
+
+            p.offset = offset;
+            file_.seek(p.offset);
+            file_.write(block_.data(), block_.size());
+
+            writeEntry(it.second);
+        }
+
+        blocks[p.offset] = it.second;
+        offset += p.size;
+    }
+
+    blocks_ = std::move(blocks);
+    file_.truncate(offset);
+}
+
+void PageFile::read(uint64_t page,
+                    std::vector<uint8_t> &data,
+                    uint64_t &nPoints)
+{
+    const Page &p = pages_[page];
+    if (p.size < PAGE_FILE_BLOCK_HEADER_SIZE)
+    {
+        THROW("Page file '" + file_.path() + "' has no page " +
+              std::to_string(page));
+    }
+
+    // Read compressed block.
+    block_.resize(p.size);
+    file_.seek(p.offset);
+    file_.read(block_.data(), block_.size());
+
+    nPoints = ltoh64(&block_[0]);
+    uint64_t dataSize = ltoh64(&block_[8]);
+
+    // Decompress.
+    data.resize(dataSize);
+    if (dataSize == 0)
+    {
+        return;
+    }
+
+    int n = LZ4_decompress_safe(
+        reinterpret_cast<const char *>(block_.data() +
+                                       PAGE_FILE_BLOCK_HEADER_SIZE),
+        reinterpret_cast<char *>(data.data()),
+        static_cast<int>(block_.size() - PAGE_FILE_BLOCK_HEADER_SIZE),
+        static_cast<int>(dataSize));
+
+    if (n < 0 || static_cast<uint64_t>(n) != dataSize)
+    {
+        THROW("Page file '" + file_.path() + "' has invalid page " +
+              std::to_string(page));
+    }
+}
+
+size_t PageFile::columnsSize(const LasFile &las, uint64_t nPoints)
+{
+    // x, y, z, intensity, return number, number of returns,
+    // classification, user data, GPS time, red, green, blue.
+    size_t pointSize = 32;
+
+    for (const auto &attributeFile : las.attributeFiles())
+    {
+        pointSize += attributeFile.recordSize();
+    }
+
+    return pointSize * static_cast<size_t>(nPoints);
+}
+
+void PageFile::encode(std::vector<uint8_t> &data,
+                      const LasFile &las,
+                      const uint8_t *points,
+                      const LasFile::AttributesBuffer &attributes,
+                      uint64_t from,
+                      uint64_t nPoints)
+{
+    size_t n = static_cast<size_t>(nPoints);
+    size_t pointSize = las.header.point_data_record_length;
+
+    data.resize(columnsSize(las, nPoints));
+
+    uint8_t *x = data.data();
+    uint8_t *y = x + (n * 4);
+    uint8_t *z = y + (n * 4);
+    uint8_t *intensity = z + (n * 4);
+    uint8_t *returnNumber = intensity + (n * 2);
+    uint8_t *numberOfReturns = returnNumber + n;
+    uint8_t *classification = numberOfReturns + n;
+    uint8_t *userData = classification + n;
+    uint8_t *gpsTime = userData + n;
+    uint8_t *red = gpsTime + (n * 8);
+    uint8_t *green = red + (n * 2);
+    uint8_t *blue = green + (n * 2);
+    uint8_t *attribute = blue + (n * 2);
+
+    // Point data. Coordinates are stored as differences to the previous
+    // point which compresses well because points are sorted by octree.
+    LasFile::Point point;
+    uint32_t px = 0;
+    uint32_t py = 0;
+    uint32_t pz = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        point.gps_time = 0;
+        point.red = 0;
+        point.green = 0;
+        point.blue = 0;
+        las.formatBytesToPoint(point, points + (i * pointSize));
+
+        uint32_t ux = static_cast<uint32_t>(point.x);
+        uint32_t uy = static_cast<uint32_t>(point.y);
+        uint32_t uz = static_cast<uint32_t>(point.z);
+        htol32(x + (i * 4), ux - px);
+        htol32(y + (i * 4), uy - py);
+        htol32(z + (i * 4), uz - pz);
+        px = ux;
+        py = uy;
+        pz = uz;
+
+        htol16(intensity + (i * 2), point.intensity);
+        returnNumber[i] = point.return_number;
+        numberOfReturns[i] = point.number_of_returns;
+        classification[i] = point.classification;
+        userData[i] = point.user_data;
+        htold(gpsTime + (i * 8), point.gps_time);
+        htol16(red + (i * 2), point.red);
+        htol16(green + (i * 2), point.green);
+        htol16(blue + (i * 2), point.blue);
+    }
+
+    // Attributes.
+    for (const auto &buffer : attributes.attributes)
+    {
+        size_t nBytes = n * buffer.recordSize;
+        std::memcpy(attribute,
+                    buffer.data.data() + (from * buffer.recordSize),
+                    nBytes);
+        attribute += nBytes;
+    }
+}
+
+void PageFile::compress(std::vector<uint8_t> &block,
+                        const std::vector<uint8_t> &data,
+                        uint64_t nPoints)
+{
+    int dataSize = static_cast<int>(data.size());
+    int bound = LZ4_compressBound(dataSize);
+
+    block.resize(PAGE_FILE_BLOCK_HEADER_SIZE + static_cast<size_t>(bound));
+    htol64(&block[0], nPoints);
+    htol64(&block[8], data.size());
+
+    int n = LZ4_compress_default(
+        reinterpret_cast<const char *>(data.data()),
+        reinterpret_cast<char *>(block.data() + PAGE_FILE_BLOCK_HEADER_SIZE),
+        dataSize,
+        bound);
+
+    if (n < 0 || (n == 0 && dataSize > 0))
+    {
+        THROW("Failed to compress page");
+    }
+
+    block.resize(PAGE_FILE_BLOCK_HEADER_SIZE + static_cast<size_t>(n));
+}
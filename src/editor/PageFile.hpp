@@ -0,0 +1,112 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PageFile.hpp */
+
+#ifndef PAGE_FILE_HPP
+#define PAGE_FILE_HPP
+
+// Include std.
+#include <map>
+#include <string>
+#include <vector>
+
+// Include 3D Forest.
+#include <File.hpp>
+#include <LasFile.hpp>
+
+// Include local.
+#include <ExportEditor.hpp>
+#include <WarningsDisable.hpp>
+
+/** Page File.
+
+    Optional compressed copy of point data of an indexed dataset. Each page
+    of the main index is stored as one LZ4 block. The block contains point
+    values by columns: x, y, z as int32 deltas, intensity u16, return
+    number u8, number of returns u8, classification u8, user data u8, GPS
+    time f64, red, green and blue u16 and raw records of each attribute.
+
+    An updated page is written in place when it fits into its slot. The
+    slot of a page reaches to the next block in the file, so free space
+    left by moved pages is reused by the preceding page. A page which does
+    not fit is moved to the end of the file. Unused space is removed by
+    compaction when the file is closed with more than a quarter of its
+    blocks area unused.
+*/
+class EXPORT_EDITOR PageFile
+{
+public:
+    PageFile();
+    ~PageFile();
+
+    static std::string extension(const std::string &path);
+
+    void create(const std::string &path, uint64_t nPages, uint64_t nPoints);
+    void open(const std::string &path);
+    void close();
+    bool open() const { return file_.open(); }
+
+    uint64_t numberOfPages() const { return pages_.size(); }
+    uint64_t numberOfPoints() const { return nPoints_; }
+
+    /** Size of blocks area which is not used by any page. */
+    uint64_t unusedSize() const;
+
+    void write(uint64_t page, const std::vector<uint8_t> &block);
+    void read(uint64_t page, std::vector<uint8_t> &data, uint64_t &nPoints);
+
+    static void encode(std::vector<uint8_t> &data,
+                       const LasFile &las,
+                       const uint8_t *points,
+                       const LasFile::AttributesBuffer &attributes,
+                       uint64_t from,
+                       uint64_t nPoints);
+
+    static void compress(std::vector<uint8_t> &block,
+                         const std::vector<uint8_t> &data,
+                         uint64_t nPoints);
+
+    static size_t columnsSize(const LasFile &las, uint64_t nPoints);
+
+protected:
+    /** Page File Page. */
+    struct Page
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    File file_;
+    uint64_t nPoints_;
+    std::vector<Page> pages_;
+    std::vector<uint8_t> block_;
+
+    // Written pages ordered by block offset.
+    std::map<uint64_t, uint64_t> blocks_;
+
+    uint64_t blocksOffset() const;
+    void readTable(const std::string &path);
+    void writeEntry(uint64_t page);
+    void compact();
+};
+
+#include <WarningsEnable.hpp>
+
+#endif /* PAGE_FILE_HPP */
@@ -0,0 +1,685 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PageFilter.cpp */
+
+// Include std.
+#include <cmath>
+
+// Include 3D Forest.
+#include <PageFilter.hpp>
+#include <Util.hpp>
+
+// Include 3rd party.
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define PAGE_FILTER_AVX2 1
+    #define PAGE_FILTER_N 4
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define PAGE_FILTER_SSE2 1
+    #define PAGE_FILTER_N 2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define PAGE_FILTER_NEON 1
+    #define PAGE_FILTER_N 2
+#endif
+
+// Include local.
+#define LOG_MODULE_NAME "PageFilter"
+#include <Log.hpp>
+
+#define PAGE_FILTER_RAD_TO_DEG 57.29578
+
+#if defined(PAGE_FILTER_AVX2)
+typedef __m256d PageFilterVec;
+typedef __m256d PageFilterMask;
+
+static inline PageFilterVec pageFilterSet(double a)
+{
+    return _mm256_set1_pd(a);
+}
+
+static inline PageFilterVec pageFilterAdd(PageFilterVec a, PageFilterVec b)
+{
+    return _mm256_add_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterSub(PageFilterVec a, PageFilterVec b)
+{
+    return _mm256_sub_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterMul(PageFilterVec a, PageFilterVec b)
+{
+    return _mm256_mul_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterDiv(PageFilterVec a, PageFilterVec b)
+{
+    return _mm256_div_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterMin(PageFilterVec a, PageFilterVec b)
+{
+    return _mm256_min_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterMax(PageFilterVec a, PageFilterVec b)
+{
+    return _mm256_max_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterSqrt(PageFilterVec a)
+{
+    return _mm256_sqrt_pd(a);
+}
+
+static inline PageFilterVec pageFilterAbs(PageFilterVec a)
+{
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);
+}
+
+static inline PageFilterMask pageFilterLe(PageFilterVec a, PageFilterVec b)
+{
+    return _mm256_cmp_pd(a, b, _CMP_LE_OQ);
+}
+
+static inline PageFilterMask pageFilterLt(PageFilterVec a, PageFilterVec b)
+{
+    return _mm256_cmp_pd(a, b, _CMP_LT_OQ);
+}
+
+static inline PageFilterMask pageFilterAnd(PageFilterMask a, PageFilterMask b)
+{
+    return _mm256_and_pd(a, b);
+}
+
+static inline unsigned int pageFilterBits(PageFilterMask a)
+{
+    return static_cast<unsigned int>(_mm256_movemask_pd(a));
+}
+
+static inline void pageFilterLoad(PageFilterVec &x,
+                                  PageFilterVec &y,
+                                  PageFilterVec &z,
+                                  const int32_t *p)
+{
+    const __m128i idx = _mm_setr_epi32(0, 3, 6, 9);
+    x = _mm256_cvtepi32_pd(_mm_i32gather_epi32(p, idx, 4));
+    y = _mm256_cvtepi32_pd(_mm_i32gather_epi32(p + 1, idx, 4));
+    z = _mm256_cvtepi32_pd(_mm_i32gather_epi32(p + 2, idx, 4));
+}
+#endif /* PAGE_FILTER_AVX2 */
+
+#if defined(PAGE_FILTER_SSE2)
+typedef __m128d PageFilterVec;
+typedef __m128d PageFilterMask;
+
+static inline PageFilterVec pageFilterSet(double a)
+{
+    return _mm_set1_pd(a);
+}
+
+static inline PageFilterVec pageFilterAdd(PageFilterVec a, PageFilterVec b)
+{
+    return _mm_add_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterSub(PageFilterVec a, PageFilterVec b)
+{
+    return _mm_sub_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterMul(PageFilterVec a, PageFilterVec b)
+{
+    return _mm_mul_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterDiv(PageFilterVec a, PageFilterVec b)
+{
+    return _mm_div_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterMin(PageFilterVec a, PageFilterVec b)
+{
+    return _mm_min_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterMax(PageFilterVec a, PageFilterVec b)
+{
+    return _mm_max_pd(a, b);
+}
+
+static inline PageFilterVec pageFilterSqrt(PageFilterVec a)
+{
+    return _mm_sqrt_pd(a);
+}
+
+static inline PageFilterVec pageFilterAbs(PageFilterVec a)
+{
+    return _mm_andnot_pd(_mm_set1_pd(-0.0), a);
+}
+
+static inline PageFilterMask pageFilterLe(PageFilterVec a, PageFilterVec b)
+{
+    return _mm_cmple_pd(a, b);
+}
+
+static inline PageFilterMask pageFilterLt(PageFilterVec a, PageFilterVec b)
+{
+    return _mm_cmplt_pd(a, b);
+}
+
+static inline PageFilterMask pageFilterAnd(PageFilterMask a, PageFilterMask b)
+{
+    return _mm_and_pd(a, b);
+}
+
+static inline unsigned int pageFilterBits(PageFilterMask a)
+{
+    return static_cast<unsigned int>(_mm_movemask_pd(a));
+}
+
+static inline void pageFilterLoad(PageFilterVec &x,
+                                  PageFilterVec &y,
+                                  PageFilterVec &z,
+                                  const int32_t *p)
+{
+    x = _mm_cvtepi32_pd(_mm_setr_epi32(p[0], p[3], 0, 0));
+    y = _mm_cvtepi32_pd(_mm_setr_epi32(p[1], p[4], 0, 0));
+    z = _mm_cvtepi32_pd(_mm_setr_epi32(p[2], p[5], 0, 0));
+}
+#endif /* PAGE_FILTER_SSE2 */
+
+#if defined(PAGE_FILTER_NEON)
+typedef float64x2_t PageFilterVec;
+typedef uint64x2_t PageFilterMask;
+
+static inline PageFilterVec pageFilterSet(double a)
+{
+    return vdupq_n_f64(a);
+}
+
+static inline PageFilterVec pageFilterAdd(PageFilterVec a, PageFilterVec b)
+{
+    return vaddq_f64(a, b);
+}
+
+static inline PageFilterVec pageFilterSub(PageFilterVec a, PageFilterVec b)
+{
+    return vsubq_f64(a, b);
+}
+
+static inline PageFilterVec pageFilterMul(PageFilterVec a, PageFilterVec b)
+{
+    return vmulq_f64(a, b);
+}
+
+static inline PageFilterVec pageFilterDiv(PageFilterVec a, PageFilterVec b)
+{
+    return vdivq_f64(a, b);
+}
+
+static inline PageFilterVec pageFilterMin(PageFilterVec a, PageFilterVec b)
+{
+    return vminq_f64(a, b);
+}
+
+static inline PageFilterVec pageFilterMax(PageFilterVec a, PageFilterVec b)
+{
+    return vmaxq_f64(a, b);
+}
+
+static inline PageFilterVec pageFilterSqrt(PageFilterVec a)
+{
+    return vsqrtq_f64(a);
+}
+
+static inline PageFilterVec pageFilterAbs(PageFilterVec a)
+{
+    return vabsq_f64(a);
+}
+
+static inline PageFilterMask pageFilterLe(PageFilterVec a, PageFilterVec b)
+{
+    return vcleq_f64(a, b);
+}
+
+static inline PageFilterMask pageFilterLt(PageFilterVec a, PageFilterVec b)
+{
+    return vcltq_f64(a, b);
+}
+
+static inline PageFilterMask pageFilterAnd(PageFilterMask a, PageFilterMask b)
+{
+    return vandq_u64(a, b);
+}
+
+static inline unsigned int pageFilterBits(PageFilterMask a)
+{
+    return static_cast<unsigned int>((vgetq_lane_u64(a, 0) & 1U) |
+                                     ((vgetq_lane_u64(a, 1) & 1U) << 1));
+}
+
+static inline void pageFilterLoad(PageFilterVec &x,
+                                  PageFilterVec &y,
+                                  PageFilterVec &z,
+                                  const int32_t *p)
+{
+    int32x2x3_t v = vld3_s32(p);
+    x = vcvtq_f64_s64(vmovl_s32(v.val[0]));
+    y = vcvtq_f64_s64(vmovl_s32(v.val[1]));
+    z = vcvtq_f64_s64(vmovl_s32(v.val[2]));
+}
+#endif /* PAGE_FILTER_NEON */
+
+#if defined(PAGE_FILTER_N)
+static inline size_t pageFilterAppend(uint32_t *selection,
+                                      size_t nSelected,
+                                      unsigned int bits,
+                                      size_t index)
+{
+    for (size_t k = 0; k < PAGE_FILTER_N; k++)
+    {
+        selection[nSelected] = static_cast<uint32_t>(index + k);
+        nSelected += (bits >> k) & 1U;
+    }
+
+    return nSelected;
+}
+
+static inline PageFilterMask pageFilterBox(const PageFilterVec &x,
+                                           const PageFilterVec &y,
+                                           const PageFilterVec &z,
+                                           const PageFilterVec *min,
+                                           const PageFilterVec *max)
+{
+    PageFilterMask m;
+    m = pageFilterAnd(pageFilterLe(min[0], x), pageFilterLe(x, max[0]));
+    m = pageFilterAnd(m, pageFilterLe(min[1], y));
+    m = pageFilterAnd(m, pageFilterLe(y, max[1]));
+    m = pageFilterAnd(m, pageFilterLe(min[2], z));
+    m = pageFilterAnd(m, pageFilterLe(z, max[2]));
+    return m;
+}
+
+static inline void pageFilterBoxSet(PageFilterVec *min,
+                                    PageFilterVec *max,
+                                    const Box<double> &box)
+{
+    for (size_t k = 0; k < 3; k++)
+    {
+        min[k] = pageFilterSet(box.min(k));
+        max[k] = pageFilterSet(box.max(k));
+    }
+}
+#endif /* PAGE_FILTER_N */
+
+size_t PageFilter::box(uint32_t *selection,
+                       const int32_t *position,
+                       size_t from,
+                       size_t n,
+                       const Vector3<double> &translation,
+                       const Box<double> &box,
+                       bool vectorized)
+{
+    size_t nSelected = 0;
+    size_t i = from;
+    size_t end = from + n;
+
+#if defined(PAGE_FILTER_N)
+    if (vectorized)
+    {
+        const PageFilterVec tx = pageFilterSet(translation[0]);
+        const PageFilterVec ty = pageFilterSet(translation[1]);
+        const PageFilterVec tz = pageFilterSet(translation[2]);
+
+        PageFilterVec min[3];
+        PageFilterVec max[3];
+        pageFilterBoxSet(min, max, box);
+
+        for (; i + PAGE_FILTER_N <= end; i += PAGE_FILTER_N)
+        {
+            PageFilterVec x;
+            PageFilterVec y;
+            PageFilterVec z;
+            pageFilterLoad(x, y, z, position + (3 * i));
+            x = pageFilterAdd(x, tx);
+            y = pageFilterAdd(y, ty);
+            z = pageFilterAdd(z, tz);
+
+            PageFilterMask m = pageFilterBox(x, y, z, min, max);
+
+            nSelected =
+                pageFilterAppend(selection, nSelected, pageFilterBits(m), i);
+        }
+    }
+#else
+    (void)vectorized;
+#endif /* PAGE_FILTER_N */
+
+    for (; i < end; i++)
+    {
+        const int32_t *p = position + (3 * i);
+        double x = p[0] + translation[0];
+        double y = p[1] + translation[1];
+        double z = p[2] + translation[2];
+
+        if (box.contains(x, y, z))
+        {
+            selection[nSelected++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    return nSelected;
+}
+
+size_t PageFilter::sphere(uint32_t *selection,
+                          const int32_t *position,
+                          size_t from,
+                          size_t n,
+                          const Vector3<double> &translation,
+                          const Sphere<double> &sphere,
+                          bool vectorized)
+{
+    size_t nSelected = 0;
+    size_t i = from;
+    size_t end = from + n;
+
+#if defined(PAGE_FILTER_N)
+    if (vectorized)
+    {
+        const PageFilterVec tx = pageFilterSet(translation[0]);
+        const PageFilterVec ty = pageFilterSet(translation[1]);
+        const PageFilterVec tz = pageFilterSet(translation[2]);
+
+        PageFilterVec min[3];
+        PageFilterVec max[3];
+        pageFilterBoxSet(min, max, sphere.box());
+
+        const PageFilterVec cx = pageFilterSet(sphere.x());
+        const PageFilterVec cy = pageFilterSet(sphere.y());
+        const PageFilterVec cz = pageFilterSet(sphere.z());
+        const PageFilterVec r = pageFilterSet(sphere.radius());
+
+        for (; i + PAGE_FILTER_N <= end; i += PAGE_FILTER_N)
+        {
+            PageFilterVec x;
+            PageFilterVec y;
+            PageFilterVec z;
+            pageFilterLoad(x, y, z, position + (3 * i));
+            x = pageFilterAdd(x, tx);
+            y = pageFilterAdd(y, ty);
+            z = pageFilterAdd(z, tz);
+
+            PageFilterMask m = pageFilterBox(x, y, z, min, max);
+
+            PageFilterVec dx = pageFilterSub(cx, x);
+            PageFilterVec dy = pageFilterSub(cy, y);
+            PageFilterVec dz = pageFilterSub(cz, z);
+            PageFilterVec d = pageFilterAdd(
+                pageFilterAdd(pageFilterMul(dx, dx), pageFilterMul(dy, dy)),
+                pageFilterMul(dz, dz));
+            d = pageFilterSqrt(d);
+            m = pageFilterAnd(m, pageFilterLe(d, r));
+
+            nSelected =
+                pageFilterAppend(selection, nSelected, pageFilterBits(m), i);
+        }
+    }
+#else
+    (void)vectorized;
+#endif /* PAGE_FILTER_N */
+
+    for (; i < end; i++)
+    {
+        const int32_t *p = position + (3 * i);
+        double x = p[0] + translation[0];
+        double y = p[1] + translation[1];
+        double z = p[2] + translation[2];
+
+        if (sphere.contains(x, y, z))
+        {
+            selection[nSelected++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    return nSelected;
+}
+
+size_t PageFilter::cylinder(uint32_t *selection,
+                            const int32_t *position,
+                            size_t from,
+                            size_t n,
+                            const Vector3<double> &translation,
+                            const Cylinder<double> &cylinder,
+                            bool vectorized)
+{
+    size_t nSelected = 0;
+    size_t i = from;
+    size_t end = from + n;
+
+#if defined(PAGE_FILTER_N)
+    if (vectorized)
+    {
+        const PageFilterVec tx = pageFilterSet(translation[0]);
+        const PageFilterVec ty = pageFilterSet(translation[1]);
+        const PageFilterVec tz = pageFilterSet(translation[2]);
+
+        PageFilterVec min[3];
+        PageFilterVec max[3];
+        pageFilterBoxSet(min, max, cylinder.box());
+
+        // Terms of Cylinder::contains() which do not depend on the point.
+        const Vector3<double> &a = cylinder.a();
+        const Vector3<double> &nv = cylinder.n();
+        double an = (a[0] * nv[0]) + (a[1] * nv[1]) + (a[2] * nv[2]);
+        double abx = nv[0] - a[0];
+        double aby = nv[1] - a[1];
+        double abz = nv[2] - a[2];
+        double abab = abx * abx + aby * aby + abz * abz;
+        bool segment = !zero(abab);
+
+        const PageFilterVec vnx = pageFilterSet(nv[0]);
+        const PageFilterVec vny = pageFilterSet(nv[1]);
+        const PageFilterVec vnz = pageFilterSet(nv[2]);
+        const PageFilterVec van = pageFilterSet(an);
+        const PageFilterVec vax = pageFilterSet(a[0]);
+        const PageFilterVec vay = pageFilterSet(a[1]);
+        const PageFilterVec vaz = pageFilterSet(a[2]);
+        const PageFilterVec vabx = pageFilterSet(abx);
+        const PageFilterVec vaby = pageFilterSet(aby);
+        const PageFilterVec vabz = pageFilterSet(abz);
+        const PageFilterVec vabab = pageFilterSet(abab);
+        const PageFilterVec zero = pageFilterSet(0.0);
+        const PageFilterVec one = pageFilterSet(1.0);
+        const PageFilterVec length = pageFilterSet(cylinder.length());
+        const PageFilterVec radius = pageFilterSet(cylinder.radius());
+
+        for (; i + PAGE_FILTER_N <= end; i += PAGE_FILTER_N)
+        {
+            PageFilterVec x;
+            PageFilterVec y;
+            PageFilterVec z;
+            pageFilterLoad(x, y, z, position + (3 * i));
+            x = pageFilterAdd(x, tx);
+            y = pageFilterAdd(y, ty);
+            z = pageFilterAdd(z, tz);
+
+            PageFilterMask m = pageFilterBox(x, y, z, min, max);
+
+            // Distance from the base plane.
+            PageFilterVec dp = pageFilterAdd(
+                pageFilterAdd(pageFilterMul(x, vnx), pageFilterMul(y, vny)),
+                pageFilterMul(z, vnz));
+            dp = pageFilterSub(dp, van);
+            m = pageFilterAnd(m, pageFilterLe(zero, dp));
+            m = pageFilterAnd(m, pageFilterLe(dp, length));
+
+            // Distance from the axis.
+            PageFilterVec apx = pageFilterSub(x, vax);
+            PageFilterVec apy = pageFilterSub(y, vay);
+            PageFilterVec apz = pageFilterSub(z, vaz);
+            PageFilterVec dx = apx;
+            PageFilterVec dy = apy;
+            PageFilterVec dz = apz;
+
+            if (segment)
+            {
+                PageFilterVec abap = pageFilterAdd(
+                    pageFilterAdd(pageFilterMul(vabx, apx),
+                                  pageFilterMul(vaby, apy)),
+                    pageFilterMul(vabz, apz));
+                PageFilterVec t = pageFilterDiv(abap, vabab);
+                t = pageFilterMax(pageFilterMin(t, one), zero);
+
+                dx = pageFilterMul(vabx, t);
+                dy = pageFilterMul(vaby, t);
+                dz = pageFilterMul(vabz, t);
+                dx = pageFilterSub(x, pageFilterAdd(vax, dx));
+                dy = pageFilterSub(y, pageFilterAdd(vay, dy));
+                dz = pageFilterSub(z, pageFilterAdd(vaz, dz));
+            }
+
+            PageFilterVec dl = pageFilterAdd(
+                pageFilterAdd(pageFilterMul(dx, dx), pageFilterMul(dy, dy)),
+                pageFilterMul(dz, dz));
+            dl = pageFilterSqrt(dl);
+            m = pageFilterAnd(m, pageFilterLe(dl, radius));
+
+            nSelected =
+                pageFilterAppend(selection, nSelected, pageFilterBits(m), i);
+        }
+    }
+#else
+    (void)vectorized;
+#endif /* PAGE_FILTER_N */
+
+    for (; i < end; i++)
+    {
+        const int32_t *p = position + (3 * i);
+        double x = p[0] + translation[0];
+        double y = p[1] + translation[1];
+        double z = p[2] + translation[2];
+
+        if (cylinder.contains(x, y, z))
+        {
+            selection[nSelected++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    return nSelected;
+}
+
+size_t PageFilter::cone(uint32_t *selection,
+                        const int32_t *position,
+                        size_t from,
+                        size_t n,
+                        const Vector3<double> &translation,
+                        const Cone<double> &cone,
+                        bool vectorized)
+{
+    size_t nSelected = 0;
+    size_t i = from;
+    size_t end = from + n;
+
+#if defined(PAGE_FILTER_N)
+    if (vectorized)
+    {
+        const PageFilterVec tx = pageFilterSet(translation[0]);
+        const PageFilterVec ty = pageFilterSet(translation[1]);
+        const PageFilterVec tz = pageFilterSet(translation[2]);
+
+        PageFilterVec min[3];
+        PageFilterVec max[3];
+        pageFilterBoxSet(min, max, cone.box());
+
+        const PageFilterVec cx = pageFilterSet(cone.x());
+        const PageFilterVec cy = pageFilterSet(cone.y());
+        const PageFilterVec cz = pageFilterSet(cone.z());
+        const PageFilterVec angle = pageFilterSet(cone.angle());
+        const PageFilterVec atanA = pageFilterSet(MATH_ATAN_A);
+        const PageFilterVec atanB = pageFilterSet(MATH_ATAN_B);
+        const PageFilterVec atanC = pageFilterSet(MATH_ATAN_C);
+        const PageFilterVec deg = pageFilterSet(PAGE_FILTER_RAD_TO_DEG);
+
+        for (; i + PAGE_FILTER_N <= end; i += PAGE_FILTER_N)
+        {
+            PageFilterVec x;
+            PageFilterVec y;
+            PageFilterVec z;
+            pageFilterLoad(x, y, z, position + (3 * i));
+            x = pageFilterAdd(x, tx);
+            y = pageFilterAdd(y, ty);
+            z = pageFilterAdd(z, tz);
+
+            PageFilterMask m = pageFilterBox(x, y, z, min, max);
+
+            PageFilterVec dx = pageFilterSub(cx, x);
+            PageFilterVec dy = pageFilterSub(cy, y);
+            PageFilterVec d =
+                pageFilterAdd(pageFilterMul(dx, dx), pageFilterMul(dy, dy));
+            d = pageFilterSqrt(d);
+
+            // Same polynomial as fastatan().
+            PageFilterVec dz = pageFilterAbs(pageFilterSub(cz, z));
+            PageFilterVec q = pageFilterDiv(d, dz);
+            PageFilterVec q2 = pageFilterMul(q, q);
+            PageFilterVec a = pageFilterAdd(pageFilterMul(atanA, q2), atanB);
+            a = pageFilterMul(pageFilterAdd(pageFilterMul(a, q2), atanC), q);
+            a = pageFilterMul(a, deg);
+            m = pageFilterAnd(m, pageFilterLt(a, angle));
+
+            nSelected =
+                pageFilterAppend(selection, nSelected, pageFilterBits(m), i);
+        }
+    }
+#else
+    (void)vectorized;
+#endif /* PAGE_FILTER_N */
+
+    for (; i < end; i++)
+    {
+        const int32_t *p = position + (3 * i);
+        double x = p[0] + translation[0];
+        double y = p[1] + translation[1];
+        double z = p[2] + translation[2];
+
+        if (cone.contains(x, y, z))
+        {
+            selection[nSelected++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    return nSelected;
+}
+
+const char *PageFilter::instructionSet()
+{
+#if defined(PAGE_FILTER_AVX2)
+    return "AVX2";
+#elif defined(PAGE_FILTER_SSE2)
+    return "SSE2";
+#elif defined(PAGE_FILTER_NEON)
+    return "NEON";
+#else
+    return "none";
+#endif
+}
@@ -0,0 +1,93 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PageFilter.hpp */
+
+#ifndef PAGE_FILTER_HPP
+#define PAGE_FILTER_HPP
+
+// Include std.
+#include <cstddef>
+#include <cstdint>
+
+// Include 3D Forest.
+#include <Box.hpp>
+#include <Cone.hpp>
+#include <Cylinder.hpp>
+#include <Sphere.hpp>
+#include <Vector3.hpp>
+
+// Include local.
+#include <ExportEditor.hpp>
+#include <WarningsDisable.hpp>
+
+/** Page Filter.
+
+    Region tests over a contiguous block of page points. Page coordinates
+    are LAS integer values stored as [x0, y0, z0, x1, ...] and they are
+    moved by 'translation' before the test. Points from 'from' to
+    'from + n' are tested. Indices of points inside the region are written
+    to 'selection', which must have room for 'n' values. Each filter
+    returns the number of selected points.
+
+    Vectorized filters use AVX2, SSE2 or NEON when the compiler targets
+    them and give the same results as the scalar filters.
+*/
+class EXPORT_EDITOR PageFilter
+{
+public:
+    static size_t box(uint32_t *selection,
+                      const int32_t *position,
+                      size_t from,
+                      size_t n,
+                      const Vector3<double> &translation,
+                      const Box<double> &box,
+                      bool vectorized = true);
+
+    static size_t sphere(uint32_t *selection,
+                         const int32_t *position,
+                         size_t from,
+                         size_t n,
+                         const Vector3<double> &translation,
+                         const Sphere<double> &sphere,
+                         bool vectorized = true);
+
+    static size_t cylinder(uint32_t *selection,
+                           const int32_t *position,
+                           size_t from,
+                           size_t n,
+                           const Vector3<double> &translation,
+                           const Cylinder<double> &cylinder,
+                           bool vectorized = true);
+
+    static size_t cone(uint32_t *selection,
+                       const int32_t *position,
+                       size_t from,
+                       size_t n,
+                       const Vector3<double> &translation,
+                       const Cone<double> &cone,
+                       bool vectorized = true);
+
+    /** Name of instruction set used by vectorized filters. */
+    static const char *instructionSet();
+};
+
+#include <WarningsEnable.hpp>
+
+#endif /* PAGE_FILTER_HPP */
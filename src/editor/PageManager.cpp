@@ -19,6 +19,10 @@
 
 /** @file PageManager.cpp */
 
+// Include std.
+#include <algorithm>
+#include <exception>
+
 // Include 3D Forest.
 #include <Editor.hpp>
 #include <PageManager.hpp>
@@ -29,6 +33,14 @@
 #include <Log.hpp>
 
 PageManager::PageManager()
+    : cacheSizeMaximum_(0),
+      cacheSizeInMemory_(0),
+      nEvictions_(0),
+      nWrites_(0),
+      numberOfThreads_(1),
+      maximumPrefetch_(16),
+      exit_(false),
+      editor_(nullptr)
 {
     LOG_DEBUG(<< "Create.");
 }
@@ -36,6 +48,7 @@ PageManager::PageManager()
 PageManager::~PageManager()
 {
     LOG_DEBUG(<< "Destroy.");
+    stopThreads();
 }
 
 bool PageManager::Key::operator<(const Key &rhs) const
@@ -48,6 +61,25 @@ bool PageManager::Key::operator<(const Key &rhs) const
     return pageId < rhs.pageId;
 }
 
+bool PageManager::Key::operator==(const Key &rhs) const
+{
+    return datasetId == rhs.datasetId && pageId == rhs.pageId;
+}
+
+bool PageManager::contains(const std::deque<Key> &list, const Key &key)
+{
+    return std::find(list.begin(), list.end(), key) != list.end();
+}
+
+void PageManager::erase(std::deque<Key> &list, const Key &key)
+{
+    auto it = std::find(list.begin(), list.end(), key);
+    if (it != list.end())
+    {
+        list.erase(it);
+    }
+}
+
 std::shared_ptr<PageData> PageManager::readPage(Editor *editor,
                                                 size_t dataset,
                                                 size_t index)
@@ -56,26 +88,34 @@ std::shared_ptr<PageData> PageManager::readPage(Editor *editor,
 
     Key nk = {dataset, index};
 
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Wait until page loader finishes reading of this page.
+    conditionLoaded_.wait(lock, [&] { return loading_.count(nk) == 0; });
+
     auto search = cache_.find(nk);
     if (search != cache_.end())
     {
         LOG_DEBUG(<< "Return from cache.");
-        return search->second;
+
+        erase(prefetched_, nk);
+        retainEntry(search->second);
+
+        return search->second.page;
     }
 
     std::shared_ptr<PageData> result;
     result = std::make_shared<PageData>(nk.datasetId, nk.pageId);
-    cache_[nk] = result;
+    cache_[nk] = {result, 0, false, released_.end()};
 
-    try
-    {
-        LOG_DEBUG(<< "Read new page data.");
-        result->readPage(editor);
-    }
-    catch (...)
-    {
-        // Some error.
-    }
+    loading_.insert(nk);
+    lock.unlock();
+
+    LOG_DEBUG(<< "Read new page data.");
+    loadPage(editor, result);
+
+    lock.lock();
+    setLoaded(nk);
 
     return result;
 }
@@ -86,17 +126,412 @@ void PageManager::erasePage(Editor *editor, size_t dataset, size_t index)
 
     Key nk = {dataset, index};
 
+    std::unique_lock<std::mutex> lock(mutex_);
+
     auto it = cache_.find(nk);
     if (it != cache_.end())
     {
-        if (it->second.use_count() == 1)
+        if (it->second.page.use_count() == 1 && loading_.count(nk) == 0 &&
+            !it->second.released)
         {
-            if (it->second->modified())
-            {
-                it->second->writePage(editor);
-            }
+            erase(prefetched_, nk);
+            releaseEntry(nk, it->second);
+            releaseCache(lock, editor);
+        }
+    }
+}
+
+void PageManager::flush(Editor *editor)
+{
+    LOG_DEBUG(<< "Flush.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    std::vector<Key> keys;
+    for (const auto &key : released_)
+    {
+        if (cache_[key].page->modified())
+        {
+            keys.push_back(key);
+        }
+    }
+
+    for (const auto &key : keys)
+    {
+        auto it = cache_.find(key);
+        if (it == cache_.end() || !it->second.released ||
+            loading_.count(key) > 0)
+        {
+            continue;
+        }
+
+        writeEntry(lock, editor, key);
 
-            cache_.erase(it);
+        it = cache_.find(key);
+        if (it != cache_.end() && it->second.page.use_count() == 1)
+        {
+            releaseEntry(key, it->second);
+        }
+    }
+}
+
+void PageManager::clearCache(Editor *editor)
+{
+    LOG_DEBUG(<< "Clear cache.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Pages which can not be written stay in the cache.
+    std::vector<Key> keys(released_.rbegin(), released_.rend());
+
+    for (const auto &key : keys)
+    {
+        auto it = cache_.find(key);
+        if (it != cache_.end() && it->second.released)
+        {
+            evictEntry(lock, editor, key);
+        }
+    }
+}
+
+void PageManager::setCacheSizeMaximum(size_t nBytes)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cacheSizeMaximum_ = nBytes;
+}
+
+PageManager::Statistics PageManager::statistics()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    Statistics result;
+    result.nPages = cache_.size();
+    result.cacheSizeInMemory = cacheSizeInMemory_;
+    result.cacheSizeMaximum = cacheSizeMaximum_;
+    result.nEvictions = nEvictions_;
+    result.nWrites = nWrites_;
+
+    return result;
+}
+
+bool PageManager::prefetchPage(Editor *editor, size_t dataset, size_t index)
+{
+    Key nk = {dataset, index};
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (numberOfThreads_ == 0 || cache_.count(nk) > 0)
+    {
+        return false;
+    }
+
+    if (contains(queue_, nk))
+    {
+        return false;
+    }
+
+    // Make room by releasing the oldest page which was not requested.
+    if (queue_.size() + prefetched_.size() >= maximumPrefetch_ &&
+        !erasePrefetched())
+    {
+        return false;
+    }
+
+    LOG_DEBUG(<< "Prefetch page <" << index << "> dataset <" << dataset
+              << ">.");
+
+    editor_ = editor;
+    queue_.push_back(nk);
+
+    if (threads_.empty())
+    {
+        startThreads();
+    }
+
+    condition_.notify_one();
+
+    return true;
+}
+
+void PageManager::cancelPrefetch()
+{
+    LOG_DEBUG(<< "Cancel prefetch.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    queue_.clear();
+
+    // Wait until page loader threads finish pages which are being read.
+    conditionLoaded_.wait(lock, [&] { return loading_.empty(); });
+
+    // Release prefetched pages which were not requested.
+    while (erasePrefetched())
+    {
+    }
+
+    prefetched_.clear();
+}
+
+void PageManager::setNumberOfThreads(size_t nThreads)
+{
+    cancelPrefetch();
+    stopThreads();
+    numberOfThreads_ = nThreads;
+}
+
+void PageManager::setMaximumPrefetch(size_t nPages)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    maximumPrefetch_ = nPages;
+}
+
+bool PageManager::erasePrefetched()
+{
+    for (auto it = prefetched_.begin(); it != prefetched_.end(); ++it)
+    {
+        auto search = cache_.find(*it);
+        if (search == cache_.end())
+        {
+            prefetched_.erase(it);
+            return true;
+        }
+
+        if (search->second.page.use_count() == 1 &&
+            loading_.count(*it) == 0 && !search->second.page->modified())
+        {
+            LOG_DEBUG(<< "Release prefetched page <" << it->pageId
+                      << "> dataset <" << it->datasetId << ">.");
+            eraseEntry(search);
+            prefetched_.erase(it);
+            return true;
         }
     }
+
+    return false;
+}
+
+void PageManager::eraseEntry(std::map<Key, Entry>::iterator it)
+{
+    if (it->second.released)
+    {
+        released_.erase(it->second.releasedPosition);
+    }
+
+    cacheSizeInMemory_ -= it->second.size;
+    cache_.erase(it);
+}
+
+void PageManager::retainEntry(Entry &entry)
+{
+    if (entry.released)
+    {
+        released_.erase(entry.releasedPosition);
+        entry.released = false;
+        entry.releasedPosition = released_.end();
+    }
+}
+
+void PageManager::releaseEntry(const Key &key, Entry &entry)
+{
+    LOG_DEBUG(<< "Release page <" << key.pageId << "> dataset <"
+              << key.datasetId << ">.");
+
+    released_.push_front(key);
+    entry.released = true;
+    entry.releasedPosition = released_.begin();
+}
+
+void PageManager::releaseCache(std::unique_lock<std::mutex> &lock,
+                               Editor *editor)
+{
+    // Drop the least recently released pages. A page which can not be
+    // written is released again, the next release retries.
+    while (cacheSizeInMemory_ > cacheSizeMaximum_ && !released_.empty())
+    {
+        if (!evictEntry(lock, editor, released_.back()))
+        {
+            break;
+        }
+    }
+}
+
+bool PageManager::evictEntry(std::unique_lock<std::mutex> &lock,
+                             Editor *editor,
+                             Key key)
+{
+    LOG_DEBUG(<< "Drop page <" << key.pageId << "> dataset <"
+              << key.datasetId << ">.");
+
+    auto it = cache_.find(key);
+
+    if (it->second.page->modified())
+    {
+        // Write back. Eviction runs also from page destructors, so write
+        // errors are logged and not thrown.
+        try
+        {
+            writeEntry(lock, editor, key);
+        }
+        catch (std::exception &e)
+        {
+            LOG_ERROR(<< "Write page <" << key.pageId << "> dataset <"
+                      << key.datasetId << "> failed: " << e.what() << ".");
+            return false;
+        }
+        catch (...)
+        {
+            LOG_ERROR(<< "Write page <" << key.pageId << "> dataset <"
+                      << key.datasetId << "> failed.");
+            return false;
+        }
+
+        // Keep the page if it was requested again.
+        it = cache_.find(key);
+        if (it == cache_.end() || it->second.page.use_count() > 1)
+        {
+            return true;
+        }
+    }
+
+    eraseEntry(it);
+    nEvictions_++;
+
+    return true;
+}
+
+void PageManager::writeEntry(std::unique_lock<std::mutex> &lock,
+                             Editor *editor,
+                             const Key &key)
+{
+    // The page is not released while it is being written. Other threads
+    // wait until the page is written.
+    Entry &entry = cache_[key];
+    retainEntry(entry);
+    std::shared_ptr<PageData> page = entry.page;
+    loading_.insert(key);
+    lock.unlock();
+
+    try
+    {
+        page->writePage(editor);
+    }
+    catch (...)
+    {
+        page.reset();
+
+        lock.lock();
+        loading_.erase(key);
+        conditionLoaded_.notify_all();
+
+        // Release the page again, it stays modified and charged to the cache.
+        auto it = cache_.find(key);
+        if (it != cache_.end() && it->second.page.use_count() == 1 &&
+            !it->second.released)
+        {
+            releaseEntry(key, it->second);
+        }
+
+        throw;
+    }
+
+    lock.lock();
+    loading_.erase(key);
+    conditionLoaded_.notify_all();
+    nWrites_++;
+}
+
+void PageManager::setLoaded(const Key &key)
+{
+    loading_.erase(key);
+    conditionLoaded_.notify_all();
+
+    auto it = cache_.find(key);
+    if (it != cache_.end())
+    {
+        it->second.size = PageData::sizeInMemory(it->second.page->size());
+        cacheSizeInMemory_ += it->second.size;
+    }
+}
+
+void PageManager::loadPage(Editor *editor,
+                           const std::shared_ptr<PageData> &page)
+{
+    try
+    {
+        page->readPage(editor);
+    }
+    catch (...)
+    {
+        // Some error.
+    }
+}
+
+void PageManager::runLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true)
+    {
+        condition_.wait(lock, [&] { return exit_ || !queue_.empty(); });
+
+        if (exit_)
+        {
+            return;
+        }
+
+        Key nk = queue_.front();
+        queue_.pop_front();
+
+        if (cache_.count(nk) > 0)
+        {
+            // This page was already read by the caller.
+            continue;
+        }
+
+        std::shared_ptr<PageData> result;
+        result = std::make_shared<PageData>(nk.datasetId, nk.pageId);
+        cache_[nk] = {result, 0, false, released_.end()};
+
+        loading_.insert(nk);
+        prefetched_.push_back(nk);
+        Editor *editor = editor_;
+        lock.unlock();
+
+        LOG_DEBUG(<< "Load page <" << nk.pageId << "> dataset <"
+                  << nk.datasetId << ">.");
+        loadPage(editor, result);
+
+        lock.lock();
+        setLoaded(nk);
+    }
+}
+
+void PageManager::startThreads()
+{
+    LOG_DEBUG(<< "Start <" << numberOfThreads_ << "> page loader threads.");
+
+    exit_ = false;
+
+    for (size_t i = 0; i < numberOfThreads_; i++)
+    {
+        threads_.push_back(std::thread(&PageManager::runLoop, this));
+    }
+}
+
+void PageManager::stopThreads()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        exit_ = true;
+        queue_.clear();
+    }
+
+    condition_.notify_all();
+
+    for (auto &it : threads_)
+    {
+        it.join();
+    }
+
+    threads_.clear();
 }
@@ -22,6 +22,16 @@
 #ifndef PAGE_MANAGER_HPP
 #define PAGE_MANAGER_HPP
 
+// Include std.
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
 // Include 3D Forest.
 #include <PageData.hpp>
 class Editor;
@@ -30,10 +40,35 @@ class Editor;
 #include <ExportEditor.hpp>
 #include <WarningsDisable.hpp>
 
-/** Page Manager. */
+/** Page Manager.
+
+    Page manager is the page cache shared by all queries of the editor.
+    Page data are reference counted, so rendering and compute queries which
+    request the same page share one copy. Each query keeps its own selection
+    of points in its pages.
+
+    Pages which are no longer used by any query are kept in the cache until
+    the cache size reaches its maximum. Then the least recently released
+    pages are dropped. Modified pages are written back when they are dropped
+    or when the cache is flushed.
+
+    Pages may be prefetched by a small pool of page loader threads. Query
+    requests pages which it will need next, so they are read from disk
+    while the calling thread processes the current page.
+*/
 class EXPORT_EDITOR PageManager
 {
 public:
+    /** Page Manager Statistics. */
+    struct EXPORT_EDITOR Statistics
+    {
+        size_t nPages;
+        size_t cacheSizeInMemory;
+        size_t cacheSizeMaximum;
+        uint64_t nEvictions;
+        uint64_t nWrites;
+    };
+
     PageManager();
     ~PageManager();
 
@@ -43,6 +78,30 @@ public:
 
     void erasePage(Editor *editor, size_t dataset, size_t index);
 
+    /** Write modified pages which are not used. */
+    void flush(Editor *editor);
+
+    /** Write and drop all cached pages which are not used. */
+    void clearCache(Editor *editor);
+
+    /** Set maximum size of cached pages in bytes.
+        The cache is reduced to this size when the next page is released.
+    */
+    void setCacheSizeMaximum(size_t nBytes);
+    size_t cacheSizeMaximum() const { return cacheSizeMaximum_; }
+
+    Statistics statistics();
+
+    // Prefetch.
+    bool prefetchPage(Editor *editor, size_t dataset, size_t index);
+    void cancelPrefetch();
+
+    void setNumberOfThreads(size_t nThreads);
+    size_t numberOfThreads() const { return numberOfThreads_; }
+
+    void setMaximumPrefetch(size_t nPages);
+    size_t maximumPrefetch() const { return maximumPrefetch_; }
+
 private:
     struct Key
     {
@@ -50,9 +109,58 @@ private:
         size_t pageId;
 
         bool operator<(const Key &rhs) const;
+        bool operator==(const Key &rhs) const;
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<PageData> page;
+        size_t size;
+        bool released;
+        std::list<Key>::iterator releasedPosition;
     };
 
-    std::map<Key, std::shared_ptr<PageData>> cache_;
+    std::map<Key, Entry> cache_;
+
+    // Released pages. The most recently released pages are at the front.
+    std::list<Key> released_;
+    size_t cacheSizeMaximum_;
+    size_t cacheSizeInMemory_;
+    uint64_t nEvictions_;
+    uint64_t nWrites_;
+
+    // Page loader.
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::condition_variable conditionLoaded_;
+    std::vector<std::thread> threads_;
+    size_t numberOfThreads_;
+    size_t maximumPrefetch_;
+    bool exit_;
+
+    Editor *editor_;
+    std::deque<Key> queue_;
+    std::set<Key> loading_;
+    std::deque<Key> prefetched_;
+
+    static bool contains(const std::deque<Key> &list, const Key &key);
+    static void erase(std::deque<Key> &list, const Key &key);
+    bool erasePrefetched();
+    void eraseEntry(std::map<Key, Entry>::iterator it);
+    void retainEntry(Entry &entry);
+    void releaseEntry(const Key &key, Entry &entry);
+    void releaseCache(std::unique_lock<std::mutex> &lock, Editor *editor);
+    bool evictEntry(std::unique_lock<std::mutex> &lock,
+                    Editor *editor,
+                    Key key);
+    void writeEntry(std::unique_lock<std::mutex> &lock,
+                    Editor *editor,
+                    const Key &key);
+    void setLoaded(const Key &key);
+    void loadPage(Editor *editor, const std::shared_ptr<PageData> &page);
+    void runLoop();
+    void startThreads();
+    void stopThreads();
 };
 
 #include <WarningsEnable.hpp>
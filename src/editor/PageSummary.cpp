@@ -0,0 +1,147 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PageSummary.cpp */
+
+// Include std.
+#include <limits>
+
+// Include 3D Forest.
+#include <Endian.hpp>
+#include <PageSummary.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "PageSummary"
+#include <Log.hpp>
+
+template <class T, class U>
+static void pageSummaryRange(T &min, T &max, const U *data, size_t n)
+{
+    min = std::numeric_limits<T>::max();
+    max = std::numeric_limits<T>::lowest();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const T value = static_cast<T>(data[i]);
+
+        if (value < min)
+        {
+            min = value;
+        }
+
+        if (value > max)
+        {
+            max = value;
+        }
+    }
+}
+
+PageSummary::PageSummary()
+{
+    clear();
+}
+
+void PageSummary::clear()
+{
+    nPoints = 0;
+    elevationMin = 0;
+    elevationMax = 0;
+    descriptorMin = 0;
+    descriptorMax = 0;
+    segmentMin = 0;
+    segmentMax = 0;
+    intensityMin = 0;
+    intensityMax = 0;
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        classification[i] = 0;
+    }
+}
+
+void PageSummary::setPoints(const uint16_t *intensity,
+                            const uint8_t *classificationValues,
+                            size_t n)
+{
+    nPoints = static_cast<uint32_t>(n);
+
+    pageSummaryRange(intensityMin, intensityMax, intensity, n);
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        classification[i] = 0;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint8_t value = classificationValues[i];
+        classification[value >> 6] |= uint64_t(1) << (value & 63U);
+    }
+}
+
+void PageSummary::setSegment(const uint32_t *segment, size_t n)
+{
+    pageSummaryRange(segmentMin, segmentMax, segment, n);
+}
+
+void PageSummary::setElevation(const float *elevation, size_t n)
+{
+    pageSummaryRange(elevationMin, elevationMax, elevation, n);
+}
+
+void PageSummary::setDescriptor(const float *descriptor, size_t n)
+{
+    pageSummaryRange(descriptorMin, descriptorMax, descriptor, n);
+}
+
+void PageSummary::read(const uint8_t *buffer)
+{
+    elevationMin = ltohd(&buffer[0]);
+    elevationMax = ltohd(&buffer[8]);
+    descriptorMin = ltohd(&buffer[16]);
+    descriptorMax = ltohd(&buffer[24]);
+    segmentMin = ltoh32(&buffer[32]);
+    segmentMax = ltoh32(&buffer[36]);
+    intensityMin = ltoh16(&buffer[40]);
+    intensityMax = ltoh16(&buffer[42]);
+    nPoints = ltoh32(&buffer[44]);
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        classification[i] = ltoh64(&buffer[48 + (i * 8)]);
+    }
+}
+
+void PageSummary::write(uint8_t *buffer) const
+{
+    htold(&buffer[0], elevationMin);
+    htold(&buffer[8], elevationMax);
+    htold(&buffer[16], descriptorMin);
+    htold(&buffer[24], descriptorMax);
+    htol32(&buffer[32], segmentMin);
+    htol32(&buffer[36], segmentMax);
+    htol16(&buffer[40], intensityMin);
+    htol16(&buffer[42], intensityMax);
+    htol32(&buffer[44], nPoints);
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        htol64(&buffer[48 + (i * 8)], classification[i]);
+    }
+}
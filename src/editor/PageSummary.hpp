@@ -0,0 +1,82 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PageSummary.hpp */
+
+#ifndef PAGE_SUMMARY_HPP
+#define PAGE_SUMMARY_HPP
+
+// Include std.
+#include <cstddef>
+#include <cstdint>
+
+// Include local.
+#include <ExportEditor.hpp>
+#include <WarningsDisable.hpp>
+
+/** Page Summary.
+
+    Value ranges of points in one page. Query uses these ranges to skip
+    pages which can not contain any point matching attribute filters.
+    Summary without points is unknown and it matches everything.
+*/
+class EXPORT_EDITOR PageSummary
+{
+public:
+    /** Size of serialized summary in bytes. */
+    static constexpr size_t SIZE = 80;
+
+    uint32_t nPoints;
+    double elevationMin;
+    double elevationMax;
+    double descriptorMin;
+    double descriptorMax;
+    uint32_t segmentMin;
+    uint32_t segmentMax;
+    uint16_t intensityMin;
+    uint16_t intensityMax;
+
+    /** Bit set of classifications 0 to 255 present in the page. */
+    uint64_t classification[4];
+
+    PageSummary();
+
+    void clear();
+    bool empty() const { return nPoints == 0; }
+
+    void setPoints(const uint16_t *intensity,
+                   const uint8_t *classification,
+                   size_t n);
+    void setSegment(const uint32_t *segment, size_t n);
+    void setElevation(const float *elevation, size_t n);
+    void setDescriptor(const float *descriptor, size_t n);
+
+    bool hasClassification(size_t value) const
+    {
+        return value < 256 &&
+               ((classification[value >> 6] >> (value & 63U)) & 1U) != 0;
+    }
+
+    void read(const uint8_t *buffer);
+    void write(uint8_t *buffer) const;
+};
+
+#include <WarningsEnable.hpp>
+
+#endif /* PAGE_SUMMARY_HPP */
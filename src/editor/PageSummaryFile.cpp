@@ -0,0 +1,172 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PageSummaryFile.cpp */
+
+// Include std.
+#include <cstring>
+
+// Include 3D Forest.
+#include <Endian.hpp>
+#include <Error.hpp>
+#include <PageSummaryFile.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "PageSummaryFile"
+#include <Log.hpp>
+
+#define PAGE_SUMMARY_FILE_SIGNATURE "3DFS"
+#define PAGE_SUMMARY_FILE_MAJOR_VERSION 1
+#define PAGE_SUMMARY_FILE_MINOR_VERSION 0
+#define PAGE_SUMMARY_FILE_HEADER_SIZE 16
+
+PageSummaryFile::PageSummaryFile()
+{
+}
+
+PageSummaryFile::~PageSummaryFile()
+{
+}
+
+std::string PageSummaryFile::extension(const std::string &path)
+{
+    return File::replaceExtension(path, ".summary");
+}
+
+void PageSummaryFile::create(const std::string &path, uint64_t nPages)
+{
+    LOG_DEBUG(<< "Create page summary file <" << path << "> pages <"
+              << nPages << ">.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    file_.open(path, "w+");
+
+    pages_.clear();
+    pages_.resize(nPages);
+    modified_.clear();
+    modified_.resize(nPages, false);
+
+    // Header.
+    uint8_t header[PAGE_SUMMARY_FILE_HEADER_SIZE];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, PAGE_SUMMARY_FILE_SIGNATURE, 4);
+    header[4] = PAGE_SUMMARY_FILE_MAJOR_VERSION;
+    header[5] = PAGE_SUMMARY_FILE_MINOR_VERSION;
+    htol16(&header[6], PAGE_SUMMARY_FILE_HEADER_SIZE);
+    htol64(&header[8], nPages);
+    file_.write(header, sizeof(header));
+
+    // Empty summaries.
+    std::vector<uint8_t> table;
+    table.resize(nPages * PageSummary::SIZE);
+    for (size_t i = 0; i < pages_.size(); i++)
+    {
+        pages_[i].write(&table[i * PageSummary::SIZE]);
+    }
+    file_.write(table.data(), table.size());
+}
+
+void PageSummaryFile::open(const std::string &path)
+{
+    LOG_DEBUG(<< "Open page summary file <" << path << ">.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    file_.open(path, "r+");
+
+    // Header.
+    uint8_t header[PAGE_SUMMARY_FILE_HEADER_SIZE];
+    if (file_.size() < sizeof(header))
+    {
+        THROW("Page summary file '" + path + "' is too small");
+    }
+
+    file_.read(header, sizeof(header));
+
+    if (std::memcmp(header, PAGE_SUMMARY_FILE_SIGNATURE, 4) != 0 ||
+        header[4] != PAGE_SUMMARY_FILE_MAJOR_VERSION ||
+        ltoh16(&header[6]) != PAGE_SUMMARY_FILE_HEADER_SIZE)
+    {
+        THROW("Page summary file '" + path + "' has unknown format");
+    }
+
+    uint64_t nPages = ltoh64(&header[8]);
+    if (file_.size() < sizeof(header) + (nPages * PageSummary::SIZE))
+    {
+        THROW("Page summary file '" + path + "' is truncated");
+    }
+
+    // Summaries.
+    std::vector<uint8_t> table;
+    table.resize(nPages * PageSummary::SIZE);
+    file_.read(table.data(), table.size());
+
+    pages_.resize(nPages);
+    modified_.clear();
+    modified_.resize(nPages, false);
+    for (size_t i = 0; i < pages_.size(); i++)
+    {
+        pages_[i].read(&table[i * PageSummary::SIZE]);
+    }
+}
+
+void PageSummaryFile::close()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    file_.close();
+    pages_.clear();
+    modified_.clear();
+}
+
+PageSummary PageSummaryFile::summary(uint64_t page) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    return pages_[page];
+}
+
+void PageSummaryFile::write(uint64_t page, const PageSummary &summary)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    pages_[page] = summary;
+    modified_[page] = false;
+
+    uint8_t entry[PageSummary::SIZE];
+    summary.write(entry);
+
+    file_.seek(PAGE_SUMMARY_FILE_HEADER_SIZE + (page * PageSummary::SIZE));
+    file_.write(entry, sizeof(entry));
+}
+
+void PageSummaryFile::setModified(uint64_t page)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    modified_[page] = true;
+}
+
+bool PageSummaryFile::modified(uint64_t page) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    return modified_[page];
+}
@@ -0,0 +1,77 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PageSummaryFile.hpp */
+
+#ifndef PAGE_SUMMARY_FILE_HPP
+#define PAGE_SUMMARY_FILE_HPP
+
+// Include std.
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Include 3D Forest.
+#include <File.hpp>
+#include <PageSummary.hpp>
+
+// Include local.
+#include <ExportEditor.hpp>
+#include <WarningsDisable.hpp>
+
+/** Page Summary File.
+
+    Sidecar of an indexed dataset with one fixed size summary for each page
+    of the main index. The file is created by the index builder and each
+    summary is updated in place when its page is written.
+*/
+class EXPORT_EDITOR PageSummaryFile
+{
+public:
+    PageSummaryFile();
+    ~PageSummaryFile();
+
+    static std::string extension(const std::string &path);
+
+    void create(const std::string &path, uint64_t nPages);
+    void open(const std::string &path);
+    void close();
+    bool open() const { return file_.open(); }
+
+    uint64_t numberOfPages() const { return pages_.size(); }
+
+    PageSummary summary(uint64_t page) const;
+    void write(uint64_t page, const PageSummary &summary);
+
+    /** Mark summary of page modified in memory as outdated.
+        The summary is valid again when the page is written.
+    */
+    void setModified(uint64_t page);
+    bool modified(uint64_t page) const;
+
+protected:
+    File file_;
+    std::vector<PageSummary> pages_;
+    std::vector<bool> modified_;
+    mutable std::mutex mutex_;
+};
+
+#include <WarningsEnable.hpp>
+
+#endif /* PAGE_SUMMARY_FILE_HPP */
@@ -0,0 +1,289 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PointSearch.cpp */
+
+// Include std.
+#include <algorithm>
+#include <cmath>
+
+// Include 3D Forest.
+#include <Editor.hpp>
+#include <PointSearch.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "PointSearch"
+#include <Log.hpp>
+
+#define POINT_SEARCH_CACHE_SIZE_DEFAULT 64
+#define POINT_SEARCH_PI 3.14159265358979323846
+
+static bool pointSearchCompare(const PointSearch::Point &a,
+                               const PointSearch::Point &b)
+{
+    return a.distance < b.distance;
+}
+
+PointSearch::PointSearch(Editor *editor)
+    : editor_(editor),
+      cacheSizeMaximum_(POINT_SEARCH_CACHE_SIZE_DEFAULT),
+      cacheTime_(0)
+{
+}
+
+PointSearch::~PointSearch()
+{
+    clear();
+}
+
+void PointSearch::setCacheSize(size_t nPages)
+{
+    cacheSizeMaximum_ = nPages;
+    releasePages(cacheTime_ + 1);
+}
+
+void PointSearch::radius(std::vector<Point> &result,
+                         double x,
+                         double y,
+                         double z,
+                         double radius)
+{
+    uint64_t searchTime = cacheTime_ + 1;
+
+    select(result, x, y, z, radius);
+    std::sort(result.begin(), result.end(), pointSearchCompare);
+    finish(result);
+
+    releasePages(searchTime);
+}
+
+void PointSearch::nearest(std::vector<Point> &result,
+                          double x,
+                          double y,
+                          double z,
+                          size_t k,
+                          double radiusMaximum)
+{
+    result.clear();
+
+    if (k == 0 || !(radiusMaximum > 0))
+    {
+        return;
+    }
+
+    uint64_t searchTime = cacheTime_ + 1;
+
+    // Distance to the farthest corner of the searched datasets. Larger
+    // radius can not find more points.
+    Box<double> boundary = editor_->datasets().boundary(dataset_);
+    double radiusAll = 0;
+    for (size_t i = 0; i < 3; i++)
+    {
+        double p = (i == 0) ? x : ((i == 1) ? y : z);
+        double d = std::max(std::abs(p - boundary.min(i)),
+                            std::abs(p - boundary.max(i)));
+        radiusAll += d * d;
+    }
+    radiusAll = std::sqrt(radiusAll);
+
+    // All points within the radius are found. When there are at least k of
+    // them, the k closest points are the exact result. Otherwise repeat the
+    // search with doubled radius. Pages stay resident between iterations.
+    double r = std::min(estimateRadius(k), radiusMaximum);
+
+    while (true)
+    {
+        select(result, x, y, z, r);
+
+        if (result.size() >= k || !(r < radiusMaximum) || r > radiusAll)
+        {
+            break;
+        }
+
+        r = std::min(r * 2.0, radiusMaximum);
+    }
+
+    if (result.size() > k)
+    {
+        std::partial_sort(result.begin(),
+                          result.begin() + static_cast<std::ptrdiff_t>(k),
+                          result.end(),
+                          pointSearchCompare);
+        result.resize(k);
+    }
+    else
+    {
+        std::sort(result.begin(), result.end(), pointSearchCompare);
+    }
+
+    finish(result);
+
+    releasePages(searchTime);
+}
+
+PageData &PointSearch::page(const Point &point)
+{
+    return readPage(point.datasetId, point.pageId);
+}
+
+void PointSearch::clear()
+{
+    for (auto &entry : lru_)
+    {
+        entry.pageData.reset();
+        editor_->erasePage(entry.key.datasetId, entry.key.pageId);
+    }
+
+    cache_.clear();
+    lru_.clear();
+}
+
+void PointSearch::select(std::vector<Point> &result,
+                         double x,
+                         double y,
+                         double z,
+                         double radius)
+{
+    result.clear();
+
+    if (!(radius >= 0))
+    {
+        return;
+    }
+
+    const Box<double> box(x, y, z, radius);
+    const double radius2 = radius * radius;
+
+    // Select pages from all levels of dataset index.
+    selectedPages_.resize(0);
+    editor_->datasets().selectPages(dataset_, box, selectedPages_);
+
+    for (const auto &selectedPage : selectedPages_)
+    {
+        PageData &pageData = readPage(selectedPage.id, selectedPage.idx);
+        const IndexFile &octree = pageData.octree;
+
+        // Select leaf octants of page index.
+        selectedLeaves_.resize(0);
+        octree.selectLeaves(selectedLeaves_, box, selectedPage.id);
+
+        for (const auto &selectedLeaf : selectedLeaves_)
+        {
+            const IndexFile::Node *node = octree.at(selectedLeaf.idx);
+            if (!node)
+            {
+                continue;
+            }
+
+            size_t from = static_cast<size_t>(node->from);
+            size_t to = from + static_cast<size_t>(node->size);
+
+            for (size_t i = from; i < to; i++)
+            {
+                double dx = pageData.x(i) - x;
+                double dy = pageData.y(i) - y;
+                double dz = pageData.z(i) - z;
+                double d2 = dx * dx + dy * dy + dz * dz;
+
+                if (d2 <= radius2)
+                {
+                    // Squared distance until finish().
+                    result.push_back(
+                        {selectedPage.id, selectedPage.idx, i, d2});
+                }
+            }
+        }
+    }
+}
+
+void PointSearch::finish(std::vector<Point> &result)
+{
+    for (auto &point : result)
+    {
+        point.distance = std::sqrt(point.distance);
+    }
+}
+
+PageData &PointSearch::readPage(size_t datasetId, size_t pageId)
+{
+    Key nk = {datasetId, pageId};
+
+    auto search = cache_.find(nk);
+    if (search != cache_.end())
+    {
+        // Move found page to top.
+        lru_.splice(lru_.begin(), lru_, search->second);
+        search->second->lastUsed = ++cacheTime_;
+        return *search->second->pageData;
+    }
+
+    // Shared with other queries when the page is already resident.
+    std::shared_ptr<PageData> pageData = editor_->readPage(datasetId, pageId);
+
+    // New page is on top.
+    lru_.push_front({nk, pageData, ++cacheTime_});
+    cache_[nk] = lru_.begin();
+
+    return *pageData;
+}
+
+void PointSearch::releasePages(uint64_t searchTime)
+{
+    // Release least recently used pages which were not used by the last
+    // search. Its results refer to the remaining pages.
+    while (cache_.size() > cacheSizeMaximum_ &&
+           lru_.back().lastUsed < searchTime)
+    {
+        Key key = lru_.back().key;
+        cache_.erase(key);
+        lru_.pop_back();
+        editor_->erasePage(key.datasetId, key.pageId);
+    }
+}
+
+double PointSearch::estimateRadius(size_t k) const
+{
+    // Radius of a sphere which contains k points on average.
+    Box<double> boundary = editor_->datasets().boundary(dataset_);
+    uint64_t nPoints = editor_->datasets().nPoints(dataset_);
+
+    double volume = (boundary.max(0) - boundary.min(0)) *
+                    (boundary.max(1) - boundary.min(1)) *
+                    (boundary.max(2) - boundary.min(2));
+
+    if (nPoints == 0 || !(volume > 0))
+    {
+        return 1.0;
+    }
+
+    double density = static_cast<double>(nPoints) / volume;
+    double kd = static_cast<double>(k);
+
+    return std::cbrt((3.0 * kd) / (4.0 * POINT_SEARCH_PI * density));
+}
+
+bool PointSearch::Key::operator<(const Key &rhs) const
+{
+    if (datasetId != rhs.datasetId)
+    {
+        return datasetId < rhs.datasetId;
+    }
+
+    return pageId < rhs.pageId;
+}
@@ -0,0 +1,146 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file PointSearch.hpp */
+
+#ifndef POINT_SEARCH_HPP
+#define POINT_SEARCH_HPP
+
+// Include std.
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Include 3D Forest.
+#include <IndexFile.hpp>
+#include <PageData.hpp>
+#include <QueryFilterSet.hpp>
+class Editor;
+
+// Include local.
+#include <ExportEditor.hpp>
+#include <WarningsDisable.hpp>
+
+/** Point Search.
+
+    Radius and k-nearest neighbour search in datasets. Pages are selected by
+    the dataset index and points by the octree of each page. Pages which were
+    already read by other queries are shared through the page manager. The
+    search keeps up to cacheSize() recently used pages resident between calls.
+
+    Returned points are sorted by distance from the search position. They are
+    valid until the next search call.
+*/
+class EXPORT_EDITOR PointSearch
+{
+public:
+    /** Point Search Result. */
+    struct EXPORT_EDITOR Point
+    {
+        size_t datasetId;
+        size_t pageId;
+        size_t index;
+        double distance;
+    };
+
+    PointSearch(Editor *editor);
+    ~PointSearch();
+
+    void setDataset(const QueryFilterSet &dataset) { dataset_ = dataset; }
+    const QueryFilterSet &dataset() const { return dataset_; }
+
+    void setCacheSize(size_t nPages);
+    size_t cacheSize() const { return cacheSizeMaximum_; }
+
+    /** Find all points within the given radius. */
+    void radius(std::vector<Point> &result,
+                double x,
+                double y,
+                double z,
+                double radius);
+
+    /** Find k nearest points which are not farther than maximum radius. */
+    void nearest(std::vector<Point> &result,
+                 double x,
+                 double y,
+                 double z,
+                 size_t k,
+                 double radiusMaximum = std::numeric_limits<double>::max());
+
+    /** Page data of the given search result. */
+    PageData &page(const Point &point);
+
+    double x(const Point &point) { return page(point).x(point.index); }
+    double y(const Point &point) { return page(point).y(point.index); }
+    double z(const Point &point) { return page(point).z(point.index); }
+
+    /** Release all resident pages. */
+    void clear();
+
+private:
+    Editor *editor_;
+    QueryFilterSet dataset_;
+
+    // Buffers.
+    std::vector<IndexFile::Selection> selectedPages_;
+    std::vector<IndexFile::Selection> selectedLeaves_;
+
+    // Cache.
+    struct Key
+    {
+        size_t datasetId;
+        size_t pageId;
+
+        bool operator<(const Key &rhs) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<PageData> pageData;
+        uint64_t lastUsed;
+    };
+
+    using CacheList = std::list<Entry>;
+
+    size_t cacheSizeMaximum_;
+    uint64_t cacheTime_;
+    std::map<Key, CacheList::iterator> cache_;
+
+    // Last Recently Used (LRU) for Cache. The most recently used pages are
+    // at the front.
+    CacheList lru_;
+
+    void select(std::vector<Point> &result,
+                double x,
+                double y,
+                double z,
+                double radius);
+    void finish(std::vector<Point> &result);
+
+    PageData &readPage(size_t datasetId, size_t pageId);
+    void releasePages(uint64_t searchTime);
+    double estimateRadius(size_t k) const;
+};
+
+#include <WarningsEnable.hpp>
+
+#endif /* POINT_SEARCH_HPP */
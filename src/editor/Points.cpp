@@ -19,6 +19,9 @@
 
 /** @file Points.cpp */
 
+// Include std.
+#include <algorithm>
+
 // Include 3D Forest.
 #include <Points.hpp>
 
@@ -26,16 +29,25 @@
 #define LOG_MODULE_NAME "Points"
 #include <Log.hpp>
 
+#define POINTS_MEMORY_SIZE_MAXIMUM (512UL * 1024UL * 1024UL)
+#define POINTS_FILE_PATH "points.bin"
+#define POINTS_QUERIES_PER_TASK 256
+
 Points::Points()
+    : memorySizeMaximum_(POINTS_MEMORY_SIZE_MAXIMUM),
+      inMemory_(true),
+      threadPoolCreated_(false)
 {
-    points_.create("points.bin");
 }
 
 Points::~Points()
 {
     try
     {
-        points_.close();
+        if (!inMemory_)
+        {
+            file_.close();
+        }
     }
     catch (...)
     {
@@ -43,24 +55,82 @@ Points::~Points()
     }
 }
 
+void Points::setMemorySizeMaximum(size_t nBytes)
+{
+    memorySizeMaximum_ = nBytes;
+}
+
 void Points::clear()
 {
-    points_.clear();
+    memoryOctree_.clear();
+    fileOctree_.clear();
+
+    memory_.clear();
+    file_.clear();
+    inMemory_ = true;
 }
 
 void Points::push_back(const Point &point)
 {
-    points_.push_back(point);
+    if (inMemory_ && (memory_.size() + 1) * sizeof(Point) > memorySizeMaximum_)
+    {
+        moveToFile();
+    }
+
+    if (inMemory_)
+    {
+        memory_.push_back(point);
+    }
+    else
+    {
+        file_.push_back(point);
+    }
 }
 
 void Points::push_back(Point &&point)
 {
-    points_.push_back(point);
+    if (inMemory_ && (memory_.size() + 1) * sizeof(Point) > memorySizeMaximum_)
+    {
+        moveToFile();
+    }
+
+    if (inMemory_)
+    {
+        memory_.push_back(std::move(point));
+    }
+    else
+    {
+        file_.push_back(std::move(point));
+    }
+}
+
+void Points::moveToFile()
+{
+    LOG_DEBUG(<< "Move <" << memory_.size() << "> points to file.");
+
+    memoryOctree_.clear();
+
+    file_.create(POINTS_FILE_PATH);
+    for (const Point &point : memory_)
+    {
+        file_.push_back(point);
+    }
+
+    memory_.clear();
+    memory_.shrink_to_fit();
+    inMemory_ = false;
 }
 
 void Points::createIndex()
 {
-    octree_.initialize(points_);
+    if (inMemory_)
+    {
+        memoryOctree_.initialize(memory_);
+    }
+    else
+    {
+        fileOctree_.initialize(file_);
+    }
 }
 
 void Points::findRadius(double x,
@@ -69,14 +139,33 @@ void Points::findRadius(double x,
                         double r,
                         std::vector<size_t> &resultIndices)
 {
-    octree_.radiusNeighbors<unibn::L2Distance<Point>>({x, y, z},
-                                                      r,
-                                                      resultIndices);
+    if (inMemory_)
+    {
+        memoryOctree_.radiusNeighbors<unibn::L2Distance<Point>>({x, y, z},
+                                                                r,
+                                                                resultIndices);
+    }
+    else
+    {
+        fileOctree_.radiusNeighbors<unibn::L2Distance<Point>>({x, y, z},
+                                                              r,
+                                                              resultIndices);
+    }
 }
 
 size_t Points::findNN(double x, double y, double z)
 {
-    int32_t r = octree_.findNeighbor<unibn::L2Distance<Point>>({x, y, z});
+    int32_t r;
+
+    if (inMemory_)
+    {
+        r = memoryOctree_.findNeighbor<unibn::L2Distance<Point>>({x, y, z});
+    }
+    else
+    {
+        r = fileOctree_.findNeighbor<unibn::L2Distance<Point>>({x, y, z});
+    }
+
     if (r >= 0)
     {
         return static_cast<size_t>(r);
@@ -85,6 +174,102 @@ size_t Points::findNN(double x, double y, double z)
     return SIZE_MAX;
 }
 
+void Points::findRadius(const std::vector<size_t> &queries,
+                        double r,
+                        std::vector<size_t> &resultOffsets,
+                        std::vector<size_t> &resultIndices)
+{
+    size_t n = queries.size();
+    size_t nTasks = (n + POINTS_QUERIES_PER_TASK - 1) / POINTS_QUERIES_PER_TASK;
+
+    resultOffsets.resize(n + 1);
+    resultOffsets[0] = 0;
+
+    if (batch_.size() < nTasks)
+    {
+        batch_.resize(nTasks);
+    }
+
+    // Search each task of queries into its own buffer. The number of
+    // results of query i is stored in resultOffsets[i + 1].
+    const Points &points = *this;
+
+    std::function<void(size_t)> search = [&](size_t task)
+    {
+        size_t from = task * POINTS_QUERIES_PER_TASK;
+        size_t to = std::min(from + POINTS_QUERIES_PER_TASK, n);
+
+        std::vector<size_t> &buffer = batch_[task];
+        buffer.clear();
+
+        std::vector<size_t> result;
+
+        for (size_t i = from; i < to; i++)
+        {
+            const Point &a = points[queries[i]];
+
+            if (inMemory_)
+            {
+                memoryOctree_.radiusNeighbors<unibn::L2Distance<Point>>(
+                    {a.x, a.y, a.z},
+                    r,
+                    result);
+            }
+            else
+            {
+                fileOctree_.radiusNeighbors<unibn::L2Distance<Point>>(
+                    {a.x, a.y, a.z},
+                    r,
+                    result);
+            }
+
+            resultOffsets[i + 1] = result.size();
+            buffer.insert(buffer.end(), result.begin(), result.end());
+        }
+    };
+
+    // Paged file is not thread safe.
+    if (inMemory_)
+    {
+        if (!threadPoolCreated_)
+        {
+            setNumberOfThreads(0);
+        }
+
+        threadPool_.run(nTasks, search);
+    }
+    else
+    {
+        for (size_t i = 0; i < nTasks; i++)
+        {
+            search(i);
+        }
+    }
+
+    // Convert counts to offsets and concatenate the buffers.
+    for (size_t i = 0; i < n; i++)
+    {
+        resultOffsets[i + 1] += resultOffsets[i];
+    }
+
+    resultIndices.resize(resultOffsets[n]);
+
+    for (size_t i = 0; i < nTasks; i++)
+    {
+        const std::vector<size_t> &buffer = batch_[i];
+        size_t offset = resultOffsets[i * POINTS_QUERIES_PER_TASK];
+        std::copy(buffer.begin(),
+                  buffer.end(),
+                  resultIndices.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+}
+
+void Points::setNumberOfThreads(size_t nThreads)
+{
+    threadPool_.create(nThreads);
+    threadPoolCreated_ = true;
+}
+
 void Points::exportToFile(const std::string &path) const
 {
     Json json;
@@ -94,8 +279,8 @@ void Points::exportToFile(const std::string &path) const
 
 void toJson(Json &out, const Points &in)
 {
-    for (size_t i = 0; i < in.points_.size(); i++)
+    for (size_t i = 0; i < in.size(); i++)
     {
-        toJson(out[i], in.points_[i]);
+        toJson(out[i], in[i]);
     }
 }
@@ -22,18 +22,26 @@
 #ifndef POINTS_HPP
 #define POINTS_HPP
 
+// Include std.
+#include <vector>
+
 // 3rd party.
 #include <UnibnOctree.hpp>
 
 // Include 3D Forest.
 #include <Point.hpp>
+#include <ThreadPool.hpp>
 #include <VectorFile.hpp>
 
 // Include local.
 #include <ExportEditor.hpp>
 #include <WarningsDisable.hpp>
 
-/** Points. */
+/** Points.
+
+    Points are stored in memory until their size exceeds the maximum
+    memory size. Larger point sets are moved to a paged file.
+*/
 class EXPORT_EDITOR Points
 {
 public:
@@ -41,15 +49,23 @@ public:
     Points();
     ~Points();
 
+    // Storage.
+    void setMemorySizeMaximum(size_t nBytes);
+    size_t memorySizeMaximum() const { return memorySizeMaximum_; }
+    bool inMemory() const { return inMemory_; }
+
     // Capacity.
-    bool empty() const { return points_.size() > 0; }
-    size_t size() const { return points_.size(); }
+    bool empty() const { return size() == 0; }
+    size_t size() const { return inMemory_ ? memory_.size() : file_.size(); }
 
     // Element access.
-    Point &operator[](size_t pos) { return points_.at(pos); }
-    const Point &operator[](size_t pos) const { return points_.at(pos); }
-    Point &at(size_t pos) { return points_.at(pos); }
-    const Point &at(size_t pos) const { return points_.at(pos); }
+    Point &operator[](size_t pos) { return at(pos); }
+    const Point &operator[](size_t pos) const { return at(pos); }
+    Point &at(size_t pos) { return inMemory_ ? memory_[pos] : file_.at(pos); }
+    const Point &at(size_t pos) const
+    {
+        return inMemory_ ? memory_[pos] : file_.at(pos);
+    }
 
     // Modifiers.
     void push_back(const Point &point);
@@ -65,12 +81,37 @@ public:
                     std::vector<size_t> &resultIndices);
     size_t findNN(double x, double y, double z);
 
+    /** Find points in radius r from each query point.
+        Query points are given by their indices. Indices of points in radius
+        from point queries[i] are stored in resultIndices from
+        resultOffsets[i] to resultOffsets[i + 1]. Queries are processed in
+        parallel when points are in memory.
+    */
+    void findRadius(const std::vector<size_t> &queries,
+                    double r,
+                    std::vector<size_t> &resultOffsets,
+                    std::vector<size_t> &resultIndices);
+
+    void setNumberOfThreads(size_t nThreads);
+
     // I/O
     void exportToFile(const std::string &path) const;
 
 private:
-    VectorFile<Point, Point::IO> points_;
-    unibn::Octree<Point, VectorFile<Point, Point::IO>> octree_;
+    size_t memorySizeMaximum_;
+    bool inMemory_;
+
+    std::vector<Point> memory_;
+    unibn::Octree<Point> memoryOctree_;
+
+    VectorFile<Point, Point::IO> file_;
+    unibn::Octree<Point, VectorFile<Point, Point::IO>> fileOctree_;
+
+    ThreadPool threadPool_;
+    bool threadPoolCreated_;
+    std::vector<std::vector<size_t>> batch_;
+
+    void moveToFile();
 
     // I/O
     friend void toJson(Json &out, const Points &in);
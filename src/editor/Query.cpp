@@ -34,21 +34,76 @@
 // #define LOG_MODULE_DEBUG_ENABLED 1
 #include <Log.hpp>
 
+#define QUERY_RECENTER_MARGIN 2.0
+
 Query::Query(Editor *editor) : editor_(editor)
 {
     maximumResults_ = 0;
+    threadPoolCreated_ = false;
+    prefetchSize_ = 4;
+    recenterValid_ = false;
     cacheSizeMaximum_ =
         editor->settings().renderingSettings().cacheSizeMaximum() * 1048576;
+    cacheSizeInMemory_ = 0;
+    resetCacheStatistics();
 }
 
 Query::~Query()
 {
 }
 
+void Query::updateSegmentArray()
+{
+    where_.updateSegmentArray(editor_->segments(),
+                              editor_->speciesList(),
+                              editor_->managementStatusList(),
+                              editor_->segmentsVersion());
+}
+
+bool Query::pageIntersects(size_t datasetId, size_t pageId) const
+{
+    const Dataset &dataset = editor_->datasets().key(datasetId);
+    const PageSummaryFile *summaryFile = dataset.summaryFile();
+
+    if (!summaryFile || summaryFile->modified(pageId))
+    {
+        return true;
+    }
+
+    return where_.intersects(summaryFile->summary(pageId));
+}
+
+void Query::selectPagesBySummary()
+{
+    if (where_.segmentArrayEnabled())
+    {
+        updateSegmentArray();
+    }
+
+    size_t n = 0;
+
+    for (size_t i = 0; i < selectedPages_.size(); i++)
+    {
+        const IndexFile::Selection &page = selectedPages_[i];
+
+        if (pageIntersects(page.id, page.idx))
+        {
+            selectedPages_[n] = page;
+            n++;
+        }
+    }
+
+    LOG_DEBUG(<< "Skip <" << (selectedPages_.size() - n)
+              << "> pages by summary.");
+
+    selectedPages_.resize(n);
+}
+
 void Query::exec()
 {
     LOG_DEBUG(<< "Exec.");
     selectedPages_.clear();
+    recenterValid_ = false;
 
     bool selected = false;
 
@@ -93,6 +148,8 @@ void Query::exec()
                                         selectedPages_);
     }
 
+    selectPagesBySummary();
+
     reset();
 
     setState(Page::STATE_SELECT);
@@ -103,6 +160,9 @@ void Query::exec()
 void Query::exec(const std::vector<IndexFile::Selection> &selectedPages)
 {
     selectedPages_ = selectedPages;
+    recenterValid_ = false;
+
+    selectPagesBySummary();
 
     reset();
 
@@ -111,6 +171,78 @@ void Query::exec(const std::vector<IndexFile::Selection> &selectedPages)
     nResults_ = 0;
 }
 
+void Query::recenter(double x, double y, double z, double radius)
+{
+    where_.setSphere(x, y, z, radius);
+    const Box<double> box = where_.region().sphere.box();
+
+    bool covered = recenterValid_ && recenterBox_.contains(box);
+    for (size_t i = 0; i < recenterRevision_.size(); i++)
+    {
+        QueryWhere::Criterion c = static_cast<QueryWhere::Criterion>(i);
+        if (c != QueryWhere::CRITERION_REGION &&
+            recenterRevision_[i] != where_.revision(c))
+        {
+            covered = false;
+        }
+    }
+
+    if (!covered)
+    {
+        LOG_DEBUG(<< "Recenter select pages.");
+
+        // Select pages for a larger region. Following spheres nearby reuse
+        // this selection.
+        recenterBox_.set(x, y, z, radius * QUERY_RECENTER_MARGIN);
+
+        selectedPages_.clear();
+        editor_->datasets().selectPages(where_.dataset(),
+                                        recenterBox_,
+                                        selectedPages_);
+        selectPagesBySummary();
+        recenterPages_ = selectedPages_;
+
+        setState(Page::STATE_SELECT);
+
+        for (size_t i = 0; i < recenterRevision_.size(); i++)
+        {
+            QueryWhere::Criterion c = static_cast<QueryWhere::Criterion>(i);
+            recenterRevision_[i] = where_.revision(c);
+        }
+        recenterValid_ = true;
+    }
+    else
+    {
+        // Empty selection of a page stays empty when the page does not
+        // intersect the new sphere. Such pages are not visited.
+        selectedPages_.clear();
+
+        for (const auto &selectedPage : recenterPages_)
+        {
+            Key nk = {selectedPage.id, selectedPage.idx, 0};
+            auto search = cache_.find(nk);
+            if (search != cache_.end())
+            {
+                Page &page = *search->second->page;
+                if (maximumResults_ == 0 &&
+                    page.state() > Page::STATE_SELECT &&
+                    page.selectionSize == 0 && !page.box().intersects(box))
+                {
+                    continue;
+                }
+
+                page.setState(Page::STATE_SELECT);
+            }
+
+            selectedPages_.push_back(selectedPage);
+        }
+    }
+
+    reset();
+
+    nResults_ = 0;
+}
+
 void Query::reset()
 {
     pageIndex_ = 0;
@@ -160,11 +292,16 @@ void Query::clear()
 
     cache_.clear();
     lru_.clear();
-    lruSize_ = 0;
+    lruPinned_.clear();
+    cacheSizeInMemory_ = 0;
+    view_.clear();
 
     page_.reset();
     selectedPages_.clear();
 
+    recenterValid_ = false;
+    recenterPages_.clear();
+
     reset();
 }
 
@@ -195,6 +332,9 @@ bool Query::nextPage()
         LOG_DEBUG(<< "Current pageIndex <" << pageIndex_ << "/"
                   << selectedPages_.size() << ">.");
 
+        // Read following pages in the background.
+        prefetchSelectedPages();
+
         IndexFile::Selection &selectedPage = selectedPages_[pageIndex_];
         page_ = readPage(selectedPage.id, selectedPage.idx);
         page_->nextState();
@@ -209,6 +349,7 @@ bool Query::nextPage()
 
             // Point to current page data.
             position_ = page_->position;
+            translation_ = page_->translation();
             intensity_ = page_->intensity;
             returnNumber_ = page_->returnNumber;
             numberOfReturns_ = page_->numberOfReturns;
@@ -232,6 +373,81 @@ bool Query::nextPage()
     return false;
 }
 
+size_t Query::forEachPage(const std::function<void(Page &, size_t)> &kernel,
+                          size_t from,
+                          size_t n)
+{
+    if (maximumResults_ > 0)
+    {
+        THROW("Parallel query does not support maximum number of results.");
+    }
+
+    if (from >= selectedPages_.size())
+    {
+        return 0;
+    }
+
+    if (n > selectedPages_.size() - from)
+    {
+        n = selectedPages_.size() - from;
+    }
+
+    if (!threadPoolCreated_)
+    {
+        setNumberOfThreads(0);
+    }
+
+    // Compile the filters once before the workers read them.
+    if (where_.segmentArrayEnabled())
+    {
+        updateSegmentArray();
+    }
+
+    LOG_DEBUG(<< "Run pages from <" << from << "> count <" << n
+              << "> threads <" << threadPool_.size() << ">.");
+
+    threadPool_.run(n,
+                    [&](size_t i)
+                    {
+                        const IndexFile::Selection &selectedPage =
+                            selectedPages_[from + i];
+
+                        // Each worker has its own view to page data.
+                        Page page(editor_,
+                                  this,
+                                  static_cast<uint32_t>(selectedPage.id),
+                                  static_cast<uint32_t>(selectedPage.idx));
+                        page.readSelection();
+
+                        if (page.selectionSize > 0)
+                        {
+                            kernel(page, from + i);
+
+                            // Worker pages are not kept in the query cache,
+                            // so flush() would not see them.
+                            page.writePage();
+                        }
+                    });
+
+    return n;
+}
+
+void Query::setNumberOfThreads(size_t nThreads)
+{
+    threadPool_.create(nThreads);
+    threadPoolCreated_ = true;
+}
+
+void Query::readAttribute(PageData::Attribute attribute)
+{
+    page_->readAttribute(attribute);
+
+    segment_ = page_->segment;
+    elevation_ = page_->elevation;
+    descriptor_ = page_->descriptor;
+    voxel_ = page_->voxel;
+}
+
 size_t Query::pageSizeEstimate() const
 {
     return selectedPages_.size();
@@ -244,33 +460,45 @@ void Query::setModified()
 
 void Query::flush()
 {
-    for (size_t i = 0; i < lru_.size(); i++)
+    for (const CacheList *list : {&lru_, &lruPinned_})
     {
-        if (lru_[i]->modified())
+        for (const auto &it : *list)
         {
-            lru_[i]->writePage();
+            if (it.page->modified())
+            {
+                it.page->writePage();
+            }
         }
     }
 }
 
 void Query::setState(Page::State state)
 {
-    for (auto &it : cache_)
+    for (CacheList *list : {&lru_, &lruPinned_})
     {
-        it.second->setState(state);
+        for (auto &it : *list)
+        {
+            it.page->setState(state);
+        }
     }
 }
 
 bool Query::nextState(bool *lruL0Ready)
 {
-    LOG_DEBUG(<< "Lru size <" << lru_.size() << ">.");
+    LOG_DEBUG(<< "View size <" << view_.size() << ">.");
 
-    for (size_t i = 0; i < lru_.size(); i++)
+    for (size_t i = 0; i < view_.size(); i++)
     {
-        bool continuing = lru_[i]->nextState();
+        if (view_[i]->state() == Page::STATE_READ)
+        {
+            // Read following pages in the background.
+            prefetchView(i + 1);
+        }
+
+        bool continuing = view_[i]->nextState();
         if (continuing)
         {
-            if (lruL0Ready && lru_[i]->pageId() < 1)
+            if (lruL0Ready && view_[i]->pageId() < 1)
             {
                 *lruL0Ready = false;
             }
@@ -282,19 +510,11 @@ bool Query::nextState(bool *lruL0Ready)
     return false;
 }
 
-size_t Query::erasePageIndex(std::vector<std::shared_ptr<Page>> &queue)
+void Query::resetCacheStatistics()
 {
-    size_t idx = queue.size();
-    do
-    {
-        idx--;
-        if (queue[idx].get()->pageId() > 0)
-        {
-            break;
-        }
-    } while (idx > 0);
-
-    return (idx > 0) ? idx : queue.size() - 1;
+    cacheStatistics_.nHits = 0;
+    cacheStatistics_.nMisses = 0;
+    cacheStatistics_.nEvictions = 0;
 }
 
 double Query::distance(const Vector3<double> &eye, const Box<double> &box)
@@ -333,42 +553,24 @@ void Query::insertToQueue(std::multimap<double, Key> &queue,
     queue.insert({w, updatedKey});
 }
 
-bool Query::insertToLru(std::vector<std::shared_ptr<Page>> &lruNew,
-                        std::vector<std::shared_ptr<Page>> &lruOld,
-                        const Key &key,
-                        bool checkCacheLimit)
+bool Query::insertToView(const Key &key,
+                         bool checkCacheLimit,
+                         size_t &viewSize)
 {
     if (checkCacheLimit && cacheSizeMaximum_ > 0 &&
-        lruSize_ >= cacheSizeMaximum_)
+        viewSize >= cacheSizeMaximum_)
     {
         return false;
     }
 
-    auto search = cache_.find({key.datasetId, key.pageId});
-
-    if (search != cache_.end())
+    std::shared_ptr<Page> page = findPage(key);
+    if (!page)
     {
-        lruNew.push_back(search->second);
-    }
-    else
-    {
-        if (lruOld.size() > 0)
-        {
-            size_t eraseIndex = erasePageIndex(lruOld);
-            const Page *lru = lruOld[eraseIndex].get();
-            Key nkrm = {lru->datasetId(), lru->pageId()};
-            cache_.erase(nkrm);
-            removeAt(lruOld, eraseIndex);
-        }
-
-        std::shared_ptr<Page> page;
-        page = std::make_shared<Page>(editor_, this, key.datasetId, key.pageId);
-        cache_[key] = page;
-
-        lruNew.push_back(page);
+        page = insertPage(key);
     }
 
-    lruSize_ += key.size;
+    view_.push_back(page);
+    viewSize += key.size;
 
     return true;
 }
@@ -380,11 +582,8 @@ void Query::applyCamera(const Camera &camera)
     LOG_DEBUG_RENDER(<< "Apply camera <" << camera.eye << "> delay <"
                      << timeDelayApply << "> ms.");
 
-    std::vector<std::shared_ptr<Page>> lruOld;
-    lruOld = lru_;
-
-    lru_.clear();
-    lruSize_ = 0;
+    view_.clear();
+    size_t viewSize = 0;
 
     // Sorted by level of detail (asc); same level by distance to camera (asc).
     std::list<Key> queue;
@@ -401,7 +600,7 @@ void Query::applyCamera(const Camera &camera)
 
     for (const auto &it : queueNext)
     {
-        if (!insertToLru(lru_, lruOld, it.second, false))
+        if (!insertToView(it.second, false, viewSize))
         {
             break;
         }
@@ -434,7 +633,7 @@ void Query::applyCamera(const Camera &camera)
 
         for (const auto &it : queueNext)
         {
-            if (!insertToLru(lru_, lruOld, it.second, true))
+            if (!insertToView(it.second, true, viewSize))
             {
                 // Stop expansion. No free cache space available.
                 queue.clear();
@@ -446,6 +645,41 @@ void Query::applyCamera(const Camera &camera)
     }
 
     setState(Page::STATE_RENDER);
+
+    // Start reading pages in level of detail order.
+    prefetchView(0);
+}
+
+void Query::prefetchSelectedPages()
+{
+    size_t end = pageIndex_ + 1 + prefetchSize_;
+    if (end > selectedPages_.size())
+    {
+        end = selectedPages_.size();
+    }
+
+    for (size_t i = pageIndex_ + 1; i < end; i++)
+    {
+        const IndexFile::Selection &page = selectedPages_[i];
+        if (cache_.find({page.id, page.idx, 0}) == cache_.end())
+        {
+            editor_->prefetchPage(page.id, page.idx);
+        }
+    }
+}
+
+void Query::prefetchView(size_t from)
+{
+    size_t n = 0;
+
+    for (size_t i = from; i < view_.size() && n < prefetchSize_; i++)
+    {
+        if (view_[i]->state() == Page::STATE_READ)
+        {
+            editor_->prefetchPage(view_[i]->datasetId(), view_[i]->pageId());
+            n++;
+        }
+    }
 }
 
 // Create Z-order (Morton space filling curve), linear order of a quadtree.
@@ -728,111 +962,123 @@ bool Query::Key::operator<(const Key &rhs) const
     return pageId < rhs.pageId;
 }
 
+bool Query::Key::operator==(const Key &rhs) const
+{
+    return datasetId == rhs.datasetId && pageId == rhs.pageId;
+}
+
+size_t Query::KeyHash::operator()(const Key &key) const
+{
+    uint64_t value = (static_cast<uint64_t>(key.datasetId) << 32) ^
+                     static_cast<uint64_t>(key.pageId);
+    return std::hash<uint64_t>()(value);
+}
+
 std::shared_ptr<Page> Query::readPage(size_t datasetId, size_t pageId)
 {
-    Key nk = {datasetId, pageId};
+    Key nk = {datasetId, pageId, 0};
 
-    auto search = cache_.find(nk);
-    if (search != cache_.end())
+    std::shared_ptr<Page> result = findPage(nk);
+    if (result)
     {
-        // Move found page to top.
-        for (size_t i = 0; i < lru_.size(); i++)
-        {
-            if (lru_[i] == search->second)
-            {
-                if (i > 0)
-                {
-                    std::shared_ptr<Page> tmp = lru_[i];
-                    for (size_t j = i; j > 0; j--)
-                    {
-                        lru_[j] = lru_[j - 1];
-                    }
-                    lru_[0] = tmp;
-                }
+        return result;
+    }
 
-                break;
-            }
-        }
+    result = insertPage(nk);
 
-        return search->second;
+    try
+    {
+        LOG_DEBUG(<< "Read page ID <" << nk.pageId << ">.");
+        result->readPage();
     }
-    else
+    catch (...)
     {
-        // LRU.
-        if (lru_.size() > 0)
-        {
-            size_t idx;
+        // Error.
+    }
 
-            if (lruSize_ < cacheSizeMaximum_)
-            {
-                // Make room for new page.
-                lru_.resize(lru_.size() + 1);
-                idx = lru_.size() - 1;
-            }
-            else
-            {
-                // Drop oldest page.
-                idx = erasePageIndex(lru_);
-                if (lru_[idx]->modified())
-                {
-                    lru_[idx]->writePage();
-                }
-                Key nkrm = {lru_[idx]->datasetId(), lru_[idx]->pageId()};
-                cache_.erase(nkrm);
-
-                size_t pageSizeInMemory =
-                    PageData::sizeInMemory(lru_[idx]->size());
-                lruSize_ -= pageSizeInMemory;
-                LOG_DEBUG(<< "Drop page. Dataset ID <" << nkrm.datasetId
-                          << "> page ID <" << nkrm.pageId << "> point count <"
-                          << lru_[idx]->size() << "> page size in memory <"
-                          << pageSizeInMemory << "> LRU size in memory <"
-                          << lruSize_ << "> from maximum <" << cacheSizeMaximum_
-                          << "> bytes.");
-            }
+    return result;
+}
 
-            // New page is on top.
-            for (size_t j = idx; j > 0; j--)
-            {
-                lru_[j] = lru_[j - 1];
-            }
-        }
-        else
-        {
-            // First page is on top.
-            lru_.resize(1);
-        }
+std::shared_ptr<Page> Query::findPage(const Key &key)
+{
+    auto search = cache_.find(key);
+    if (search == cache_.end())
+    {
+        return nullptr;
+    }
 
-        std::shared_ptr<Page> result;
-        result = std::make_shared<Page>(editor_, this, nk.datasetId, nk.pageId);
-        cache_[nk] = result;
-        lru_[0] = result;
+    // Move found page to top.
+    CacheList &list = (key.pageId == 0) ? lruPinned_ : lru_;
+    list.splice(list.begin(), list, search->second);
 
-        const Dataset &dataset = editor_->datasets().key(nk.datasetId);
-        const IndexFile &index = dataset.index();
-        const IndexFile::Node *node = index.at(nk.pageId);
-
-        size_t pageSizeInMemory = PageData::sizeInMemory(node->size);
-        lruSize_ += pageSizeInMemory;
-        LOG_DEBUG(<< "Added new page. Page count <" << lru_.size()
-                  << "> dataset ID <" << nk.datasetId << "> page ID <"
-                  << nk.pageId << "> point count <" << node->size
-                  << "> page size in memory <" << pageSizeInMemory
-                  << "> LRU size in memory <" << lruSize_ << "> from maximum <"
-                  << cacheSizeMaximum_ << "> bytes.");
-
-        try
-        {
-            LOG_DEBUG(<< "Read page ID <" << nk.pageId << ">.");
-            result->readPage();
-        }
-        catch (...)
-        {
-            // Error.
-        }
+    cacheStatistics_.nHits++;
 
-        return result;
+    return search->second->page;
+}
+
+std::shared_ptr<Page> Query::insertPage(const Key &key)
+{
+    const Dataset &dataset = editor_->datasets().key(key.datasetId);
+    const IndexFile &index = dataset.index();
+    const IndexFile::Node *node = index.at(key.pageId);
+
+    size_t pageSizeInMemory = PageData::sizeInMemory(node->size);
+
+    // Make room for new page.
+    while (cacheSizeInMemory_ + pageSizeInMemory > cacheSizeMaximum_ &&
+           !cache_.empty())
+    {
+        evictPage();
     }
+
+    std::shared_ptr<Page> result;
+    result = std::make_shared<Page>(editor_,
+                                    this,
+                                    static_cast<uint32_t>(key.datasetId),
+                                    static_cast<uint32_t>(key.pageId));
+
+    // New page is on top.
+    CacheList &list = (key.pageId == 0) ? lruPinned_ : lru_;
+    list.push_front({result, pageSizeInMemory});
+    cache_[key] = list.begin();
+
+    cacheSizeInMemory_ += pageSizeInMemory;
+    cacheStatistics_.nMisses++;
+
+    LOG_DEBUG(<< "Added new page. Page count <" << cache_.size()
+              << "> dataset ID <" << key.datasetId << "> page ID <"
+              << key.pageId << "> point count <" << node->size
+              << "> page size in memory <" << pageSizeInMemory
+              << "> cache size in memory <" << cacheSizeInMemory_
+              << "> from maximum <" << cacheSizeMaximum_ << "> bytes.");
+
+    return result;
+}
+
+void Query::evictPage()
+{
+    // Drop the oldest page. Pinned pages are dropped last.
+    CacheList &list = lru_.empty() ? lruPinned_ : lru_;
+    const CacheEntry &entry = list.back();
+    Page &page = *entry.page;
+
+    if (page.modified())
+    {
+        page.writePage();
+    }
+
+    Key nk = {page.datasetId(), page.pageId(), 0};
+    cache_.erase(nk);
+
+    cacheSizeInMemory_ -= entry.size;
+    cacheStatistics_.nEvictions++;
+
+    LOG_DEBUG(<< "Drop page. Dataset ID <" << nk.datasetId << "> page ID <"
+              << nk.pageId << "> page size in memory <" << entry.size
+              << "> cache size in memory <" << cacheSizeInMemory_
+              << "> from maximum <" << cacheSizeMaximum_ << "> bytes.");
+
+    list.pop_back();
 }
 
 bool Query::mean(double &meanX, double &meanY, double &meanZ)
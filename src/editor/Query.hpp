@@ -23,12 +23,16 @@
 #define QUERY_HPP
 
 // Include std.
+#include <functional>
+#include <list>
+#include <unordered_map>
 #include <unordered_set>
 
 // Include 3D Forest.
 #include <Camera.hpp>
 #include <Page.hpp>
 #include <QueryWhere.hpp>
+#include <ThreadPool.hpp>
 class Editor;
 
 // Include local.
@@ -53,6 +57,12 @@ public:
     const QueryWhere &where() const { return where_; }
     QueryWhere &where() { return where_; }
 
+    /** Rebuild compiled segment filters when filters or lists change. */
+    void updateSegmentArray();
+
+    /** Check page summary if the page may contain matching points. */
+    bool pageIntersects(size_t datasetId, size_t pageId) const;
+
     void applyCamera(const Camera &camera);
 
     void setMaximumResults(size_t nPoints);
@@ -60,6 +70,15 @@ public:
 
     void exec();
     void exec(const std::vector<IndexFile::Selection> &selectedPages);
+
+    /** Move sphere region to a new position and execute the query.
+        Page selection of the previous re-center is reused when it covers the
+        new sphere. Only pages which may contain points of the new sphere or
+        which had some points selected are selected again. The other query
+        conditions are expected to be unchanged, otherwise the pages are
+        selected from the dataset index again.
+    */
+    void recenter(double x, double y, double z, double radius);
     void reset();
     void clear();
 
@@ -82,11 +101,28 @@ public:
 
     /** @name Point data available after next() */
     /**@{*/
-    double &x() { return position_[3 * selection_[pagePointIndex_] + 0]; }
-    double &y() { return position_[3 * selection_[pagePointIndex_] + 1]; }
-    double &z() { return position_[3 * selection_[pagePointIndex_] + 2]; }
+    double x() const
+    {
+        return position_[3 * selection_[pagePointIndex_] + 0] +
+               translation_[0];
+    }
 
-    double &intensity() { return intensity_[selection_[pagePointIndex_]]; }
+    double y() const
+    {
+        return position_[3 * selection_[pagePointIndex_] + 1] +
+               translation_[1];
+    }
+
+    double z() const
+    {
+        return position_[3 * selection_[pagePointIndex_] + 2] +
+               translation_[2];
+    }
+
+    double intensity() const
+    {
+        return intensity_[selection_[pagePointIndex_]] * (1.0 / 65535.0);
+    }
 
     uint8_t &returnNumber()
     {
@@ -107,17 +143,72 @@ public:
 
     double &gpsTime() { return gpsTime_[selection_[pagePointIndex_]]; }
 
-    double &red() { return color_[3 * selection_[pagePointIndex_] + 0]; }
-    double &green() { return color_[3 * selection_[pagePointIndex_] + 1]; }
-    double &blue() { return color_[3 * selection_[pagePointIndex_] + 2]; }
+    double red() const
+    {
+        return color_[3 * selection_[pagePointIndex_] + 0] * (1.0 / 65535.0);
+    }
+
+    double green() const
+    {
+        return color_[3 * selection_[pagePointIndex_] + 1] * (1.0 / 65535.0);
+    }
+
+    double blue() const
+    {
+        return color_[3 * selection_[pagePointIndex_] + 2] * (1.0 / 65535.0);
+    }
+
+    uint32_t &segment()
+    {
+        if (!segment_)
+        {
+            readAttribute(PageData::ATTRIBUTE_SEGMENT);
+        }
+        return segment_[selection_[pagePointIndex_]];
+    }
+
+    float &elevation()
+    {
+        if (!elevation_)
+        {
+            readAttribute(PageData::ATTRIBUTE_ELEVATION);
+        }
+        return elevation_[selection_[pagePointIndex_]];
+    }
+
+    float &descriptor()
+    {
+        if (!descriptor_)
+        {
+            readAttribute(PageData::ATTRIBUTE_DESCRIPTOR);
+        }
+        return descriptor_[selection_[pagePointIndex_]];
+    }
 
-    size_t &segment() { return segment_[selection_[pagePointIndex_]]; }
-    double &elevation() { return elevation_[selection_[pagePointIndex_]]; }
-    double &descriptor() { return descriptor_[selection_[pagePointIndex_]]; }
-    size_t &voxel() { return voxel_[selection_[pagePointIndex_]]; }
+    uint32_t &voxel()
+    {
+        if (!voxel_)
+        {
+            readAttribute(PageData::ATTRIBUTE_VOXEL);
+        }
+        return voxel_[selection_[pagePointIndex_]];
+    }
     /**@}*/
 
     bool nextPage();
+
+    /** Run 'kernel' for selected pages in parallel.
+        Pages from 'from' to 'from + n' are read and filtered by worker
+        threads. The kernel gets each page with its index in selection and
+        may modify selected points. Modified pages must call setModified().
+        Modified pages are written before this function returns, flush()
+        is not needed. Returns the number of processed pages.
+    */
+    size_t forEachPage(const std::function<void(Page &, size_t)> &kernel,
+                       size_t from = 0,
+                       size_t n = SIZE_MAX);
+
+    void setNumberOfThreads(size_t nThreads);
     Page *page() { return page_.get(); }
     size_t pageSizeEstimate() const;
 
@@ -141,8 +232,31 @@ public:
     size_t resultSize() const { return nResults_; }
     void addResults(size_t n);
 
-    size_t cacheSize() const { return lru_.size(); }
-    Page &cache(size_t index) { return *lru_[index]; }
+    /** Set number of pages which are read ahead by page loader threads. */
+    void setPrefetchSize(size_t nPages) { prefetchSize_ = nPages; }
+    size_t prefetchSize() const { return prefetchSize_; }
+
+    /** Set maximum size of cached pages in bytes. */
+    void setCacheSizeMaximum(size_t nBytes) { cacheSizeMaximum_ = nBytes; }
+    size_t cacheSizeMaximum() const { return cacheSizeMaximum_; }
+
+    /** Page Cache Statistics. */
+    struct EXPORT_EDITOR CacheStatistics
+    {
+        uint64_t nHits;
+        uint64_t nMisses;
+        uint64_t nEvictions;
+    };
+
+    const CacheStatistics &cacheStatistics() const
+    {
+        return cacheStatistics_;
+    }
+    void resetCacheStatistics();
+
+    /** Number of pages selected by applyCamera() in rendering order. */
+    size_t cacheSize() const { return view_.size(); }
+    Page &cache(size_t index) { return *view_[index]; }
 
     bool mean(double &meanX, double &meanY, double &meanZ);
 
@@ -184,22 +298,25 @@ protected:
     // Current page.
     std::shared_ptr<Page> page_;
 
-    double *position_;
-    double *intensity_;
+    int32_t *position_;
+    Vector3<double> translation_;
+    uint16_t *intensity_;
     uint8_t *returnNumber_;
     uint8_t *numberOfReturns_;
     uint8_t *classification_;
     uint8_t *userData_;
     double *gpsTime_;
-    double *color_;
+    uint16_t *color_;
 
-    size_t *segment_;
-    double *elevation_;
-    double *descriptor_;
-    size_t *voxel_;
+    uint32_t *segment_;
+    float *elevation_;
+    float *descriptor_;
+    uint32_t *voxel_;
 
     uint32_t *selection_;
 
+    void readAttribute(PageData::Attribute attribute);
+
     // Iterator.
     size_t pageIndex_;
     size_t pagePointIndex_;
@@ -214,24 +331,61 @@ protected:
         size_t size;
 
         bool operator<(const Key &rhs) const;
+        bool operator==(const Key &rhs) const;
     };
-    size_t cacheSizeMaximum_;
-    std::map<Key, std::shared_ptr<Page>> cache_;
 
-    // Last Recently Used (LRU) for Cache.
-    std::vector<std::shared_ptr<Page>> lru_;
-    size_t lruSize_;
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    struct CacheEntry
+    {
+        std::shared_ptr<Page> page;
+        size_t size;
+    };
+
+    using CacheList = std::list<CacheEntry>;
+
+    size_t cacheSizeMaximum_;
+    size_t cacheSizeInMemory_;
+    CacheStatistics cacheStatistics_;
+    std::unordered_map<Key, CacheList::iterator, KeyHash> cache_;
+
+    // Last Recently Used (LRU) for Cache. The most recently used pages are
+    // at the front. Pages of level of detail 0 are pinned, they are evicted
+    // only when there is no other page in the cache.
+    CacheList lru_;
+    CacheList lruPinned_;
+
+    // Pages selected by applyCamera() in rendering order.
+    std::vector<std::shared_ptr<Page>> view_;
+
+    // Parallel execution.
+    ThreadPool threadPool_;
+    bool threadPoolCreated_;
+
+    // Re-center.
+    bool recenterValid_;
+    Box<double> recenterBox_;
+    std::vector<IndexFile::Selection> recenterPages_;
+    std::array<uint64_t, QueryWhere::CRITERION_COUNT> recenterRevision_;
+
+    // Prefetch.
+    size_t prefetchSize_;
+    void selectPagesBySummary();
+    void prefetchSelectedPages();
+    void prefetchView(size_t from);
 
     std::shared_ptr<Page> readPage(size_t datasetId, size_t pageId);
-    size_t erasePageIndex(std::vector<std::shared_ptr<Page>> &queue);
+    std::shared_ptr<Page> findPage(const Key &key);
+    std::shared_ptr<Page> insertPage(const Key &key);
+    void evictPage();
     double distance(const Vector3<double> &eye, const Box<double> &box);
     void insertToQueue(std::multimap<double, Key> &queue,
                        const Key &key,
                        const Vector3<double> &eye);
-    bool insertToLru(std::vector<std::shared_ptr<Page>> &lruNew,
-                     std::vector<std::shared_ptr<Page>> &lruOld,
-                     const Key &key,
-                     bool checkCacheLimit);
+    bool insertToView(const Key &key, bool checkCacheLimit, size_t &viewSize);
 };
 
 void toJson(Json &out, Query &in);
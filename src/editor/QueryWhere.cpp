@@ -19,6 +19,10 @@
 
 /** @file QueryWhere.cpp */
 
+// Include std.
+#include <algorithm>
+#include <atomic>
+
 // Include 3D Forest.
 #include <QueryWhere.hpp>
 
@@ -27,8 +31,17 @@
 #define LOG_MODULE_DEBUG_ENABLED 1
 #include <Log.hpp>
 
+static std::atomic<uint64_t> queryWhereRevision(0);
+
 QueryWhere::QueryWhere()
+    : segmentArrayDefault_(1),
+      segmentArrayVersion_(0),
+      segmentArrayModified_(true)
 {
+    for (size_t i = 0; i < revision_.size(); i++)
+    {
+        setModified(static_cast<Criterion>(i));
+    }
 }
 
 QueryWhere::~QueryWhere()
@@ -48,33 +61,53 @@ void QueryWhere::clear()
     classificationArray_.clear();
     segment_.clear();
     speciesFilter_.clear();
+    managementStatusFilter_.clear();
+    segmentArray_.clear();
+    segmentArrayCount_.clear();
+    segmentArrayDefault_ = 1;
+    segmentArrayModified_ = true;
+
+    for (size_t i = 0; i < revision_.size(); i++)
+    {
+        setModified(static_cast<Criterion>(i));
+    }
+}
+
+void QueryWhere::setModified(Criterion criterion)
+{
+    revision_[criterion] = ++queryWhereRevision;
 }
 
 void QueryWhere::setDataset(const QueryFilterSet &list)
 {
     dataset_ = list;
+    setModified(CRITERION_DATASET);
 }
 
 void QueryWhere::setDataset(const std::unordered_set<size_t> &list)
 {
     dataset_.setFilter(list);
+    setModified(CRITERION_DATASET);
 }
 
 void QueryWhere::setRegion(const Region &region)
 {
     region_ = region;
+    setModified(CRITERION_REGION);
 }
 
 void QueryWhere::setBox(const Box<double> &box)
 {
     region_.box = box;
     region_.shape = Region::Shape::BOX;
+    setModified(CRITERION_REGION);
 }
 
 void QueryWhere::setCone(double x, double y, double z, double z2, double angle)
 {
     region_.cone.set(x, y, z, z2, angle);
     region_.shape = Region::Shape::CONE;
+    setModified(CRITERION_REGION);
 }
 
 void QueryWhere::setCylinder(double ax,
@@ -87,39 +120,46 @@ void QueryWhere::setCylinder(double ax,
 {
     region_.cylinder.set(ax, ay, az, bx, by, bz, radius);
     region_.shape = Region::Shape::CYLINDER;
+    setModified(CRITERION_REGION);
 }
 
 void QueryWhere::setSphere(double x, double y, double z, double radius)
 {
     region_.sphere.set(x, y, z, radius);
     region_.shape = Region::Shape::SPHERE;
+    setModified(CRITERION_REGION);
 }
 
 void QueryWhere::setElevation(const Range<double> &elevation)
 {
     elevation_ = elevation;
+    setModified(CRITERION_ELEVATION);
 }
 
 void QueryWhere::setDescriptor(const Range<double> &descriptor)
 {
     descriptor_ = descriptor;
+    setModified(CRITERION_DESCRIPTOR);
 }
 
 void QueryWhere::setIntensity(const Range<double> &intensity)
 {
     intensity_ = intensity;
+    setModified(CRITERION_INTENSITY);
 }
 
 void QueryWhere::setClassification(const QueryFilterSet &list)
 {
     classification_ = list;
     classificationsToArray();
+    setModified(CRITERION_CLASSIFICATION);
 }
 
 void QueryWhere::setClassification(const std::unordered_set<size_t> &list)
 {
     classification_.setFilter(list);
     classificationsToArray();
+    setModified(CRITERION_CLASSIFICATION);
 }
 
 void QueryWhere::classificationsToArray()
@@ -143,29 +183,185 @@ void QueryWhere::classificationsToArray()
 void QueryWhere::setSegment(const QueryFilterSet &list)
 {
     segment_ = list;
+    segmentArrayModified_ = true;
+    setModified(CRITERION_SEGMENT);
 }
 
 void QueryWhere::setSegment(const std::unordered_set<size_t> &list)
 {
     segment_.setFilter(list);
+    segmentArrayModified_ = true;
+    setModified(CRITERION_SEGMENT);
 }
 
 void QueryWhere::setSpecies(const QueryFilterSet &list)
 {
     speciesFilter_ = list;
+    segmentArrayModified_ = true;
+    setModified(CRITERION_SEGMENT);
 }
 
 void QueryWhere::setSpecies(const std::unordered_set<size_t> &list)
 {
     speciesFilter_.setFilter(list);
+    segmentArrayModified_ = true;
+    setModified(CRITERION_SEGMENT);
 }
 
 void QueryWhere::setManagementStatus(const QueryFilterSet &list)
 {
     managementStatusFilter_ = list;
+    segmentArrayModified_ = true;
+    setModified(CRITERION_SEGMENT);
 }
 
 void QueryWhere::setManagementStatus(const std::unordered_set<size_t> &list)
 {
     managementStatusFilter_.setFilter(list);
+    segmentArrayModified_ = true;
+    setModified(CRITERION_SEGMENT);
+}
+
+void QueryWhere::updateSegmentArray(
+    const Segments &segments,
+    const SpeciesList &speciesList,
+    const ManagementStatusList &managementStatusList,
+    size_t version)
+{
+    if (!segmentArrayModified_ && segmentArrayVersion_ == version)
+    {
+        return;
+    }
+
+    bool segmentEnabled = !segment_.matchesAll();
+    bool speciesEnabled = !speciesFilter_.matchesAll();
+    bool statusEnabled = !managementStatusFilter_.matchesAll();
+
+    // Points from unknown segments pass segment filter, but they have no
+    // species and no management status.
+    segmentArrayDefault_ = (speciesEnabled || statusEnabled) ? 0 : 1;
+
+    size_t idMax = 0;
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        idMax = std::max(idMax, segments[i].id);
+    }
+
+    segmentArray_.resize(0);
+    segmentArray_.resize(idMax + 1, segmentArrayDefault_);
+
+    const std::unordered_set<size_t> &segmentFilter = segment_.filter();
+    const std::unordered_set<size_t> &speciesFilter = speciesFilter_.filter();
+    const std::unordered_set<size_t> &statusFilter =
+        managementStatusFilter_.filter();
+
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        const Segment &segment = segments[i];
+        uint8_t value = 1;
+
+        if (segmentEnabled && segmentFilter.count(segment.id) == 0)
+        {
+            value = 0;
+        }
+
+        if (speciesEnabled &&
+            speciesFilter.count(segment.speciesId) == 0 &&
+            speciesList.contains(segment.speciesId))
+        {
+            value = 0;
+        }
+
+        if (statusEnabled &&
+            statusFilter.count(segment.managementStatusId) == 0 &&
+            managementStatusList.contains(segment.managementStatusId))
+        {
+            value = 0;
+        }
+
+        segmentArray_[segment.id] = value;
+    }
+
+    // Number of passing segment identifiers below each identifier.
+    segmentArrayCount_.resize(segmentArray_.size() + 1);
+    segmentArrayCount_[0] = 0;
+    for (size_t i = 0; i < segmentArray_.size(); i++)
+    {
+        segmentArrayCount_[i + 1] = segmentArrayCount_[i] + segmentArray_[i];
+    }
+
+    segmentArrayVersion_ = version;
+    segmentArrayModified_ = false;
+    setModified(CRITERION_SEGMENT);
+
+    LOG_DEBUG_UPDATE(<< "Segment array size <" << segmentArray_.size() << ">.");
+}
+
+bool QueryWhere::segmentArrayContains(size_t segmentMin,
+                                      size_t segmentMax) const
+{
+    if (segmentMax >= segmentArray_.size() && segmentArrayDefault_)
+    {
+        return true;
+    }
+
+    if (segmentMin >= segmentArray_.size())
+    {
+        return false;
+    }
+
+    segmentMax = std::min(segmentMax, segmentArray_.size() - 1);
+
+    return segmentArrayCount_[segmentMax + 1] > segmentArrayCount_[segmentMin];
+}
+
+bool QueryWhere::intersects(const PageSummary &summary) const
+{
+    if (summary.empty())
+    {
+        return true;
+    }
+
+    if (!elevation_.full() &&
+        (summary.elevationMax < elevation_.minimumValue() ||
+         summary.elevationMin > elevation_.maximumValue()))
+    {
+        return false;
+    }
+
+    if (!descriptor_.full() &&
+        (summary.descriptorMax < descriptor_.minimumValue() ||
+         summary.descriptorMin > descriptor_.maximumValue()))
+    {
+        return false;
+    }
+
+    if (!intensity_.full() &&
+        (summary.intensityMax / 65535.0 < intensity_.minimumValue() ||
+         summary.intensityMin / 65535.0 > intensity_.maximumValue()))
+    {
+        return false;
+    }
+
+    if (!classification_.matchesAll())
+    {
+        bool found = false;
+        for (size_t i = 0; i < classificationArray_.size() && !found; i++)
+        {
+            found = classificationArray_[i] && summary.hasClassification(i);
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+    }
+
+    if (segmentArrayEnabled() &&
+        !segmentArrayContains(summary.segmentMin, summary.segmentMax))
+    {
+        return false;
+    }
+
+    return true;
 }
@@ -23,12 +23,17 @@
 #define QUERY_WHERE_HPP
 
 // Include std.
+#include <array>
 #include <unordered_set>
 
 // Include 3D Forest.
+#include <ManagementStatusList.hpp>
+#include <PageSummary.hpp>
 #include <QueryFilterSet.hpp>
 #include <Range.hpp>
 #include <Region.hpp>
+#include <Segments.hpp>
+#include <SpeciesList.hpp>
 
 // Include local.
 #include <ExportEditor.hpp>
@@ -38,6 +43,19 @@
 class EXPORT_EDITOR QueryWhere
 {
 public:
+    /** Query Where Criterion. */
+    enum Criterion
+    {
+        CRITERION_REGION,
+        CRITERION_DATASET,
+        CRITERION_ELEVATION,
+        CRITERION_DESCRIPTOR,
+        CRITERION_INTENSITY,
+        CRITERION_CLASSIFICATION,
+        CRITERION_SEGMENT,
+        CRITERION_COUNT
+    };
+
     QueryWhere();
     ~QueryWhere();
 
@@ -100,6 +118,55 @@ public:
         return managementStatusFilter_;
     }
 
+    /** Compile segment, species and management status filters.
+        The filters are folded into a single lookup table indexed by segment
+        identifier. The table is rebuilt only when one of these filters
+        changes or when the lists have different version.
+    */
+    void updateSegmentArray(const Segments &segments,
+                            const SpeciesList &speciesList,
+                            const ManagementStatusList &managementStatusList,
+                            size_t version);
+
+    /** Check if segment, species or management status filter is active. */
+    bool segmentArrayEnabled() const
+    {
+        return !segment_.matchesAll() || !speciesFilter_.matchesAll() ||
+               !managementStatusFilter_.matchesAll();
+    }
+
+    /** Check if points with given segment identifier pass the filters. */
+    bool segmentArrayContains(size_t segmentId) const
+    {
+        if (segmentId < segmentArray_.size())
+        {
+            return segmentArray_[segmentId] != 0;
+        }
+        return segmentArrayDefault_ != 0;
+    }
+
+    /** Check if any segment identifier from given range passes the filters.
+     */
+    bool segmentArrayContains(size_t segmentMin, size_t segmentMax) const;
+
+    const std::vector<uint8_t> &segmentArray() const { return segmentArray_; }
+    uint8_t segmentArrayDefault() const { return segmentArrayDefault_; }
+
+    /** Check if a page with given summary may contain matching points.
+        Only attribute filters are tested. Compiled segment filters must be
+        up to date.
+    */
+    bool intersects(const PageSummary &summary) const;
+
+    /** Revision of given criterion.
+        Revisions are unique across all instances. Copies of this object
+        share revisions of criteria which were not changed since the copy.
+    */
+    uint64_t revision(Criterion criterion) const
+    {
+        return revision_[criterion];
+    }
+
 private:
     Region region_;
     Range<double> elevation_;
@@ -111,6 +178,14 @@ private:
     QueryFilterSet segment_;
     QueryFilterSet speciesFilter_;
     QueryFilterSet managementStatusFilter_;
+    std::vector<uint8_t> segmentArray_;
+    std::vector<uint32_t> segmentArrayCount_;
+    uint8_t segmentArrayDefault_;
+    size_t segmentArrayVersion_;
+    bool segmentArrayModified_;
+    std::array<uint64_t, CRITERION_COUNT> revision_;
+
+    void setModified(Criterion criterion);
 
     void classificationsToArray();
 };
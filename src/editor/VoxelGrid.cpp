@@ -0,0 +1,281 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file VoxelGrid.cpp */
+
+// Include std.
+#include <algorithm>
+#include <cmath>
+
+// Include 3D Forest.
+#include <Editor.hpp>
+#include <VoxelGrid.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "VoxelGrid"
+#include <Log.hpp>
+
+bool VoxelGrid::Key::operator==(const Key &rhs) const
+{
+    return cell[0] == rhs.cell[0] && cell[1] == rhs.cell[1] &&
+           cell[2] == rhs.cell[2] && group == rhs.group;
+}
+
+size_t VoxelGrid::KeyHash::operator()(const Key &key) const
+{
+    // Spatial hash with large primes.
+    size_t h = static_cast<size_t>(static_cast<uint32_t>(key.cell[0]));
+    h = h * 73856093U ^ static_cast<uint32_t>(key.cell[1]) * 19349663U;
+    h = h ^ static_cast<size_t>(static_cast<uint32_t>(key.cell[2])) * 83492791U;
+    return h ^ (key.group * 2654435761U);
+}
+
+VoxelGrid::VoxelGrid(Editor *editor)
+    : query_(editor),
+      elevation_(false),
+      descriptor_(false),
+      voxelSize_(1.0),
+      pageIndex_(0),
+      nPoints_(0)
+{
+}
+
+void VoxelGrid::clear()
+{
+    query_.clear();
+
+    pageIndex_ = 0;
+    nPoints_ = 0;
+    grid_.index.clear();
+    grid_.voxels.clear();
+    partialGrids_.clear();
+}
+
+void VoxelGrid::setAttributes(
+    const std::vector<PageData::Attribute> &attributes)
+{
+    attributes_ = attributes;
+
+    elevation_ = std::find(attributes_.begin(),
+                           attributes_.end(),
+                           PageData::ATTRIBUTE_ELEVATION) != attributes_.end();
+
+    descriptor_ =
+        std::find(attributes_.begin(),
+                  attributes_.end(),
+                  PageData::ATTRIBUTE_DESCRIPTOR) != attributes_.end();
+}
+
+void VoxelGrid::start(const QueryWhere &where,
+                      double voxelSize,
+                      const Vector3<double> &origin,
+                      const GroupFunction &group)
+{
+    LOG_DEBUG(<< "Start with voxel size <" << voxelSize << ">.");
+
+    if (!(voxelSize > 0))
+    {
+        THROW("Voxel size must be positive");
+    }
+
+    clear();
+
+    voxelSize_ = voxelSize;
+    origin_ = origin;
+    group_ = group;
+
+    query_.setWhere(where);
+    query_.exec();
+}
+
+size_t VoxelGrid::next(size_t nPages)
+{
+    if (end())
+    {
+        return 0;
+    }
+
+    size_t n = std::min(query_.pageSizeEstimate() - pageIndex_, nPages);
+
+    // Bin each page into its own partial grid.
+    partialGrids_.resize(n);
+    std::vector<uint64_t> nPoints(n, 0);
+    size_t from = pageIndex_;
+
+    pageIndex_ += query_.forEachPage(
+        [&](Page &page, size_t pageIndex)
+        {
+            Grid &grid = partialGrids_[pageIndex - from];
+            binPage(grid, page);
+            nPoints[pageIndex - from] = page.selectionSize;
+        },
+        from,
+        n);
+
+    // Merge partial grids in page order.
+    for (size_t i = 0; i < n; i++)
+    {
+        merge(partialGrids_[i]);
+        partialGrids_[i].index.clear();
+        partialGrids_[i].voxels.clear();
+        nPoints_ += nPoints[i];
+    }
+
+    if (end())
+    {
+        finish();
+    }
+
+    return n;
+}
+
+size_t VoxelGrid::index(double x, double y, double z, size_t group) const
+{
+    Key key;
+    cell(key.cell, x, y, z);
+    key.group = group;
+
+    auto it = grid_.index.find(key);
+    if (it == grid_.index.end())
+    {
+        return SIZE_MAX;
+    }
+
+    return it->second;
+}
+
+void VoxelGrid::binPage(Grid &grid, Page &page)
+{
+    for (const auto &attribute : attributes_)
+    {
+        page.readAttribute(attribute);
+    }
+
+    for (size_t i = 0; i < page.selectionSize; i++)
+    {
+        size_t row = page.selection[i];
+
+        Key key;
+        key.group = group_ ? group_(page, row) : 0;
+        if (key.group == SIZE_MAX)
+        {
+            continue;
+        }
+
+        double x = page.x(row);
+        double y = page.y(row);
+        double z = page.z(row);
+        cell(key.cell, x, y, z);
+
+        // Sums are divided by the number of points when the pass finishes.
+        auto it = grid.index.find(key);
+        if (it == grid.index.end())
+        {
+            Voxel voxel;
+            voxel.cell[0] = key.cell[0];
+            voxel.cell[1] = key.cell[1];
+            voxel.cell[2] = key.cell[2];
+            voxel.group = key.group;
+            voxel.n = 0;
+            voxel.x = 0;
+            voxel.y = 0;
+            voxel.z = 0;
+            voxel.elevation = 0;
+            voxel.descriptor = 0;
+            voxel.intensity = 0;
+
+            it = grid.index.emplace(key, grid.voxels.size()).first;
+            grid.voxels.push_back(voxel);
+        }
+
+        Voxel &voxel = grid.voxels[it->second];
+        voxel.n++;
+        voxel.x += x;
+        voxel.y += y;
+        voxel.z += z;
+
+        if (elevation_)
+        {
+            voxel.elevation += page.elevation[row];
+        }
+
+        if (descriptor_)
+        {
+            voxel.descriptor =
+                std::max(voxel.descriptor,
+                         static_cast<double>(page.descriptor[row]));
+        }
+
+        voxel.intensity = std::max(voxel.intensity, page.intensity[row]);
+    }
+}
+
+void VoxelGrid::merge(const Grid &grid)
+{
+    for (const Voxel &src : grid.voxels)
+    {
+        Key key;
+        key.cell[0] = src.cell[0];
+        key.cell[1] = src.cell[1];
+        key.cell[2] = src.cell[2];
+        key.group = src.group;
+
+        auto it = grid_.index.find(key);
+        if (it == grid_.index.end())
+        {
+            grid_.index.emplace(key, grid_.voxels.size());
+            grid_.voxels.push_back(src);
+            continue;
+        }
+
+        Voxel &dst = grid_.voxels[it->second];
+        dst.n += src.n;
+        dst.x += src.x;
+        dst.y += src.y;
+        dst.z += src.z;
+        dst.elevation += src.elevation;
+        dst.descriptor = std::max(dst.descriptor, src.descriptor);
+        dst.intensity = std::max(dst.intensity, src.intensity);
+    }
+}
+
+void VoxelGrid::finish()
+{
+    for (Voxel &voxel : grid_.voxels)
+    {
+        double n = static_cast<double>(voxel.n);
+        voxel.x /= n;
+        voxel.y /= n;
+        voxel.z /= n;
+        voxel.elevation /= n;
+    }
+
+    partialGrids_.clear();
+
+    LOG_DEBUG(<< "Created <" << grid_.voxels.size() << "> voxels from <"
+              << nPoints_ << "> points.");
+}
+
+void VoxelGrid::cell(int32_t *result, double x, double y, double z) const
+{
+    result[0] = static_cast<int32_t>(std::floor((x - origin_[0]) / voxelSize_));
+    result[1] = static_cast<int32_t>(std::floor((y - origin_[1]) / voxelSize_));
+    result[2] = static_cast<int32_t>(std::floor((z - origin_[2]) / voxelSize_));
+}
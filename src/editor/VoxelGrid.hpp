@@ -0,0 +1,159 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file VoxelGrid.hpp */
+
+#ifndef VOXEL_GRID_HPP
+#define VOXEL_GRID_HPP
+
+// Include std.
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Include 3D Forest.
+#include <Query.hpp>
+#include <Vector3.hpp>
+class Editor;
+
+// Include local.
+#include <ExportEditor.hpp>
+#include <WarningsDisable.hpp>
+
+/** Voxel Grid.
+
+    Streaming voxelization of filtered points. Points are binned into a
+    sparse grid of cubic cells in one pass over the selected pages. Pages are
+    binned in parallel into partial grids which are merged in page order, so
+    the voxel order does not depend on the number of threads.
+
+    Points can be split into groups, e.g. by segment. A voxel is then a pair
+    of a grid cell and a group. Use next() until end() to run the pass.
+*/
+class EXPORT_EDITOR VoxelGrid
+{
+public:
+    /** Voxel Grid Voxel. */
+    struct EXPORT_EDITOR Voxel
+    {
+        /** Grid cell coordinates. */
+        int32_t cell[3];
+
+        /** Group of points. */
+        size_t group;
+
+        /** Number of points. */
+        uint64_t n;
+
+        /** Centroid. */
+        double x;
+        double y;
+        double z;
+
+        /** Mean elevation. */
+        double elevation;
+
+        /** Maximal descriptor and intensity. */
+        double descriptor;
+        uint16_t intensity;
+    };
+
+    /** Group of the given point. Points in group SIZE_MAX are skipped. */
+    using GroupFunction = std::function<size_t(const Page &, size_t)>;
+
+    VoxelGrid(Editor *editor);
+
+    void clear();
+
+    /** Set voxel attributes to be read from pages, e.g. elevation. */
+    void setAttributes(const std::vector<PageData::Attribute> &attributes);
+
+    /** Start new voxelization of points selected by where. */
+    void start(const QueryWhere &where,
+               double voxelSize,
+               const Vector3<double> &origin,
+               const GroupFunction &group = nullptr);
+
+    /** Bin next pages. Returns the number of processed pages. */
+    size_t next(size_t nPages = SIZE_MAX);
+    bool end() const { return pageIndex_ >= query_.pageSizeEstimate(); }
+
+    /** Number of processed points. */
+    uint64_t nPoints() const { return nPoints_; }
+
+    size_t size() const { return grid_.voxels.size(); }
+    const Voxel &operator[](size_t pos) const { return grid_.voxels[pos]; }
+    const Voxel &at(size_t pos) const { return grid_.voxels.at(pos); }
+
+    /** Index of voxel with the given point. Returns SIZE_MAX if not found. */
+    size_t index(double x, double y, double z, size_t group = 0) const;
+
+    double voxelSize() const { return voxelSize_; }
+    const Vector3<double> &origin() const { return origin_; }
+
+private:
+    /** Voxel Grid Key. */
+    struct Key
+    {
+        int32_t cell[3];
+        size_t group;
+
+        bool operator==(const Key &rhs) const;
+    };
+
+    /** Voxel Grid Key Hash. */
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    /** Voxel Grid Partial Grid. */
+    struct Grid
+    {
+        std::unordered_map<Key, size_t, KeyHash> index;
+        std::vector<Voxel> voxels;
+    };
+
+    Query query_;
+
+    std::vector<PageData::Attribute> attributes_;
+    bool elevation_;
+    bool descriptor_;
+
+    double voxelSize_;
+    Vector3<double> origin_;
+    GroupFunction group_;
+
+    size_t pageIndex_;
+    uint64_t nPoints_;
+    Grid grid_;
+
+    // Buffers.
+    std::vector<Grid> partialGrids_;
+
+    void binPage(Grid &grid, Page &page);
+    void merge(const Grid &grid);
+    void finish();
+    void cell(int32_t *result, double x, double y, double z) const;
+};
+
+#include <WarningsEnable.hpp>
+
+#endif /* VOXEL_GRID_HPP */
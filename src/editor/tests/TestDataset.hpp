@@ -0,0 +1,133 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file TestDataset.hpp */
+
+#ifndef TEST_DATASET_HPP
+#define TEST_DATASET_HPP
+
+// Include std.
+#include <cstring>
+#include <vector>
+
+// Include 3D Forest.
+#include <Editor.hpp>
+#include <IndexFileBuilder.hpp>
+#include <LasFile.hpp>
+#include <Query.hpp>
+
+#define TEST_DATASET_PATH "test.las"
+
+/** Create 'n' points with all values set to zero. */
+inline std::vector<LasFile::Point> testDatasetPoints(size_t n)
+{
+    std::vector<LasFile::Point> points;
+    points.resize(n);
+    std::memset(points.data(), 0, sizeof(LasFile::Point) * points.size());
+    return points;
+}
+
+/** Create 'n' points in rows of 100 points, z is the point index. */
+inline std::vector<LasFile::Point> testDatasetRows(size_t n)
+{
+    std::vector<LasFile::Point> points = testDatasetPoints(n);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].x = static_cast<int32_t>(i % 100);
+        points[i].y = static_cast<int32_t>(i / 100);
+        points[i].z = static_cast<int32_t>(i);
+    }
+
+    return points;
+}
+
+/** Create 'n' points in layers of 20 x 20 points spaced by 10. */
+inline std::vector<LasFile::Point> testDatasetGrid(size_t n)
+{
+    std::vector<LasFile::Point> points = testDatasetPoints(n);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].x = static_cast<int32_t>(i % 20) * 10;
+        points[i].y = static_cast<int32_t>((i / 20) % 20) * 10;
+        points[i].z = static_cast<int32_t>(i / 400) * 10;
+    }
+
+    return points;
+}
+
+/** Create 'n' points at repeatable random positions in [0, 1000). */
+inline std::vector<LasFile::Point> testDatasetRandom(size_t n)
+{
+    std::vector<LasFile::Point> points = testDatasetPoints(n);
+
+    uint32_t seed = 1;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        seed = seed * 1103515245U + 12345U;
+        points[i].x = static_cast<int32_t>((seed >> 8) % 1000U);
+        seed = seed * 1103515245U + 12345U;
+        points[i].y = static_cast<int32_t>((seed >> 8) % 1000U);
+        seed = seed * 1103515245U + 12345U;
+        points[i].z = static_cast<int32_t>((seed >> 8) % 1000U);
+    }
+
+    return points;
+}
+
+/** Write 'points' to the test LAS file and create its index. */
+inline void testDatasetCreate(const std::vector<LasFile::Point> &points,
+                              const ImportSettings &settings = {},
+                              uint8_t versionMinor = 0)
+{
+    LasFile::create(TEST_DATASET_PATH,
+                    points,
+                    {1, 1, 1},
+                    {0, 0, 0},
+                    versionMinor);
+
+    IndexFileBuilder::index(TEST_DATASET_PATH, TEST_DATASET_PATH, settings);
+}
+
+/** Create the test dataset from 'points' and open it in 'editor'. */
+inline void testDatasetOpen(Editor &editor,
+                            const std::vector<LasFile::Point> &points,
+                            const ImportSettings &settings = {})
+{
+    testDatasetCreate(points, settings);
+    editor.open(TEST_DATASET_PATH);
+}
+
+/** Execute 'query' and return the number of selected points. */
+inline size_t testDatasetCount(Query &query)
+{
+    query.exec();
+
+    size_t n = 0;
+    while (query.next())
+    {
+        n++;
+    }
+
+    return n;
+}
+
+#endif /* TEST_DATASET_HPP */
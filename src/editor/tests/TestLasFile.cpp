@@ -69,7 +69,7 @@ TEST_CASE(TestLasFileCreateV10)
     points[2].segment = 1;
     points[2].elevation = 90;
     points[2].descriptor = 0.25;
-    points[2].voxel = SIZE_MAX;
+    points[2].voxel = UINT32_MAX;
 
     LasFile::create(TEST_LAS_FILE_PATH, points, {1, 1, 1}, {0, 0, 0}, 0);
 
@@ -90,7 +90,7 @@ TEST_CASE(TestLasFileCreateV10)
         TEST(query.next() && query.classification() == 0 && query.voxel() == 0);
         TEST(query.next() && query.classification() == 2 && query.voxel() == 1);
         TEST(query.next() && query.classification() == 3 &&
-             query.voxel() == SIZE_MAX);
+             query.voxel() == UINT32_MAX);
     }
 
     // Modify the test file.
@@ -104,7 +104,7 @@ TEST_CASE(TestLasFileCreateV10)
         query.exec();
 
         TEST(query.next() && (query.classification() = 6) &&
-             (query.voxel() = SIZE_MAX));
+             (query.voxel() = UINT32_MAX));
         TEST(query.next());
         TEST(query.next() && (query.classification() = 5) &&
              (query.voxel() = 2));
@@ -124,7 +124,7 @@ TEST_CASE(TestLasFileCreateV10)
         query.exec();
 
         TEST(query.next() && query.classification() == 6 &&
-             query.voxel() == SIZE_MAX);
+             query.voxel() == UINT32_MAX);
         TEST(query.next() && query.classification() == 2 && query.voxel() == 1);
         TEST(query.next() && query.classification() == 5 && query.voxel() == 2);
     }
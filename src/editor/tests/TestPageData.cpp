@@ -0,0 +1,110 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file TestPageData.cpp */
+
+// Include 3D Forest.
+#include <File.hpp>
+#include <PageData.hpp>
+#include <Test.hpp>
+#include <TestDataset.hpp>
+
+TEST_CASE(TestPageDataReadFromOpenFiles)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetPoints(3);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].x = static_cast<int32_t>(i * 100);
+        points[i].voxel = i;
+    }
+
+    testDatasetCreate(points);
+
+    // Read all pages.
+    // Expected : pages are read from files opened with the dataset.
+    Editor editor;
+    editor.open(TEST_DATASET_PATH);
+
+    File::resetStatistics();
+
+    Query query(&editor);
+    query.where().setBox(Box<double>(-500., 500.));
+    query.exec();
+
+    size_t n = 0;
+    while (query.next())
+    {
+        n++;
+    }
+
+    TEST(n == points.size());
+    TEST(File::statistics().nOpen == 0);
+    TEST(File::statistics().nClose == 0);
+}
+
+TEST_CASE(TestPageDataReadAttributesOnDemand)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetPoints(3);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].x = static_cast<int32_t>(i * 100);
+        points[i].segment = static_cast<uint32_t>(i + 1);
+    }
+
+    Editor editor;
+    testDatasetOpen(editor, points);
+
+    // Read only point coordinates.
+    // Expected : 3D Forest attributes are not read.
+    PageData::resetStatistics();
+
+    Query query(&editor);
+    query.where().setBox(Box<double>(-500., 500.));
+    query.exec();
+
+    size_t n = 0;
+    while (query.next())
+    {
+        TEST(query.x() < 500.);
+        n++;
+    }
+
+    TEST(n == points.size());
+    TEST(PageData::statistics().nSegment == 0);
+    TEST(PageData::statistics().nElevation == 0);
+    TEST(PageData::statistics().nDescriptor == 0);
+    TEST(PageData::statistics().nVoxel == 0);
+
+    // Read segments.
+    // Expected : only segment attribute is read.
+    query.exec();
+
+    while (query.next())
+    {
+        size_t i = static_cast<size_t>(query.x()) / 100;
+        TEST(query.segment() == i + 1);
+    }
+
+    TEST(PageData::statistics().nSegment > 0);
+    TEST(PageData::statistics().nElevation == 0);
+}
@@ -0,0 +1,238 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file TestPageFile.cpp */
+
+// Include 3D Forest.
+#include <File.hpp>
+#include <IndexFileBuilder.hpp>
+#include <PageFile.hpp>
+#include <Test.hpp>
+#include <TestDataset.hpp>
+#include <Util.hpp>
+
+#define TEST_PAGE_FILE_PATH "test.pages"
+
+static std::vector<uint8_t> testPageFileData(size_t n, uint32_t seed)
+{
+    // Random bytes are not compressed, so the block size follows n.
+    std::vector<uint8_t> data(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        seed = seed * 1103515245U + 12345U;
+        data[i] = static_cast<uint8_t>(seed >> 16);
+    }
+
+    return data;
+}
+
+static void testPageFileWrite(PageFile &file,
+                              uint64_t page,
+                              const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> block;
+    PageFile::compress(block, data, data.size());
+    file.write(page, block);
+}
+
+static bool testPageFileRead(PageFile &file,
+                             uint64_t page,
+                             const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> out;
+    uint64_t nPoints;
+    file.read(page, out, nPoints);
+    return nPoints == data.size() && out == data;
+}
+
+static uint64_t testPageFileSize()
+{
+    File file;
+    file.open(TEST_PAGE_FILE_PATH);
+    return file.size();
+}
+
+TEST_CASE(TestPageFileRewrite)
+{
+    std::vector<std::vector<uint8_t>> data;
+    data.push_back(testPageFileData(1000, 1));
+    data.push_back(testPageFileData(1000, 2));
+    data.push_back(testPageFileData(1000, 3));
+
+    PageFile file;
+    file.create(TEST_PAGE_FILE_PATH, data.size(), 0);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        testPageFileWrite(file, i, data[i]);
+    }
+
+    uint64_t size = testPageFileSize();
+
+    // Write the same pages many times with changing sizes.
+    // Expected : the file grows at most by one moved block.
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        size_t page = i % 2;
+        data[page] = testPageFileData(500 + (i % 5) * 250, i);
+        testPageFileWrite(file, page, data[page]);
+    }
+
+    TEST(file.unusedSize() > 0);
+    TEST(testPageFileSize() < size + 1600);
+
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        TEST(testPageFileRead(file, i, data[i]));
+    }
+
+    // Shrink pages. Close compacts the file.
+    data[0] = testPageFileData(500, 101);
+    data[1] = testPageFileData(500, 102);
+    testPageFileWrite(file, 0, data[0]);
+    testPageFileWrite(file, 1, data[1]);
+
+    file.close();
+    uint64_t sizeCompact = testPageFileSize();
+    TEST(sizeCompact < size);
+
+    file.open(TEST_PAGE_FILE_PATH);
+    TEST(file.unusedSize() == 0);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        TEST(testPageFileRead(file, i, data[i]));
+    }
+}
+
+TEST_CASE(TestPageFileCompressedPages)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetPoints(3);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].format = 7;
+        points[i].x = static_cast<int32_t>(i * 100);
+        points[i].y = -static_cast<int32_t>(i * 10);
+        points[i].z = static_cast<int32_t>(i);
+        points[i].intensity = static_cast<uint16_t>(i * 1000);
+        points[i].red = 65535;
+        points[i].classification = LasFile::CLASS_UNASSIGNED;
+        points[i].segment = static_cast<uint32_t>(i + 1);
+        points[i].voxel = i;
+    }
+
+    // Create LAS file index with compressed pages.
+    ImportSettings settings;
+    settings.randomizePoints = false;
+    settings.compressPages = true;
+    testDatasetCreate(points, settings, 7);
+    TEST(File::exists(PageFile::extension(TEST_DATASET_PATH)));
+
+    // Read the test file and modify it.
+    // Expected : obtain the same values which were used to create the file.
+    {
+        Editor editor;
+        editor.open(TEST_DATASET_PATH);
+        TEST(editor.datasets().at(0).pageFile() != nullptr);
+
+        Query query(&editor);
+        query.where().setBox(Box<double>(-500., 500.));
+        query.exec();
+
+        for (size_t k = 0; k < points.size(); k++)
+        {
+            // Points are sorted by page octree.
+            TEST(query.next());
+            size_t i = static_cast<size_t>(query.z());
+            TEST(i < points.size());
+            TEST(equal(query.x(), static_cast<double>(points[i].x)));
+            TEST(equal(query.y(), static_cast<double>(points[i].y)));
+            TEST(equal(query.z(), static_cast<double>(points[i].z)));
+            TEST(equal(query.intensity(), points[i].intensity / 65535.0));
+            TEST(equal(query.red(), 1.0) && equal(query.green(), 0.0));
+            TEST(query.segment() == i + 1 && query.voxel() == i);
+            query.classification() = LasFile::CLASS_GROUND;
+        }
+
+        query.setModified();
+        query.flush();
+    }
+
+    // Read modified values.
+    // Expected : compressed pages are updated together with the file.
+    {
+        Editor editor;
+        editor.open(TEST_DATASET_PATH);
+
+        Query query(&editor);
+        query.where().setBox(Box<double>(-500., 500.));
+        query.exec();
+
+        for (size_t k = 0; k < points.size(); k++)
+        {
+            TEST(query.next());
+            size_t i = static_cast<size_t>(query.z());
+            TEST(i < points.size());
+            TEST(query.classification() == LasFile::CLASS_GROUND);
+            TEST(query.segment() == i + 1 && query.voxel() == i);
+        }
+    }
+
+    // Damage the page file header.
+    const std::string pathPages = PageFile::extension(TEST_DATASET_PATH);
+    uint64_t pagesSize;
+    {
+        File file;
+        file.open(pathPages, "r+");
+        pagesSize = file.size();
+        uint8_t signature = 0;
+        file.write(&signature, 1);
+    }
+
+    // Read the test file with the damaged page file.
+    // Expected : points are read from LAS file and page file is not changed.
+    {
+        Editor editor;
+        editor.open(TEST_DATASET_PATH);
+        TEST(editor.datasets().at(0).pageFile() == nullptr);
+
+        Query query(&editor);
+        query.where().setBox(Box<double>(-500., 500.));
+        query.exec();
+
+        for (size_t k = 0; k < points.size(); k++)
+        {
+            TEST(query.next());
+            TEST(query.classification() == LasFile::CLASS_GROUND);
+        }
+    }
+
+    {
+        File file;
+        file.open(pathPages);
+        TEST(file.size() == pagesSize);
+    }
+
+    // Create LAS file index without compressed pages.
+    // Expected : outdated compressed pages are removed.
+    settings.compressPages = false;
+    IndexFileBuilder::index(TEST_DATASET_PATH, TEST_DATASET_PATH, settings);
+    TEST(!File::exists(PageFile::extension(TEST_DATASET_PATH)));
+}
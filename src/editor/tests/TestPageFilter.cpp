@@ -0,0 +1,149 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file TestPageFilter.cpp */
+
+// Include std.
+#include <random>
+
+// Include 3D Forest.
+#include <PageFilter.hpp>
+#include <Test.hpp>
+
+static void testPageFilterCreate(std::vector<int32_t> &position, size_t n)
+{
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int32_t> distribution(-100, 100);
+
+    position.resize(n * 3);
+    for (size_t i = 0; i < position.size(); i++)
+    {
+        position[i] = distribution(generator);
+    }
+}
+
+TEST_CASE(TestPageFilterRegions)
+{
+    // Odd number of points and odd start test the scalar remainder.
+    size_t n = 1001;
+    size_t from = 3;
+    size_t count = n - from;
+
+    std::vector<int32_t> position;
+    testPageFilterCreate(position, n);
+
+    Vector3<double> t(10.0, 20.0, 30.0);
+
+    Box<double> box(-40.0, -30.0, 0.0, 60.0, 50.0, 90.0);
+    Sphere<double> sphere(10.0, 20.0, 30.0, 70.0);
+    Cylinder<double> cylinder;
+    cylinder.set(10.0, 20.0, -40.0, 30.0, 10.0, 100.0, 50.0);
+    Cone<double> cone;
+    cone.set(10.0, 20.0, 120.0, -60.0, 25.0);
+
+    std::vector<uint32_t> expected;
+    std::vector<uint32_t> scalar(n);
+    std::vector<uint32_t> vector(n);
+
+    for (int shape = 0; shape < 4; shape++)
+    {
+        // Expected : same points as contains() of the region.
+        expected.clear();
+        for (size_t i = from; i < n; i++)
+        {
+            double x = position[3 * i + 0] + t[0];
+            double y = position[3 * i + 1] + t[1];
+            double z = position[3 * i + 2] + t[2];
+
+            bool inside = false;
+            if (shape == 0)
+            {
+                inside = box.contains(x, y, z);
+            }
+            else if (shape == 1)
+            {
+                inside = sphere.contains(x, y, z);
+            }
+            else if (shape == 2)
+            {
+                inside = cylinder.contains(x, y, z);
+            }
+            else
+            {
+                inside = cone.contains(x, y, z);
+            }
+
+            if (inside)
+            {
+                expected.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        TEST(!expected.empty() && expected.size() < count);
+
+        size_t nScalar = 0;
+        size_t nVector = 0;
+        const int32_t *p = position.data();
+
+        if (shape == 0)
+        {
+            nScalar =
+                PageFilter::box(&scalar[0], p, from, count, t, box, false);
+            nVector = PageFilter::box(&vector[0], p, from, count, t, box);
+        }
+        else if (shape == 1)
+        {
+            nScalar = PageFilter::sphere(&scalar[0],
+                                         p,
+                                         from,
+                                         count,
+                                         t,
+                                         sphere,
+                                         false);
+            nVector = PageFilter::sphere(&vector[0], p, from, count, t, sphere);
+        }
+        else if (shape == 2)
+        {
+            nScalar = PageFilter::cylinder(&scalar[0],
+                                           p,
+                                           from,
+                                           count,
+                                           t,
+                                           cylinder,
+                                           false);
+            nVector =
+                PageFilter::cylinder(&vector[0], p, from, count, t, cylinder);
+        }
+        else
+        {
+            nScalar =
+                PageFilter::cone(&scalar[0], p, from, count, t, cone, false);
+            nVector = PageFilter::cone(&vector[0], p, from, count, t, cone);
+        }
+
+        TEST(nScalar == expected.size());
+        TEST(nVector == expected.size());
+
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            TEST(scalar[i] == expected[i]);
+            TEST(vector[i] == expected[i]);
+        }
+    }
+}
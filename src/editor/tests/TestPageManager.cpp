@@ -0,0 +1,173 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file TestPageManager.cpp */
+
+// Include std.
+#include <cstdint>
+#include <memory>
+
+// Include 3D Forest.
+#include <PageManager.hpp>
+#include <Test.hpp>
+#include <TestDataset.hpp>
+
+TEST_CASE(TestPageManagerPrefetch)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetRows(5000);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].segment = static_cast<uint32_t>(i);
+    }
+
+    Editor editor;
+    testDatasetOpen(editor, points);
+    TEST(editor.datasets().at(0).index().size() > 1);
+
+    // Prefetch pages which are never used.
+    // Expected : cancel releases them.
+    TEST(editor.prefetchPage(0, 0));
+    TEST(!editor.prefetchPage(0, 0));
+    editor.cancelPrefetch();
+
+    // Read all pages while next pages are read in the background.
+    // Expected : every point is returned once with its own values.
+    Query query(&editor);
+    query.where().setBox(Box<double>(-10000., 10000.));
+    query.exec();
+
+    std::vector<size_t> count(points.size(), 0);
+    size_t n = 0;
+    while (query.next())
+    {
+        size_t i = static_cast<size_t>(query.z());
+        TEST(i < points.size());
+        TEST(query.segment() == i);
+        count[i]++;
+        n++;
+    }
+
+    TEST(n == points.size());
+    for (size_t i = 0; i < count.size(); i++)
+    {
+        TEST(count[i] == 1);
+    }
+}
+
+TEST_CASE(TestPageManagerSharedPages)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetPoints(100);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].x = static_cast<int32_t>(i);
+    }
+
+    Editor editor;
+    testDatasetOpen(editor, points);
+    size_t datasetId = editor.datasets().id(0);
+
+    std::weak_ptr<PageData> pageData = editor.readPage(datasetId, 0);
+    editor.erasePage(datasetId, 0);
+
+    // Read the same page by two queries.
+    // Expected : page data are shared and kept after queries release them.
+    {
+        Query query(&editor);
+        query.where().setBox(Box<double>(-10000., 10000.));
+        query.exec();
+        TEST(query.next());
+
+        Query queryOther(&editor);
+        queryOther.where().setBox(Box<double>(-10000., 10000.));
+        queryOther.exec();
+        TEST(queryOther.next());
+
+        TEST(query.page()->position == queryOther.page()->position);
+        TEST(pageData.lock()->position.data() == query.page()->position);
+    }
+
+    TEST(!pageData.expired());
+
+    // Close the project.
+    // Expected : unused pages are dropped.
+    editor.close();
+    TEST(pageData.expired());
+}
+
+TEST_CASE(TestPageManagerWriteBack)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetPoints(100);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].x = static_cast<int32_t>(i);
+    }
+
+    testDatasetCreate(points);
+
+    // Modify the page and release it without flushing.
+    // Expected : modified page is kept in the cache and written on eviction.
+    {
+        Editor editor;
+        editor.open(TEST_DATASET_PATH);
+        editor.setPageCacheSizeMaximum(SIZE_MAX);
+        size_t datasetId = editor.datasets().id(0);
+
+        {
+            Query query(&editor);
+            query.where().setBox(Box<double>(-10000., 10000.));
+            query.exec();
+            TEST(query.next() && (query.classification() = 7));
+            query.setModified();
+        }
+
+        PageManager::Statistics statistics = editor.pageCacheStatistics();
+        TEST(statistics.nPages > 0);
+        TEST(statistics.nWrites == 0);
+        TEST(statistics.nEvictions == 0);
+
+        // Release the page again with empty cache budget.
+        editor.setPageCacheSizeMaximum(0);
+        editor.readPage(datasetId, 0);
+        editor.erasePage(datasetId, 0);
+
+        statistics = editor.pageCacheStatistics();
+        TEST(statistics.nPages == 0);
+        TEST(statistics.cacheSizeInMemory == 0);
+        TEST(statistics.nWrites == 1);
+        TEST(statistics.nEvictions == statistics.nWrites);
+    }
+
+    // Read modified values.
+    // Expected : written back page is persistent.
+    {
+        Editor editor;
+        editor.open(TEST_DATASET_PATH);
+
+        Query query(&editor);
+        query.where().setBox(Box<double>(-10000., 10000.));
+        query.exec();
+        TEST(query.next() && query.classification() == 7);
+    }
+}
@@ -0,0 +1,119 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file TestPageSummary.cpp */
+
+// Include 3D Forest.
+#include <File.hpp>
+#include <PageSummaryFile.hpp>
+#include <Test.hpp>
+#include <TestDataset.hpp>
+
+TEST_CASE(TestPageSummarySkipPages)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetRows(5000);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].intensity = static_cast<uint16_t>(i);
+        points[i].classification = (i < 1000) ? LasFile::CLASS_GROUND
+                                               : LasFile::CLASS_UNASSIGNED;
+    }
+
+    testDatasetCreate(points);
+
+    TEST(File::exists(PageSummaryFile::extension(TEST_DATASET_PATH)));
+
+    // Filter ground points.
+    // Expected : pages without ground points are skipped.
+    size_t nPagesAll;
+    {
+        Editor editor;
+        editor.open(TEST_DATASET_PATH);
+        TEST(editor.datasets().at(0).summaryFile() != nullptr);
+
+        Query query(&editor);
+        query.where().setBox(Box<double>(-10000., 10000.));
+        query.exec();
+        nPagesAll = query.pageSizeEstimate();
+
+        query.where().setClassification({LasFile::CLASS_GROUND});
+        query.exec();
+        TEST(query.pageSizeEstimate() < nPagesAll);
+
+        size_t n = 0;
+        while (query.next())
+        {
+            TEST(query.z() < 1000.0);
+            n++;
+        }
+        TEST(n == 1000);
+
+        // Expected : intensity range selects the same points.
+        query.where().clear();
+        query.where().setBox(Box<double>(-10000., 10000.));
+        query.where().setIntensity(
+            Range<double>(0.0, 4000.0 / 65535.0, 4999.0 / 65535.0, 1.0));
+        query.exec();
+        TEST(query.pageSizeEstimate() < nPagesAll);
+
+        n = 0;
+        while (query.next())
+        {
+            TEST(query.z() >= 4000.0);
+            n++;
+        }
+        TEST(n == 1000);
+
+        // Modify classification of the last points.
+        query.where().clear();
+        query.where().setBox(Box<double>(-10000., 10000.));
+        query.exec();
+
+        while (query.next())
+        {
+            if (query.z() >= 4900.0)
+            {
+                query.classification() = LasFile::CLASS_GROUND;
+                query.setModified();
+            }
+        }
+
+        query.flush();
+    }
+
+    // Expected : written pages update their summaries.
+    {
+        Editor editor;
+        editor.open(TEST_DATASET_PATH);
+
+        Query query(&editor);
+        query.where().setBox(Box<double>(-10000., 10000.));
+        query.where().setClassification({LasFile::CLASS_GROUND});
+        query.exec();
+
+        size_t n = 0;
+        while (query.next())
+        {
+            n++;
+        }
+        TEST(n == 1100);
+    }
+}
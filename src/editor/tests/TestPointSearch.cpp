@@ -0,0 +1,95 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file TestPointSearch.cpp */
+
+// Include std.
+#include <algorithm>
+#include <cmath>
+
+// Include 3D Forest.
+#include <PointSearch.hpp>
+#include <Test.hpp>
+#include <TestDataset.hpp>
+
+TEST_CASE(TestPointSearch)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetRandom(8000);
+
+    Editor editor;
+    testDatasetOpen(editor, points);
+
+    PointSearch search(&editor);
+    search.setCacheSize(2);
+
+    std::vector<PointSearch::Point> result;
+    std::vector<double> expected;
+
+    const double center[3][3] = {{500, 500, 500}, {0, 0, 0}, {990, 10, 400}};
+
+    for (size_t c = 0; c < 3; c++)
+    {
+        double x = center[c][0];
+        double y = center[c][1];
+        double z = center[c][2];
+
+        // Sorted distances to all points.
+        expected.resize(0);
+        for (const auto &point : points)
+        {
+            double dx = static_cast<double>(point.x) - x;
+            double dy = static_cast<double>(point.y) - y;
+            double dz = static_cast<double>(point.z) - z;
+            expected.push_back(std::sqrt(dx * dx + dy * dy + dz * dz));
+        }
+        std::sort(expected.begin(), expected.end());
+
+        // Radius search.
+        // Expected : all points within radius in distance order.
+        search.radius(result, x, y, z, 100.0);
+        size_t n = static_cast<size_t>(
+            std::upper_bound(expected.begin(), expected.end(), 100.0) -
+            expected.begin());
+        TEST(result.size() == n);
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            TEST(std::abs(result[i].distance - expected[i]) < 1e-9);
+            double dx = search.x(result[i]) - x;
+            double dy = search.y(result[i]) - y;
+            double dz = search.z(result[i]) - z;
+            TEST(std::abs(std::sqrt(dx * dx + dy * dy + dz * dz) -
+                          result[i].distance) < 1e-9);
+        }
+
+        // Nearest neighbour search.
+        // Expected : k closest points in distance order.
+        search.nearest(result, x, y, z, 10);
+        TEST(result.size() == 10);
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            TEST(std::abs(result[i].distance - expected[i]) < 1e-9);
+        }
+    }
+
+    // Nearest neighbour search with more neighbours than points.
+    // Expected : all points.
+    search.nearest(result, 0, 0, 0, points.size() + 1);
+    TEST(result.size() == points.size());
+}
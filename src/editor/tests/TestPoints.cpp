@@ -19,6 +19,9 @@
 
 /** @file TestPoints.cpp */
 
+// Include std.
+#include <algorithm>
+
 // Include 3D Forest.
 #include <Points.hpp>
 #include <Test.hpp>
@@ -49,6 +52,66 @@ TEST_CASE(TestPointsFindNN)
     TEST(p.findNN(0.0, 0.0, 1.0) == 0);
 }
 
+TEST_CASE(TestPointsMoveToFile)
+{
+    Points p;
+    p.setMemorySizeMaximum(2 * sizeof(Point));
+
+    p.push_back({0.0, 0.0, 0.0});
+    p.push_back({1.0, 0.0, 0.0});
+    TEST(p.inMemory());
+
+    p.push_back({2.0, 0.0, 0.0});
+    TEST(!p.inMemory());
+    TEST(p.size() == 3 && equal(p[1].x, 1.0) && equal(p[2].x, 2.0));
+
+    std::vector<size_t> result;
+    p.createIndex();
+    p.findRadius(2.0, 0.0, 0.0, 1.1, result);
+    TEST(result.size() == 2);
+    TEST(p.findNN(0.0, 0.0, 1.0) == 0);
+
+    p.clear();
+    TEST(p.empty() && p.inMemory());
+}
+
+TEST_CASE(TestPointsFindRadiusBatch)
+{
+    Points p;
+    for (size_t i = 0; i < 1000; i++)
+    {
+        p.push_back({static_cast<double>(i % 10),
+                     static_cast<double>((i / 10) % 10),
+                     static_cast<double>(i / 100)});
+    }
+
+    p.createIndex();
+    p.setNumberOfThreads(4);
+
+    std::vector<size_t> queries;
+    for (size_t i = 0; i < 1000; i += 3)
+    {
+        queries.push_back(i);
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<size_t> indices;
+    p.findRadius(queries, 1.5, offsets, indices);
+    TEST(offsets.size() == queries.size() + 1);
+    TEST(offsets.back() == indices.size());
+
+    std::vector<size_t> result;
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        const Point &a = p[queries[i]];
+        p.findRadius(a.x, a.y, a.z, 1.5, result);
+        TEST(std::equal(result.begin(),
+                        result.end(),
+                        indices.begin() + static_cast<long>(offsets[i]),
+                        indices.begin() + static_cast<long>(offsets[i + 1])));
+    }
+}
+
 class TestPoint3f
 {
 public:
@@ -0,0 +1,282 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file TestQuery.cpp */
+
+// Include std.
+#include <algorithm>
+#include <atomic>
+
+// Include 3D Forest.
+#include <Test.hpp>
+#include <TestDataset.hpp>
+
+TEST_CASE(TestQueryParallel)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetRows(5000);
+    testDatasetCreate(points);
+
+    // Modify all points by parallel query.
+    // Expected : each selected point is processed once.
+    {
+        Editor editor;
+        editor.open(TEST_DATASET_PATH);
+
+        Query query(&editor);
+        query.setNumberOfThreads(4);
+        query.where().setBox(Box<double>(-10000., 10000.));
+        query.exec();
+
+        std::atomic<size_t> n(0);
+        size_t nPages = query.forEachPage(
+            [&](Page &page, size_t)
+            {
+                page.readAttribute(PageData::ATTRIBUTE_VOXEL);
+
+                for (size_t i = 0; i < page.selectionSize; i++)
+                {
+                    size_t row = page.selection[i];
+                    page.voxel[row] = static_cast<uint32_t>(page.z(row));
+                }
+
+                page.setModified();
+                n += page.selectionSize;
+            });
+
+        TEST(nPages == query.pageSizeEstimate());
+        TEST(n == points.size());
+
+        // Read modified values while the first editor is open.
+        // Expected : modified pages are written without flush.
+        Editor editorOther;
+        editorOther.open(TEST_DATASET_PATH);
+
+        Query queryOther(&editorOther);
+        queryOther.where().setBox(Box<double>(-10000., 10000.));
+        queryOther.exec();
+
+        size_t nOther = 0;
+        while (queryOther.next())
+        {
+            TEST(queryOther.voxel() == static_cast<uint32_t>(queryOther.z()));
+            nOther++;
+        }
+
+        TEST(nOther == points.size());
+    }
+}
+
+TEST_CASE(TestQueryIncrementalSelection)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetRows(5000);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].intensity = static_cast<uint16_t>(i);
+        points[i].elevation = static_cast<uint32_t>(i);
+    }
+
+    Editor editor;
+    testDatasetOpen(editor, points);
+
+    // Change one criterion at a time on cached pages.
+    // Expected : each selection matches all current criteria.
+    Query query(&editor);
+    query.where().setBox(Box<double>(-10000., 10000.));
+    TEST(testDatasetCount(query) == 5000);
+
+    query.where().setElevation(Range<double>(0.0, 1000.0, 2999.0, 5000.0));
+    TEST(testDatasetCount(query) == 2000);
+
+    query.where().setIntensity(
+        Range<double>(0.0, 2500.0 / 65535.0, 4999.0 / 65535.0, 1.0));
+    TEST(testDatasetCount(query) == 500);
+
+    query.where().setElevation(Range<double>(0.0, 2000.0, 4999.0, 5000.0));
+    TEST(testDatasetCount(query) == 2500);
+
+    query.where().setBox(Box<double>(-10000., -10000., -10000., 10000.,
+                                     10000., 2999.0));
+    TEST(testDatasetCount(query) == 500);
+
+    query.where().setElevation(Range<double>(0.0, 5000.0));
+    TEST(testDatasetCount(query) == 500);
+
+    query.where().setIntensity(Range<double>(0.0, 1.0));
+    TEST(testDatasetCount(query) == 3000);
+}
+
+TEST_CASE(TestQueryIncrementalSelectionModified)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetRows(5000);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].classification = LasFile::CLASS_UNASSIGNED;
+    }
+
+    Editor editor;
+    testDatasetOpen(editor, points);
+
+    // Modify points under unchanged classification filter.
+    // Expected : the next selection matches modified point data.
+    Query query(&editor);
+    query.where().setBox(Box<double>(-10000., 10000.));
+    query.where().setClassification({LasFile::CLASS_GROUND});
+    TEST(testDatasetCount(query) == 0);
+
+    query.where().setClassification({LasFile::CLASS_UNASSIGNED});
+    TEST(testDatasetCount(query) == 5000);
+
+    query.exec();
+    while (query.next())
+    {
+        if (query.z() < 1000.0)
+        {
+            query.classification() = LasFile::CLASS_GROUND;
+            query.setModified();
+        }
+    }
+
+    TEST(testDatasetCount(query) == 4000);
+
+    // Modify the same pages through another query.
+    Query queryOther(&editor);
+    queryOther.where().setBox(Box<double>(-10000., 10000.));
+    queryOther.exec();
+    while (queryOther.next())
+    {
+        queryOther.classification() = LasFile::CLASS_UNASSIGNED;
+        queryOther.setModified();
+    }
+
+    TEST(testDatasetCount(query) == 5000);
+
+    // Modify points in a small sphere under classification filter.
+    // Expected : selections with and without region match modified data.
+    Query querySphere(&editor);
+    querySphere.where().setSphere(50.0, 10.0, 1050.0, 20.0);
+    querySphere.where().setClassification({LasFile::CLASS_UNASSIGNED});
+    size_t nSphere = testDatasetCount(querySphere);
+    TEST(nSphere > 0);
+
+    querySphere.exec();
+    while (querySphere.next())
+    {
+        querySphere.classification() = LasFile::CLASS_GROUND;
+        querySphere.setModified();
+    }
+
+    TEST(testDatasetCount(querySphere) == 0);
+    TEST(testDatasetCount(query) == 5000 - nSphere);
+
+    Query queryAll(&editor);
+    queryAll.where().setClassification({LasFile::CLASS_UNASSIGNED});
+    TEST(testDatasetCount(queryAll) == 5000 - nSphere);
+}
+
+TEST_CASE(TestQueryRecenter)
+{
+    // Create new file with test data.
+    ImportSettings settings;
+    settings.maxIndexLevel1Size = {100};
+
+    Editor editor;
+    testDatasetOpen(editor, testDatasetGrid(8000), settings);
+
+    Query query(&editor);
+    Query queryExec(&editor);
+
+    // Move sphere along a line and back.
+    // Expected : the same points as selected by exec().
+    for (size_t i = 0; i < 80; i++)
+    {
+        double t = static_cast<double>(i < 40 ? i : 79 - i) * 4.0;
+        double r = (i % 3 == 0) ? 15.0 : 12.0;
+
+        query.recenter(t, t, t, r);
+        queryExec.where().setSphere(t, t, t, r);
+        queryExec.exec();
+
+        size_t n = 0;
+        while (query.next())
+        {
+            n++;
+        }
+
+        TEST(n == testDatasetCount(queryExec));
+        TEST(n > 0);
+    }
+
+    // Change other condition.
+    // Expected : the condition applies to re-centered sphere.
+    query.where().setElevation(Range<double>(0.0, 1.0, 2.0, 10.0));
+    query.recenter(100.0, 100.0, 100.0, 15.0);
+    TEST(query.next() == false);
+
+    // Change dataset filter.
+    // Expected : the filter applies to re-centered sphere.
+    query.where().setElevation(Range<double>());
+    query.recenter(100.0, 100.0, 100.0, 15.0);
+    TEST(query.next());
+
+    query.where().setDataset(QueryFilterSet({}, true));
+    query.recenter(100.0, 100.0, 100.0, 15.0);
+    TEST(query.next() == false);
+}
+
+TEST_CASE(TestQueryCache)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetGrid(8000);
+
+    ImportSettings settings;
+    settings.maxIndexLevel1Size = {100};
+
+    Editor editor;
+    testDatasetOpen(editor, points, settings);
+
+    // Cache with space for the root page and one other page.
+    const IndexFile &index = editor.datasets().at(0).index();
+    uint64_t sizeMaximum = 0;
+    for (size_t i = 1; i < index.size(); i++)
+    {
+        sizeMaximum = std::max(sizeMaximum, index.at(i)->size);
+    }
+
+    Query query(&editor);
+    query.setCacheSizeMaximum(PageData::sizeInMemory(index.at(0)->size) +
+                              PageData::sizeInMemory(sizeMaximum));
+    query.where().setBox(Box<double>(-10000., 10000.));
+
+    // Read all pages twice.
+    // Expected : all points, pinned root page stays in the cache.
+    for (size_t i = 0; i < 2; i++)
+    {
+        TEST(testDatasetCount(query) == points.size());
+    }
+
+    const Query::CacheStatistics &statistics = query.cacheStatistics();
+    TEST(statistics.nHits + statistics.nMisses == 2 * index.size());
+    TEST(statistics.nHits >= 1);
+    TEST(statistics.nEvictions > 0);
+}
@@ -0,0 +1,148 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file TestQueryWhere.cpp */
+
+// Include 3D Forest.
+#include <QueryWhere.hpp>
+#include <Test.hpp>
+
+static QueryFilterSet testQueryWhereFilter(
+    const std::unordered_set<size_t> &values,
+    const std::unordered_set<size_t> &filter)
+{
+    QueryFilterSet set;
+    set.setValues(values);
+    set.setFilter(filter);
+    return set;
+}
+
+static bool testQueryWhereContains(const QueryWhere &where,
+                                   const Segments &segments,
+                                   const SpeciesList &speciesList,
+                                   const ManagementStatusList &statusList,
+                                   size_t id)
+{
+    // Reference: per point hash table lookups.
+    const std::unordered_set<size_t> &segmentFilter = where.segment().filter();
+    if (!where.segment().matchesAll())
+    {
+        if (segmentFilter.count(id) == 0 && segments.contains(id))
+        {
+            return false;
+        }
+    }
+
+    size_t index = segments.index(id, false);
+
+    if (!where.species().matchesAll())
+    {
+        if (index == SIZE_MAX)
+        {
+            return false;
+        }
+
+        size_t speciesId = segments[index].speciesId;
+        if (where.species().filter().count(speciesId) == 0 &&
+            speciesList.contains(speciesId))
+        {
+            return false;
+        }
+    }
+
+    if (!where.managementStatus().matchesAll())
+    {
+        if (index == SIZE_MAX)
+        {
+            return false;
+        }
+
+        size_t statusId = segments[index].managementStatusId;
+        if (where.managementStatus().filter().count(statusId) == 0 &&
+            statusList.contains(statusId))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TEST_CASE(TestQueryWhereSegmentArray)
+{
+    Segments segments;
+    segments.clear();
+    for (size_t i = 0; i < 10; i++)
+    {
+        Segment segment;
+        segment.id = i;
+        segment.speciesId = i % 3;
+        segment.managementStatusId = i % 2;
+        segments.push_back(segment);
+    }
+
+    SpeciesList speciesList;
+    speciesList.clear();
+    speciesList.push_back(Species(0, "A", "", "", "", "", {}));
+    speciesList.push_back(Species(1, "B", "", "", "", "", {}));
+
+    ManagementStatusList statusList;
+    statusList.clear();
+    statusList.push_back(ManagementStatus(0, "A", {}));
+    statusList.push_back(ManagementStatus(1, "B", {}));
+
+    QueryWhere where;
+    where.setSegment(testQueryWhereFilter({0, 1, 2, 3, 4, 5, 6, 7, 8, 9},
+                                          {1, 2, 3, 5, 6, 7, 8}));
+    where.setSpecies(testQueryWhereFilter({0, 1}, {0}));
+    where.setManagementStatus(testQueryWhereFilter({0, 1}, {1}));
+    TEST(where.segmentArrayEnabled());
+
+    where.updateSegmentArray(segments, speciesList, statusList, 1);
+
+    for (size_t id = 0; id < 13; id++)
+    {
+        bool expected = testQueryWhereContains(where,
+                                               segments,
+                                               speciesList,
+                                               statusList,
+                                               id);
+        TEST(where.segmentArrayContains(id) == expected);
+    }
+
+    // Segment 5 has species 2 which is not in the list.
+    TEST(where.segmentArrayContains(5));
+    TEST(!where.segmentArrayContains(7));
+
+    // Same version does not rebuild the table.
+    segments[segments.index(7)].speciesId = 0;
+    where.updateSegmentArray(segments, speciesList, statusList, 1);
+    TEST(!where.segmentArrayContains(7));
+
+    // New version of the lists rebuilds the table.
+    where.updateSegmentArray(segments, speciesList, statusList, 2);
+    TEST(where.segmentArrayContains(7));
+
+    // Changed filter rebuilds the table.
+    where.setManagementStatus(testQueryWhereFilter({0, 1}, {0, 1}));
+    where.setSpecies(testQueryWhereFilter({0, 1}, {0, 1}));
+    where.updateSegmentArray(segments, speciesList, statusList, 2);
+    TEST(where.segmentArrayContains(12));
+    TEST(!where.segmentArrayContains(4));
+}
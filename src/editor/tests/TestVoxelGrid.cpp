@@ -0,0 +1,91 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file TestVoxelGrid.cpp */
+
+// Include std.
+#include <cmath>
+
+// Include 3D Forest.
+#include <Test.hpp>
+#include <TestDataset.hpp>
+#include <VoxelGrid.hpp>
+
+TEST_CASE(TestVoxelGrid)
+{
+    // Create new file with test data.
+    std::vector<LasFile::Point> points = testDatasetRandom(8000);
+
+    Editor editor;
+    testDatasetOpen(editor, points);
+
+    // Group points by parity of x, skip points below z 100.
+    auto group = [](const Page &page, size_t row) -> size_t
+    {
+        if (page.z(row) < 100.0)
+        {
+            return SIZE_MAX;
+        }
+        return static_cast<size_t>(page.x(row)) % 2;
+    };
+
+    // Voxelize points in small steps.
+    // Expected : each voxel has the same points as a brute force binning.
+    VoxelGrid grid(&editor);
+    grid.start(QueryWhere(), 100.0, {0, 0, 0}, group);
+    while (!grid.end())
+    {
+        TEST(grid.next(1) == 1);
+    }
+    TEST(grid.nPoints() == points.size());
+
+    std::vector<size_t> n(grid.size(), 0);
+    std::vector<double> z(grid.size(), 0);
+    size_t nSkipped = 0;
+    for (const auto &point : points)
+    {
+        if (point.z < 100)
+        {
+            nSkipped++;
+            continue;
+        }
+
+        size_t g = static_cast<size_t>(point.x % 2);
+        size_t i = grid.index(point.x, point.y, point.z, g);
+        TEST(i < grid.size());
+        TEST(grid[i].cell[0] == point.x / 100);
+        TEST(grid[i].cell[2] == point.z / 100);
+        n[i]++;
+        z[i] += static_cast<double>(point.z);
+    }
+
+    size_t nBinned = 0;
+    for (size_t i = 0; i < grid.size(); i++)
+    {
+        TEST(grid[i].n == n[i]);
+        TEST(std::abs(grid[i].z - z[i] / static_cast<double>(n[i])) < 1e-6);
+        nBinned += n[i];
+    }
+    TEST(nBinned + nSkipped == points.size());
+
+    // Points outside of the grid.
+    // Expected : no voxel is found.
+    TEST(grid.index(-1, 0, 500) == SIZE_MAX);
+    TEST(grid.index(500, 500, 50) == SIZE_MAX);
+}
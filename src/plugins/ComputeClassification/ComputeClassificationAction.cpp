@@ -19,9 +19,11 @@
 
 /** @file ComputeClassificationAction.cpp */
 
+// Include std.
+#include <atomic>
+
 // Include 3D Forest.
 #include <ComputeClassificationAction.hpp>
-#include <Cone.hpp>
 #include <Editor.hpp>
 
 // Include local.
@@ -30,12 +32,15 @@
 #include <Log.hpp>
 
 #define COMPUTE_CLASSIFICATION_STEP_RESET_POINTS 0
-#define COMPUTE_CLASSIFICATION_STEP_COUNT_POINTS 1
-#define COMPUTE_CLASSIFICATION_STEP_POINTS_TO_VOXELS 2
-#define COMPUTE_CLASSIFICATION_STEP_CREATE_VOXEL_INDEX 3
+#define COMPUTE_CLASSIFICATION_STEP_POINTS_TO_VOXELS 1
+#define COMPUTE_CLASSIFICATION_STEP_CREATE_VOXEL_INDEX 2
+#define COMPUTE_CLASSIFICATION_STEP_TEST_GROUND 3
 #define COMPUTE_CLASSIFICATION_STEP_CLASSIFY_GROUND 4
 #define COMPUTE_CLASSIFICATION_STEP_VOXELS_TO_POINTS 5
 
+#define COMPUTE_CLASSIFICATION_PAGES_PER_STEP 64
+#define COMPUTE_CLASSIFICATION_TILES_PER_STEP 64
+
 #define COMPUTE_CLASSIFICATION_PROCESS 0
 #define COMPUTE_CLASSIFICATION_NOT_FOUND 1
 #define COMPUTE_CLASSIFICATION_FOUND 2
@@ -43,7 +48,7 @@
 ComputeClassificationAction::ComputeClassificationAction(Editor *editor)
     : editor_(editor),
       query_(editor),
-      queryPoint_(editor)
+      voxelGrid_(editor)
 {
     LOG_DEBUG(<< "Create.");
 }
@@ -58,16 +63,20 @@ void ComputeClassificationAction::clear()
     LOG_DEBUG(<< "Clear.");
 
     query_.clear();
-    queryPoint_.clear();
+    voxelGrid_.clear();
 
     nPointsTotal_ = 0;
     nPointsInFilter_ = 0;
+    pageIndex_ = 0;
+    tileIndex_ = 0;
 
     voxels_.clear();
+    raster_.clear();
+    threadPool_.clear();
     group_.clear();
     path_.clear();
+    searchOffsets_.clear();
     searchNext_.clear();
-    searchGround_.clear();
 
     minimumIndex_ = 0;
     minimumValue_ = 0;
@@ -90,19 +99,25 @@ void ComputeClassificationAction::start(
     // Clear work data.
     nPointsTotal_ = editor_->datasets().nPoints();
     nPointsInFilter_ = 0;
+    pageIndex_ = 0;
+    tileIndex_ = 0;
 
     voxels_.clear();
+    raster_.clear();
     group_.clear();
     path_.clear();
+    searchOffsets_.clear();
     searchNext_.clear();
-    searchGround_.clear();
 
     minimumIndex_ = SIZE_MAX;
     minimumValue_ = std::numeric_limits<double>::max();
 
+    // Use all hardware threads.
+    threadPool_.create();
+
     // Plan the steps.
     progress_.setMaximumStep(nPointsTotal_, 1000);
-    progress_.setMaximumSteps({20.0, 10.0, 20.0, 20.0, 10.0, 20.0});
+    progress_.setMaximumSteps({20.0, 30.0, 10.0, 15.0, 5.0, 20.0});
     progress_.setValueSteps(COMPUTE_CLASSIFICATION_STEP_RESET_POINTS);
 }
 
@@ -114,10 +129,6 @@ void ComputeClassificationAction::next()
             stepResetPoints();
             break;
 
-        case COMPUTE_CLASSIFICATION_STEP_COUNT_POINTS:
-            stepCountPoints();
-            break;
-
         case COMPUTE_CLASSIFICATION_STEP_POINTS_TO_VOXELS:
             stepPointsToVoxels();
             break;
@@ -126,6 +137,10 @@ void ComputeClassificationAction::next()
             stepCreateVoxelIndex();
             break;
 
+        case COMPUTE_CLASSIFICATION_STEP_TEST_GROUND:
+            stepTestGround();
+            break;
+
         case COMPUTE_CLASSIFICATION_STEP_CLASSIFY_GROUND:
             stepClassifyGround();
             break;
@@ -145,7 +160,7 @@ void ComputeClassificationAction::stepResetPoints()
     progress_.startTimer();
 
     // Initialize:
-    if (progress_.valueStep() == 0)
+    if (progress_.valueStep() == 0 && pageIndex_ == 0)
     {
         // Reset elevation range.
         Range<double> range;
@@ -156,95 +171,104 @@ void ComputeClassificationAction::stepResetPoints()
         query_.exec();
     }
 
-    // For each point in all datasets:
-    while (query_.next())
+    bool cleanAll = parameters_.cleanAllClassifications;
+    bool cleanGround = parameters_.cleanGroundClassifications;
+
+    // For each page in all datasets, pages are processed in parallel:
+    while (pageIndex_ < query_.pageSizeEstimate())
     {
-        // Set point index to voxel to none.
-        query_.voxel() = SIZE_MAX;
+        std::atomic<uint64_t> nPoints(0);
 
-        // Reset point classification of ground points to never classified.
-        if (parameters_.cleanAllClassifications ||
-            (parameters_.cleanGroundClassifications &&
-             query_.classification() == LasFile::CLASS_GROUND))
-        {
-            query_.classification() = LasFile::CLASS_NEVER_CLASSIFIED;
-        }
+        pageIndex_ += query_.forEachPage(
+            [&](Page &page, size_t)
+            {
+                page.readAttribute(PageData::ATTRIBUTE_ELEVATION);
 
-        // Reset point elevation to zero.
-        query_.elevation() = 0;
+                for (size_t i = 0; i < page.selectionSize; i++)
+                {
+                    size_t row = page.selection[i];
 
-        query_.setModified();
+                    // Reset point classification of ground points to never
+                    // classified.
+                    if (cleanAll ||
+                        (cleanGround &&
+                         page.classification[row] == LasFile::CLASS_GROUND))
+                    {
+                        page.classification[row] =
+                            LasFile::CLASS_NEVER_CLASSIFIED;
+                    }
 
-        progress_.addValueStep(1);
+                    // Reset point elevation to zero.
+                    page.elevation[row] = 0;
+                }
+
+                page.setModified();
+                nPoints += page.selectionSize;
+            },
+            pageIndex_,
+            COMPUTE_CLASSIFICATION_PAGES_PER_STEP);
+
+        progress_.addValueStep(nPoints);
         if (progress_.timedOut())
         {
             return;
         }
     }
 
-    // Next.
+    // Next. Voxels are created from points in the active filter. The voxel
+    // edge is the voxel diameter.
+    voxelGrid_.start(editor_->viewports().where(),
+                     2.0 * parameters_.voxelRadius,
+                     editor_->boundary().min());
+
     progress_.setMaximumStep(nPointsTotal_, 1000);
-    progress_.setValueSteps(COMPUTE_CLASSIFICATION_STEP_COUNT_POINTS);
+    progress_.setValueSteps(COMPUTE_CLASSIFICATION_STEP_POINTS_TO_VOXELS);
 }
 
-void ComputeClassificationAction::stepCountPoints()
+void ComputeClassificationAction::stepPointsToVoxels()
 {
     progress_.startTimer();
 
-    // Initialize:
-    if (progress_.valueStep() == 0)
-    {
-        // Set query to use the active filter.
-        query_.setWhere(editor_->viewports().where());
-        query_.exec();
-    }
-
-    // Count the number of filtered points.
-    // This can be the same value as nPointsTotal.
-    while (query_.next())
+    // For each page in filtered datasets, pages are binned in parallel:
+    while (!voxelGrid_.end())
     {
-        nPointsInFilter_++;
+        uint64_t nPoints = voxelGrid_.nPoints();
+        voxelGrid_.next(COMPUTE_CLASSIFICATION_PAGES_PER_STEP);
 
-        progress_.addValueStep(1);
+        progress_.addValueStep(voxelGrid_.nPoints() - nPoints);
         if (progress_.timedOut())
         {
             return;
         }
     }
 
-    LOG_DEBUG(<< "Counted <" << nPointsInFilter_ << "> points.");
+    nPointsInFilter_ = voxelGrid_.nPoints();
 
-    // Next.
-    query_.reset();
-    progress_.setMaximumStep(nPointsInFilter_, 1000);
-    progress_.setValueSteps(COMPUTE_CLASSIFICATION_STEP_POINTS_TO_VOXELS);
-}
+    // Append voxel centroids to voxel array in the order of grid voxels.
+    for (size_t i = 0; i < voxelGrid_.size(); i++)
+    {
+        const VoxelGrid::Voxel &voxel = voxelGrid_[i];
 
-void ComputeClassificationAction::stepPointsToVoxels()
-{
-    progress_.startTimer();
+        Point p;
+        p.x = voxel.x;
+        p.y = voxel.y;
+        p.z = voxel.z;
+        p.group = COMPUTE_CLASSIFICATION_PROCESS;
 
-    // For each point in filtered datasets:
-    while (query_.next())
-    {
-        // If point index to voxel is none:
-        if (query_.voxel() == SIZE_MAX)
+        // Update minimum height.
+        if (p.z < minimumValue_)
         {
-            // Create new voxel.
-            createVoxel();
+            minimumIndex_ = i;
+            minimumValue_ = p.z;
         }
 
-        progress_.addValueStep(1);
-        if (progress_.timedOut())
-        {
-            return;
-        }
+        voxels_.push_back(std::move(p));
     }
 
-    LOG_DEBUG(<< "Created <" << voxels_.size() << "> voxels.");
+    LOG_DEBUG(<< "Created <" << voxels_.size() << "> voxels from <"
+              << nPointsInFilter_ << "> points.");
 
     // Next.
-    query_.reset();
     progress_.setMaximumStep(voxels_.size(), 100);
     progress_.setValueSteps(COMPUTE_CLASSIFICATION_STEP_CREATE_VOXEL_INDEX);
 }
@@ -254,8 +278,45 @@ void ComputeClassificationAction::stepCreateVoxelIndex()
     // Create voxel index.
     voxels_.createIndex();
 
+    // Create minimum Z raster of voxels.
+    raster_.create(voxels_, parameters_.voxelRadius);
+    tileIndex_ = 0;
+
     LOG_DEBUG(<< "Created index.");
 
+    // Next.
+    progress_.setMaximumStep(raster_.tileSize(), 1);
+    progress_.setValueSteps(COMPUTE_CLASSIFICATION_STEP_TEST_GROUND);
+}
+
+void ComputeClassificationAction::stepTestGround()
+{
+    progress_.startTimer();
+
+    double angle = 90.0 - parameters_.angle;
+
+    // For each raster tile, tiles are processed in parallel:
+    while (tileIndex_ < raster_.tileSize())
+    {
+        size_t n = std::min(static_cast<size_t>(
+                                COMPUTE_CLASSIFICATION_TILES_PER_STEP),
+                            raster_.tileSize() - tileIndex_);
+
+        // Test if the cone below each voxel is empty.
+        threadPool_.run(
+            n,
+            [&](size_t i)
+            { raster_.testTile(tileIndex_ + i, minimumValue_, angle); });
+
+        tileIndex_ += n;
+
+        progress_.addValueStep(n);
+        if (progress_.timedOut())
+        {
+            return;
+        }
+    }
+
     // Next.
     progress_.setMaximumStep(voxels_.size(), 10);
     progress_.setValueSteps(COMPUTE_CLASSIFICATION_STEP_CLASSIFY_GROUND);
@@ -289,51 +350,30 @@ void ComputeClassificationAction::stepClassifyGround()
             group_.push_back(path_[i]);
         }
 
+        // Find neighbor voxels of the whole path at once.
+        voxels_.findRadius(path_,
+                           parameters_.searchRadius,
+                           searchOffsets_,
+                           searchNext_);
+
         // Set the path empty.
         path_.resize(0);
 
         // Try to expand the current group with neighbor voxels.
         for (size_t i = idx; i < group_.size(); i++)
         {
-            Point &a = voxels_[group_[i]];
             progress_.addValueStep(1);
 
-            voxels_.findRadius(a.x,
-                               a.y,
-                               a.z,
-                               parameters_.searchRadius,
-                               searchNext_);
-            for (size_t j = 0; j < searchNext_.size(); j++)
+            size_t from = searchOffsets_[i - idx];
+            size_t to = searchOffsets_[i - idx + 1];
+            for (size_t j = from; j < to; j++)
             {
                 // If a neighbor voxel is not yet processed:
                 Point &b = voxels_[searchNext_[j]];
                 if (b.group == COMPUTE_CLASSIFICATION_PROCESS)
                 {
-                    bool ground = true;
-
-                    // Select cone below this neighbor voxel.
-                    Cone<double> cone;
-                    cone.set(b.x,
-                             b.y,
-                             b.z,
-                             minimumValue_,
-                             90.0 - parameters_.angle);
-                    Vector3<double> p = cone.box().center();
-                    double r = cone.box().radius();
-
-                    voxels_.findRadius(p[0], p[1], p[2], r, searchGround_);
-                    for (size_t k = 0; k < searchGround_.size(); k++)
-                    {
-                        Point &c = voxels_[searchGround_[k]];
-                        if (cone.contains(c.x, c.y, c.z))
-                        {
-                            ground = false;
-                            break;
-                        }
-                    }
-
-                    // If the selection cone is empty:
-                    if (ground)
+                    // If the cone below this neighbor voxel is empty:
+                    if (raster_.ground(searchNext_[j]))
                     {
                         // Mark this neighbor voxel as ground.
                         b.group = COMPUTE_CLASSIFICATION_FOUND;
@@ -360,11 +400,20 @@ void ComputeClassificationAction::stepVoxelsToPoints()
 {
     progress_.startTimer();
 
+    // Initialize:
+    if (progress_.valueStep() == 0)
+    {
+        // Set query to use the active filter.
+        query_.setWhere(editor_->viewports().where());
+        query_.exec();
+    }
+
     // For each point in filtered datasets:
     while (query_.next())
     {
         // If a point belongs to some voxel:
-        size_t pointIndex = query_.voxel();
+        size_t pointIndex =
+            voxelGrid_.index(query_.x(), query_.y(), query_.z());
         if (pointIndex < voxels_.size())
         {
             // If this voxel is marked as ground:
@@ -392,57 +441,3 @@ void ComputeClassificationAction::stepVoxelsToPoints()
     progress_.setValueStep(progress_.maximumStep());
     progress_.setValueSteps(progress_.maximumSteps());
 }
-
-void ComputeClassificationAction::createVoxel()
-{
-    // Mark index of new voxel in voxel array.
-    size_t idx = voxels_.size();
-
-    // Initialize new voxel point.
-    Point p;
-    p.x = 0;
-    p.y = 0;
-    p.z = 0;
-    p.group = COMPUTE_CLASSIFICATION_PROCESS;
-
-    // Compute point coordinates as average from all neighbour points.
-    // Set value of each neighbour point to index of new voxel.
-    size_t n = 0;
-
-    queryPoint_.where().setSphere(query_.x(),
-                                  query_.y(),
-                                  query_.z(),
-                                  parameters_.voxelRadius);
-    queryPoint_.exec();
-
-    while (queryPoint_.next())
-    {
-        p.x += queryPoint_.x();
-        p.y += queryPoint_.y();
-        p.z += queryPoint_.z();
-
-        queryPoint_.voxel() = idx;
-        queryPoint_.setModified();
-
-        n++;
-    }
-
-    if (n < 1)
-    {
-        return;
-    }
-
-    p.x = p.x / static_cast<double>(n);
-    p.y = p.y / static_cast<double>(n);
-    p.z = p.z / static_cast<double>(n);
-
-    // Update minimum height.
-    if (p.z < minimumValue_)
-    {
-        minimumIndex_ = idx;
-        minimumValue_ = p.z;
-    }
-
-    // Append new voxel to voxel array.
-    voxels_.push_back(std::move(p));
-}
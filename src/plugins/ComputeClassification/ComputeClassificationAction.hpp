@@ -24,9 +24,12 @@
 
 // Include 3D Forest.
 #include <ComputeClassificationParameters.hpp>
+#include <ComputeClassificationRaster.hpp>
 #include <Points.hpp>
 #include <ProgressActionInterface.hpp>
 #include <Query.hpp>
+#include <ThreadPool.hpp>
+#include <VoxelGrid.hpp>
 class Editor;
 
 /** Compute Classification Action. */
@@ -43,27 +46,29 @@ public:
 protected:
     Editor *editor_;
     Query query_;
-    Query queryPoint_;
+    VoxelGrid voxelGrid_;
 
     ComputeClassificationParameters parameters_;
 
     uint64_t nPointsTotal_;
     uint64_t nPointsInFilter_;
+    size_t pageIndex_;
+    size_t tileIndex_;
 
     void stepResetPoints();
-    void stepCountPoints();
     void stepPointsToVoxels();
     void stepCreateVoxelIndex();
+    void stepTestGround();
     void stepClassifyGround();
     void stepVoxelsToPoints();
 
-    void createVoxel();
-
     Points voxels_;
+    ComputeClassificationRaster raster_;
+    ThreadPool threadPool_;
     std::vector<size_t> group_;
     std::vector<size_t> path_;
+    std::vector<size_t> searchOffsets_;
     std::vector<size_t> searchNext_;
-    std::vector<size_t> searchGround_;
 
     size_t minimumIndex_;
     double minimumValue_;
@@ -0,0 +1,260 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file ComputeClassificationRaster.cpp */
+
+// Include std.
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Include 3D Forest.
+#include <ComputeClassificationRaster.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "ComputeClassificationRaster"
+#include <Log.hpp>
+
+#define COMPUTE_CLASSIFICATION_RASTER_TILE 16
+
+/** Squared distance from point [x, y] to rectangle [x1, y1, x2, y2]. */
+static double computeClassificationRasterDistance2(double x,
+                                                   double y,
+                                                   double x1,
+                                                   double y1,
+                                                   double x2,
+                                                   double y2)
+{
+    double dx = std::max(0.0, std::max(x1 - x, x - x2));
+    double dy = std::max(0.0, std::max(y1 - y, y - y2));
+    return dx * dx + dy * dy;
+}
+
+ComputeClassificationRaster::ComputeClassificationRaster()
+{
+    clear();
+}
+
+void ComputeClassificationRaster::clear()
+{
+    cellSize_ = 1.0;
+    x0_ = 0;
+    y0_ = 0;
+    nx_ = 0;
+    ny_ = 0;
+    tx_ = 0;
+    ty_ = 0;
+
+    position_.clear();
+    cells_.clear();
+    tiles_.clear();
+    ground_.clear();
+}
+
+void ComputeClassificationRaster::create(const Points &voxels,
+                                         double cellSize)
+{
+    clear();
+
+    size_t n = voxels.size();
+    if (n == 0)
+    {
+        return;
+    }
+
+    // Copy voxel positions. Tiles may read them in parallel.
+    position_.resize(n * 3);
+    double x1 = std::numeric_limits<double>::max();
+    double y1 = std::numeric_limits<double>::max();
+    double x2 = std::numeric_limits<double>::lowest();
+    double y2 = std::numeric_limits<double>::lowest();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const Point &p = voxels[i];
+        position_[i * 3 + 0] = p.x;
+        position_[i * 3 + 1] = p.y;
+        position_[i * 3 + 2] = p.z;
+
+        x1 = std::min(x1, p.x);
+        y1 = std::min(y1, p.y);
+        x2 = std::max(x2, p.x);
+        y2 = std::max(y2, p.y);
+    }
+
+    // Create empty raster.
+    cellSize_ = cellSize;
+    x0_ = x1;
+    y0_ = y1;
+    nx_ = static_cast<size_t>((x2 - x1) / cellSize_) + 1;
+    ny_ = static_cast<size_t>((y2 - y1) / cellSize_) + 1;
+    tx_ = (nx_ + COMPUTE_CLASSIFICATION_RASTER_TILE - 1) /
+          COMPUTE_CLASSIFICATION_RASTER_TILE;
+    ty_ = (ny_ + COMPUTE_CLASSIFICATION_RASTER_TILE - 1) /
+          COMPUTE_CLASSIFICATION_RASTER_TILE;
+
+    double inf = std::numeric_limits<double>::max();
+    cells_.resize(nx_ * ny_, {0, 0, inf});
+    tiles_.resize(tx_ * ty_);
+    for (auto &tile : tiles_)
+    {
+        tile.z = inf;
+    }
+
+    // Keep the lowest voxel in each cell and the lowest Z in each tile.
+    for (size_t i = 0; i < n; i++)
+    {
+        double x = position_[i * 3 + 0];
+        double y = position_[i * 3 + 1];
+        double z = position_[i * 3 + 2];
+
+        size_t ix = cellX(x);
+        size_t iy = cellY(y);
+
+        Cell &cell = cells_[iy * nx_ + ix];
+        if (z < cell.z)
+        {
+            cell = {x, y, z};
+        }
+
+        Tile &tile = tiles_[(iy / COMPUTE_CLASSIFICATION_RASTER_TILE) * tx_ +
+                            (ix / COMPUTE_CLASSIFICATION_RASTER_TILE)];
+        tile.z = std::min(tile.z, z);
+        tile.voxels.push_back(i);
+    }
+
+    ground_.resize(n, 0);
+
+    LOG_DEBUG(<< "Created raster <" << nx_ << ", " << ny_ << "> cells <"
+              << tx_ << ", " << ty_ << "> tiles.");
+}
+
+void ComputeClassificationRaster::testTile(size_t tile,
+                                           double zMinimum,
+                                           double angle)
+{
+    double t = std::tan(angle * 0.01745329);
+
+    for (size_t i : tiles_[tile].voxels)
+    {
+        double x = position_[i * 3 + 0];
+        double y = position_[i * 3 + 1];
+        double z = position_[i * 3 + 2];
+
+        double r = t * (z - zMinimum);
+
+        ground_[i] = coneEmpty(x, y, z, r, t) ? 1 : 0;
+    }
+}
+
+bool ComputeClassificationRaster::coneEmpty(double x,
+                                            double y,
+                                            double z,
+                                            double r,
+                                            double t) const
+{
+    if (!(r > 0))
+    {
+        return true;
+    }
+
+    // A voxel [cx, cy, cz] is in the cone when its horizontal distance d
+    // from the apex satisfies d < t * (z - cz).
+    size_t ix1 = cellX(x - r);
+    size_t iy1 = cellY(y - r);
+    size_t ix2 = cellX(x + r);
+    size_t iy2 = cellY(y + r);
+
+    const size_t ts = COMPUTE_CLASSIFICATION_RASTER_TILE;
+    double tileSize = cellSize_ * static_cast<double>(ts);
+
+    for (size_t ty = iy1 / ts; ty <= iy2 / ts; ty++)
+    {
+        for (size_t tx = ix1 / ts; tx <= ix2 / ts; tx++)
+        {
+            // Skip tiles which are too high for any distance to the tile.
+            double tz = tiles_[ty * tx_ + tx].z;
+            if (!(tz < z))
+            {
+                continue;
+            }
+
+            double dx1 = x0_ + static_cast<double>(tx) * tileSize;
+            double dy1 = y0_ + static_cast<double>(ty) * tileSize;
+            double d2 = computeClassificationRasterDistance2(x,
+                                                             y,
+                                                             dx1,
+                                                             dy1,
+                                                             dx1 + tileSize,
+                                                             dy1 + tileSize);
+            double h = t * (z - tz);
+            if (!(d2 < h * h))
+            {
+                continue;
+            }
+
+            // Test the lowest voxel of each cell in the tile.
+            size_t cx2 = std::min(ix2, tx * ts + ts - 1);
+            size_t cy2 = std::min(iy2, ty * ts + ts - 1);
+
+            for (size_t iy = std::max(iy1, ty * ts); iy <= cy2; iy++)
+            {
+                for (size_t ix = std::max(ix1, tx * ts); ix <= cx2; ix++)
+                {
+                    const Cell &cell = cells_[iy * nx_ + ix];
+                    if (!(cell.z < z))
+                    {
+                        continue;
+                    }
+
+                    double cdx = cell.x - x;
+                    double cdy = cell.y - y;
+                    h = t * (z - cell.z);
+                    if (cdx * cdx + cdy * cdy < h * h)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+size_t ComputeClassificationRaster::cellX(double x) const
+{
+    if (!(x > x0_))
+    {
+        return 0;
+    }
+
+    return std::min(static_cast<size_t>((x - x0_) / cellSize_), nx_ - 1);
+}
+
+size_t ComputeClassificationRaster::cellY(double y) const
+{
+    if (!(y > y0_))
+    {
+        return 0;
+    }
+
+    return std::min(static_cast<size_t>((y - y0_) / cellSize_), ny_ - 1);
+}
@@ -0,0 +1,95 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file ComputeClassificationRaster.hpp */
+
+#ifndef COMPUTE_CLASSIFICATION_RASTER_HPP
+#define COMPUTE_CLASSIFICATION_RASTER_HPP
+
+// Include std.
+#include <vector>
+
+// Include 3D Forest.
+#include <Points.hpp>
+
+/** Compute Classification Raster.
+
+    Minimum Z raster of voxels for ground classification. Each raster cell
+    keeps the lowest voxel in its column and each tile of cells keeps the
+    lowest Z of its cells. A voxel is a ground candidate when the cone below
+    the voxel contains no other voxel. Cells and tiles which can not reach
+    into the cone are skipped by their minimum Z. Tiles are independent and
+    can be tested in parallel.
+*/
+class ComputeClassificationRaster
+{
+public:
+    ComputeClassificationRaster();
+
+    void clear();
+
+    /** Create raster from voxel centroids. */
+    void create(const Points &voxels, double cellSize);
+
+    size_t tileSize() const { return tiles_.size(); }
+
+    /** Test cones below voxels in the given tile.
+        The cone apex is at the voxel, it is open downwards to zMinimum and
+        angle is its half-angle in degrees.
+    */
+    void testTile(size_t tile, double zMinimum, double angle);
+
+    bool ground(size_t voxel) const { return ground_[voxel] != 0; }
+
+private:
+    /** Compute Classification Raster Cell. */
+    struct Cell
+    {
+        double x;
+        double y;
+        double z;
+    };
+
+    /** Compute Classification Raster Tile. */
+    struct Tile
+    {
+        double z;
+        std::vector<size_t> voxels;
+    };
+
+    double cellSize_;
+    double x0_;
+    double y0_;
+    size_t nx_;
+    size_t ny_;
+    size_t tx_;
+    size_t ty_;
+
+    std::vector<double> position_;
+    std::vector<Cell> cells_;
+    std::vector<Tile> tiles_;
+    std::vector<uint8_t> ground_;
+
+    bool coneEmpty(double x, double y, double z, double r, double t) const;
+    size_t cellX(double x) const;
+    size_t cellY(double y) const;
+};
+
+#endif /* COMPUTE_CLASSIFICATION_RASTER_HPP */
@@ -36,10 +36,11 @@
 #define COMPUTE_CROWN_VOLUME_STEP_POINTS_TO_VOXELS 0
 #define COMPUTE_CROWN_VOLUME_STEP_CALCULATE_VOLUME 1
 
+#define COMPUTE_CROWN_VOLUME_PAGES_PER_STEP 64
+
 ComputeCrownVolumeAction::ComputeCrownVolumeAction(Editor *editor)
     : editor_(editor),
-      query_(editor),
-      queryPoint_(editor)
+      voxelGrid_(editor)
 {
     LOG_DEBUG(<< "Create.");
 }
@@ -53,9 +54,10 @@ void ComputeCrownVolumeAction::clear()
 {
     LOG_DEBUG(<< "Clear.");
 
-    query_.clear();
+    voxelGrid_.clear();
     grid_.clear();
     treeIdGridMinZ_.clear();
+    crownStart_.clear();
 }
 
 void ComputeCrownVolumeAction::start(
@@ -76,6 +78,27 @@ void ComputeCrownVolumeAction::start(
     grid_.clear();
     treeIdGridMinZ_.clear();
 
+    // Crown points are above crown start height of each tree.
+    crownStart_.clear();
+    const Segments &segments = editor_->segments();
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        const Segment &segment = segments[i];
+        if (segment.id > 0)
+        {
+            crownStart_[segment.id] = segment.boundary.min(2) +
+                                      segment.treeAttributes.crownStartHeight;
+        }
+    }
+
+    // Voxels are created from crown points in the active filter.
+    voxelGrid_.setAttributes({PageData::ATTRIBUTE_SEGMENT});
+    voxelGrid_.start(editor_->viewports().where(),
+                     parameters_.voxelSize,
+                     editor_->boundary().min(),
+                     [this](const Page &page, size_t row) -> size_t
+                     { return crownTree(page, row); });
+
     // Plan the steps.
     progress_.setMaximumStep(nPointsTotal_, 1000);
     progress_.setMaximumSteps({25.0, 25.0, 25.0, 25.0});
@@ -104,39 +127,44 @@ void ComputeCrownVolumeAction::stepPointsToVoxels()
 {
     progress_.startTimer();
 
-    // Initialize.
-    if (progress_.valueStep() == 0)
+    // For each page in filtered datasets, pages are binned in parallel:
+    while (!voxelGrid_.end())
     {
-        // Set query to use active filter.
-        query_.setWhere(editor_->viewports().where());
-        query_.exec();
+        uint64_t nPoints = voxelGrid_.nPoints();
+        voxelGrid_.next(COMPUTE_CROWN_VOLUME_PAGES_PER_STEP);
+
+        progress_.addValueStep(voxelGrid_.nPoints() - nPoints);
+        if (progress_.timedOut())
+        {
+            return;
+        }
     }
 
-    const Segments &segments = editor_->segments();
+    nPointsInFilter_ = voxelGrid_.nPoints();
 
-    // For each point in filtered datasets:
-    while (query_.next())
+    // Collect trees in each grid cell.
+    for (size_t i = 0; i < voxelGrid_.size(); i++)
     {
-        size_t treeId = query_.segment();
-        if (treeId > 0)
+        const VoxelGrid::Voxel &voxel = voxelGrid_[i];
+
+        size_t treeId = voxel.group;
+        int qx = voxel.cell[0];
+        int qy = voxel.cell[1];
+        int qz = voxel.cell[2];
+
+        grid_[{qx, qy, qz}].treeIdList.insert(treeId);
+
+        auto itMin = treeIdGridMinZ_.find(treeId);
+        if (itMin != treeIdGridMinZ_.end())
         {
-            size_t segmentIndex = segments.index(treeId, false);
-            if (segmentIndex != SIZE_MAX)
+            if (qz < itMin->second)
             {
-                const Segment &segment = segments[segmentIndex];
-                double h = query_.z() - segment.boundary.min(2);
-                if (h >= segment.treeAttributes.crownStartHeight)
-                {
-                    // Create new voxel.
-                    createVoxel();
-                }
+                itMin->second = qz;
             }
         }
-
-        progress_.addValueStep(1);
-        if (progress_.timedOut())
+        else
         {
-            return;
+            treeIdGridMinZ_[treeId] = qz;
         }
     }
 
@@ -249,34 +277,16 @@ void ComputeCrownVolumeAction::stepCalculateVolume()
     LOG_DEBUG(<< "Finished calculating volume for trees.");
 }
 
-void ComputeCrownVolumeAction::createVoxel()
+size_t ComputeCrownVolumeAction::crownTree(const Page &page,
+                                           size_t row) const
 {
-    // Initialize new voxel point.
-    size_t treeId = query_.segment();
-
-    const Box<double> &box = editor_->boundary();
-    double xr = query_.x() - box.min(0);
-    double yr = query_.y() - box.min(1);
-    double zr = query_.z() - box.min(2);
+    size_t treeId = page.segment[row];
 
-    double step = parameters_.voxelSize;
-
-    int qx = static_cast<int>(xr / step);
-    int qy = static_cast<int>(yr / step);
-    int qz = static_cast<int>(zr / step);
-
-    grid_[{qx, qy, qz}].treeIdList.insert(treeId);
-
-    auto itMin = treeIdGridMinZ_.find(treeId);
-    if (itMin != treeIdGridMinZ_.end())
-    {
-        if (qz < itMin->second)
-        {
-            itMin->second = qz;
-        }
-    }
-    else
+    auto it = crownStart_.find(treeId);
+    if (it == crownStart_.end() || page.z(row) < it->second)
     {
-        treeIdGridMinZ_[treeId] = qz;
+        return SIZE_MAX;
     }
+
+    return treeId;
 }
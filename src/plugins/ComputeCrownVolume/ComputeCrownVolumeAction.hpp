@@ -29,6 +29,7 @@
 #include <Points.hpp>
 #include <ProgressActionInterface.hpp>
 #include <Query.hpp>
+#include <VoxelGrid.hpp>
 class Editor;
 class Segment;
 
@@ -45,8 +46,7 @@ public:
 
 private:
     Editor *editor_;
-    Query query_;
-    Query queryPoint_;
+    VoxelGrid voxelGrid_;
 
     ComputeCrownVolumeParameters parameters_;
 
@@ -55,12 +55,13 @@ private:
 
     std::map<std::tuple<int, int, int>, ComputeCrownVolumeData> grid_;
     std::map<size_t, int> treeIdGridMinZ_;
+    std::map<size_t, double> crownStart_; // [tree ID : crown base z]
     double ppm_;
 
     void stepPointsToVoxels();
     void stepCalculateVolume();
 
-    void createVoxel();
+    size_t crownTree(const Page &page, size_t row) const;
 };
 
 #endif /* COMPUTE_CROWN_VOLUME_ACTION_HPP */
@@ -43,6 +43,7 @@ ComputeDescriptorAction::ComputeDescriptorAction(Editor *editor)
     : editor_(editor),
       query_(editor),
       queryPoint_(editor),
+      search_(editor),
       pca_()
 {
     LOG_DEBUG(<< "Create.");
@@ -59,6 +60,7 @@ void ComputeDescriptorAction::clear()
 
     query_.clear();
     queryPoint_.clear();
+    search_.clear();
 
     pca_.clear();
 
@@ -234,7 +236,7 @@ void ComputeDescriptorAction::stepNormalize()
             {
                 double descriptor = query_.descriptor();
                 descriptor = (descriptor - descriptorMinimum_) * d;
-                query_.descriptor() = descriptor;
+                query_.descriptor() = static_cast<float>(descriptor);
                 query_.setModified();
             }
 
@@ -268,21 +270,14 @@ void ComputeDescriptorAction::computePoint()
 
     if (parameters_.method == ComputeDescriptorParameters::METHOD_DENSITY)
     {
-        queryPoint_.where().setSphere(query_.x(),
-                                      query_.y(),
-                                      query_.z(),
-                                      parameters_.searchRadius);
-        queryPoint_.exec();
+        search_.radius(searchResult_,
+                       query_.x(),
+                       query_.y(),
+                       query_.z(),
+                       parameters_.searchRadius);
 
-        descriptor = 0.0;
+        descriptor = static_cast<double>(searchResult_.size());
         descriptorCalculated = true;
-        while (queryPoint_.next())
-        {
-            if (query_.voxel() != COMPUTE_DESCRIPTOR_IGNORE)
-            {
-                descriptor += 1.0;
-            }
-        }
     }
     else if (parameters_.method ==
              ComputeDescriptorParameters::METHOD_PCA_INTENSITY)
@@ -307,7 +302,7 @@ void ComputeDescriptorAction::computePoint()
     }
 
     // Update descriptor minimum and maximum values.
-    size_t newValue;
+    uint32_t newValue;
     if (descriptorCalculated)
     {
         if (numberOfPointsWithDescriptor_ == 0)
@@ -347,7 +342,7 @@ void ComputeDescriptorAction::computePoint()
                 queryPoint_.voxel() = newValue;
                 if (newValue == COMPUTE_DESCRIPTOR_FOUND)
                 {
-                    queryPoint_.descriptor() = descriptor;
+                    queryPoint_.descriptor() = static_cast<float>(descriptor);
                 }
                 queryPoint_.setModified();
             }
@@ -358,7 +353,7 @@ void ComputeDescriptorAction::computePoint()
         query_.voxel() = newValue;
         if (newValue == COMPUTE_DESCRIPTOR_FOUND)
         {
-            query_.descriptor() = descriptor;
+            query_.descriptor() = static_cast<float>(descriptor);
         }
         query_.setModified();
     }
@@ -25,6 +25,7 @@
 // Include 3D Forest.
 #include <ComputeDescriptorParameters.hpp>
 #include <ComputeDescriptorPca.hpp>
+#include <PointSearch.hpp>
 #include <ProgressActionInterface.hpp>
 #include <Query.hpp>
 class Editor;
@@ -47,6 +48,8 @@ protected:
     Editor *editor_;
     Query query_;
     Query queryPoint_;
+    PointSearch search_;
+    std::vector<PointSearch::Point> searchResult_;
 
     ComputeDescriptorParameters parameters_;
     ComputeDescriptorPca pca_;
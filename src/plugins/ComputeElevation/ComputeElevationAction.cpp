@@ -17,8 +17,13 @@
     along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+
 /** @file ComputeElevationAction.cpp */
 
+// Include std.
+#include <atomic>
+#include <mutex>
+
 // Include 3D Forest.
 #include <ComputeElevationAction.hpp>
 #include <Editor.hpp>
@@ -29,15 +34,15 @@
 #include <Log.hpp>
 
 #define COMPUTE_ELEVATION_STEP_RESET_POINTS 0
-#define COMPUTE_ELEVATION_STEP_COUNT_POINTS 1
-#define COMPUTE_ELEVATION_STEP_CREATE_GROUND 2
-#define COMPUTE_ELEVATION_STEP_CREATE_INDEX 3
-#define COMPUTE_ELEVATION_STEP_COMPUTE_ELEVATION 4
+#define COMPUTE_ELEVATION_STEP_CREATE_GROUND 1
+#define COMPUTE_ELEVATION_STEP_CREATE_INDEX 2
+#define COMPUTE_ELEVATION_STEP_COMPUTE_ELEVATION 3
+
+#define COMPUTE_ELEVATION_PAGES_PER_STEP 64
 
 ComputeElevationAction::ComputeElevationAction(Editor *editor)
     : editor_(editor),
-      query_(editor),
-      queryPoint_(editor)
+      query_(editor)
 {
     LOG_DEBUG(<< "Create.");
 }
@@ -52,19 +57,18 @@ void ComputeElevationAction::clear()
     LOG_DEBUG(<< "Clear.");
 
     query_.clear();
-    queryPoint_.clear();
 
     voxelRadius_ = 0;
 
-    numberOfPoints_ = 0;
-    numberOfGroundPoints_ = 0;
-    numberOfNonGroundPoints_ = 0;
-    pointIndex_ = 0;
+    nPointsTotal_ = 0;
+    nPointsInFilter_ = 0;
+    nPointsElevation_ = 0;
+    pageIndex_ = 0;
 
     elevationMinimum_ = 0;
     elevationMaximum_ = 0;
 
-    points_.clear();
+    raster_.clear();
 }
 
 void ComputeElevationAction::start(double voxelRadius)
@@ -77,24 +81,21 @@ void ComputeElevationAction::start(double voxelRadius)
     voxelRadius_ = voxelRadius * ppm;
 
     // Clear work data.
-    numberOfPoints_ = editor_->datasets().nPoints();
-    numberOfGroundPoints_ = 0;
-    numberOfNonGroundPoints_ = 0;
-    pointIndex_ = 0;
-    LOG_DEBUG(<< "Total number of points <" << numberOfPoints_ << ">.");
+    nPointsTotal_ = editor_->datasets().nPoints();
+    nPointsInFilter_ = 0;
+    nPointsElevation_ = 0;
+    pageIndex_ = 0;
+    LOG_DEBUG(<< "Total number of points <" << nPointsTotal_ << ">.");
 
     elevationMinimum_ = 0;
     elevationMaximum_ = 0;
 
-    zMinimum_ = editor_->boundary().min(2);
-    LOG_DEBUG(<< "Z minimum_ <" << zMinimum_ << "> maximum <"
-              << editor_->boundary().max(2) << ">.");
-
-    points_.clear();
+    // Ground raster cell has the size of the voxel radius.
+    raster_.create(editor_->boundary(), voxelRadius_);
 
     // Plan the steps.
-    progress_.setMaximumStep(numberOfPoints_, 1000);
-    progress_.setMaximumSteps({14.0, 8.0, 35.0, 1.0, 42.0});
+    progress_.setMaximumStep(nPointsTotal_, 1000);
+    progress_.setMaximumSteps({14.0, 35.0, 1.0, 50.0});
     progress_.setValueSteps(COMPUTE_ELEVATION_STEP_RESET_POINTS);
 }
 
@@ -106,10 +107,6 @@ void ComputeElevationAction::next()
             stepResetPoints();
             break;
 
-        case COMPUTE_ELEVATION_STEP_COUNT_POINTS:
-            stepCountPoints();
-            break;
-
         case COMPUTE_ELEVATION_STEP_CREATE_GROUND:
             stepCreateGround();
             break;
@@ -133,7 +130,7 @@ void ComputeElevationAction::stepResetPoints()
     progress_.startTimer();
 
     // Initialize.
-    if (progress_.valueStep() == 0)
+    if (progress_.valueStep() == 0 && pageIndex_ == 0)
     {
         LOG_DEBUG(<< "Start step reset points.");
 
@@ -146,99 +143,99 @@ void ComputeElevationAction::stepResetPoints()
         query_.exec();
     }
 
-    // Clear each point in all datasets.
-    while (query_.next())
+    // Clear each point in all datasets, pages are processed in parallel.
+    while (pageIndex_ < query_.pageSizeEstimate())
     {
-        query_.voxel() = 0;
-        query_.elevation() = 0;
-        query_.setModified();
+        std::atomic<uint64_t> nPoints(0);
 
-        progress_.addValueStep(1);
-        if (progress_.timedOut())
-        {
-            return;
-        }
-    }
-
-    // Next.
-    // query_.flush();
-    progress_.setMaximumStep(numberOfPoints_, 1000);
-    progress_.setValueSteps(COMPUTE_ELEVATION_STEP_COUNT_POINTS);
-
-    LOG_DEBUG(<< "Finished step reset points.");
-}
-
-void ComputeElevationAction::stepCountPoints()
-{
-    progress_.startTimer();
-
-    // Initialize.
-    if (progress_.valueStep() == 0)
-    {
-        LOG_DEBUG(<< "Start step count points.");
+        pageIndex_ += query_.forEachPage(
+            [&](Page &page, size_t)
+            {
+                page.readAttribute(PageData::ATTRIBUTE_ELEVATION);
 
-        // Set query to use the active filter.
-        query_.setWhere(editor_->viewports().where());
-        query_.exec();
-    }
+                for (size_t i = 0; i < page.selectionSize; i++)
+                {
+                    page.elevation[page.selection[i]] = 0;
+                }
 
-    // Iterate all filtered points.
-    while (query_.next())
-    {
-        if (query_.classification() == LasFile::CLASS_GROUND)
-        {
-            numberOfGroundPoints_++;
-        }
-        else
-        {
-            numberOfNonGroundPoints_++;
-        }
+                page.setModified();
+                nPoints += page.selectionSize;
+            },
+            pageIndex_,
+            COMPUTE_ELEVATION_PAGES_PER_STEP);
 
-        progress_.addValueStep(1);
+        progress_.addValueStep(nPoints);
         if (progress_.timedOut())
         {
             return;
         }
     }
 
-    LOG_DEBUG(<< "Number of ground points <" << numberOfGroundPoints_ << ">.");
-    LOG_DEBUG(<< "Number of non-ground points <" << numberOfNonGroundPoints_
-              << ">.");
+    // Next. Set query to use the active filter.
+    query_.setWhere(editor_->viewports().where());
+    query_.exec();
+    pageIndex_ = 0;
 
-    // Next.
-    query_.reset();
-    progress_.setMaximumStep(numberOfGroundPoints_, 100);
+    progress_.setMaximumStep(nPointsTotal_, 1000);
     progress_.setValueSteps(COMPUTE_ELEVATION_STEP_CREATE_GROUND);
 
-    LOG_DEBUG(<< "Finished step count points.");
+    LOG_DEBUG(<< "Finished step reset points.");
 }
 
 void ComputeElevationAction::stepCreateGround()
 {
     progress_.startTimer();
 
-    if (progress_.valueStep() == 0)
+    if (progress_.valueStep() == 0 && pageIndex_ == 0)
     {
         LOG_DEBUG(<< "Start step create ground.");
     }
 
-    // Iterate all points:
-    while (query_.next())
+    // Add ground points to the raster, pages are processed in parallel.
+    std::mutex mutex;
+
+    while (pageIndex_ < query_.pageSizeEstimate())
     {
-        if (query_.classification() == LasFile::CLASS_GROUND)
-        {
-            // If the current point is classified as ground,
-            // then add it as new ground point.
-            createGroundPoint();
-            progress_.addValueStep(1);
-        }
+        std::atomic<uint64_t> nPoints(0);
+
+        pageIndex_ += query_.forEachPage(
+            [&](Page &page, size_t)
+            {
+                std::vector<std::pair<size_t, double>> ground;
+
+                for (size_t i = 0; i < page.selectionSize; i++)
+                {
+                    size_t row = page.selection[i];
+
+                    if (page.classification[row] == LasFile::CLASS_GROUND)
+                    {
+                        double x = page.x(row);
+                        double y = page.y(row);
+                        ground.push_back({raster_.index(x, y), page.z(row)});
+                    }
+                }
+
+                std::unique_lock<std::mutex> lock(mutex);
+                for (const auto &it : ground)
+                {
+                    raster_.add(it.first, it.second);
+                }
+
+                nPoints += page.selectionSize;
+            },
+            pageIndex_,
+            COMPUTE_ELEVATION_PAGES_PER_STEP);
 
+        nPointsInFilter_ += nPoints;
+        progress_.addValueStep(nPoints);
         if (progress_.timedOut())
         {
             return;
         }
     }
 
+    LOG_DEBUG(<< "Number of points in filter <" << nPointsInFilter_ << ">.");
+
     // Next.
     progress_.setMaximumStep();
     progress_.setValueSteps(COMPUTE_ELEVATION_STEP_CREATE_INDEX);
@@ -250,12 +247,12 @@ void ComputeElevationAction::stepCreateIndex()
 {
     LOG_DEBUG(<< "Start step create index.");
 
-    // Create ground index.
-    points_.createIndex();
+    // Fill ground raster cells without ground points.
+    raster_.fill();
 
     // Next.
-    query_.reset();
-    progress_.setMaximumStep(numberOfNonGroundPoints_, 100);
+    pageIndex_ = 0;
+    progress_.setMaximumStep(nPointsInFilter_, 1000);
     progress_.setValueSteps(COMPUTE_ELEVATION_STEP_COMPUTE_ELEVATION);
 
     LOG_DEBUG(<< "Finished step create index.");
@@ -265,52 +262,87 @@ void ComputeElevationAction::stepComputeElevation()
 {
     progress_.startTimer();
 
-    if (progress_.valueStep() == 0)
+    if (progress_.valueStep() == 0 && pageIndex_ == 0)
     {
         LOG_DEBUG(<< "Start step compute elevation.");
     }
 
-    // Iterate all points:
-    while (query_.next())
+    // Compute elevation above the ground raster, pages are processed in
+    // parallel. Elevation of ground points stays zero.
+    std::mutex mutex;
+
+    while (!raster_.empty() && pageIndex_ < query_.pageSizeEstimate())
     {
-        // If the current point is not classified as ground:
-        if (query_.classification() != LasFile::CLASS_GROUND)
-        {
-            // Find nearest neighbour in ground projection:
-            size_t idx = points_.findNN(query_.x(), query_.y(), zMinimum_);
-            if (idx < points_.size())
+        std::atomic<uint64_t> nPoints(0);
+
+        pageIndex_ += query_.forEachPage(
+            [&](Page &page, size_t)
             {
-                // Compute elevation to this nearest neighbour.
-                double d = query_.z() - points_[idx].elevation;
-                if (d < 0.0)
+                page.readAttribute(PageData::ATTRIBUTE_ELEVATION);
+
+                uint64_t n = 0;
+                double minimum = 0;
+                double maximum = 0;
+
+                for (size_t i = 0; i < page.selectionSize; i++)
                 {
-                    d = 0.0;
+                    size_t row = page.selection[i];
+
+                    if (page.classification[row] == LasFile::CLASS_GROUND)
+                    {
+                        continue;
+                    }
+
+                    double x = page.x(row);
+                    double y = page.y(row);
+                    double d = page.z(row) - raster_.height(x, y);
+                    if (d < 0.0)
+                    {
+                        d = 0.0;
+                    }
+
+                    if (n == 0)
+                    {
+                        minimum = d;
+                        maximum = d;
+                    }
+                    else
+                    {
+                        updateRange(d, minimum, maximum);
+                    }
+                    n++;
+
+                    page.elevation[row] = static_cast<float>(d);
                 }
 
+                page.setModified();
+                nPoints += page.selectionSize;
+
                 // Update min and max elevation.
-                if (pointIndex_ == 0)
-                {
-                    elevationMinimum_ = d;
-                    elevationMaximum_ = d;
-                }
-                else if (d < elevationMinimum_)
-                {
-                    elevationMinimum_ = d;
-                }
-                else if (d > elevationMaximum_)
+                if (n > 0)
                 {
-                    elevationMaximum_ = d;
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if (nPointsElevation_ == 0)
+                    {
+                        elevationMinimum_ = minimum;
+                        elevationMaximum_ = maximum;
+                    }
+                    else
+                    {
+                        updateRange(minimum,
+                                    elevationMinimum_,
+                                    elevationMaximum_);
+                        updateRange(maximum,
+                                    elevationMinimum_,
+                                    elevationMaximum_);
+                    }
+                    nPointsElevation_ += n;
                 }
-                pointIndex_++;
-
-                // Set computed elevation.
-                query_.elevation() = d;
-                query_.setModified();
-            }
-
-            progress_.addValueStep(1);
-        }
+            },
+            pageIndex_,
+            COMPUTE_ELEVATION_PAGES_PER_STEP);
 
+        progress_.addValueStep(nPoints);
         if (progress_.timedOut())
         {
             return;
@@ -331,62 +363,3 @@ void ComputeElevationAction::stepComputeElevation()
 
     LOG_DEBUG(<< "Finished step compute elevation.");
 }
-
-void ComputeElevationAction::createGroundPoint()
-{
-    // If this ground point was already processed, then do nothing.
-    if (query_.voxel() != 0)
-    {
-        return;
-    }
-
-    // Initialize new ground point.
-    Point p;
-    p.x = 0;
-    p.y = 0;
-    p.z = zMinimum_;
-    p.elevation = zMinimum_;
-
-    // Compute point coordinates as average from all neighbour points:
-    size_t n = 0;
-
-    queryPoint_.where().setSphere(query_.x(),
-                                  query_.y(),
-                                  query_.z(),
-                                  voxelRadius_);
-    queryPoint_.exec();
-
-    while (queryPoint_.next())
-    {
-        // Compute only with ground points:
-        if (queryPoint_.classification() == LasFile::CLASS_GROUND)
-        {
-            // Set only x and y point coordinates for 2D ground projection.
-            p.x += queryPoint_.x();
-            p.y += queryPoint_.y();
-
-            // Store maximal z coordinate from all neighbors into elevation.
-            if (queryPoint_.z() > p.elevation)
-            {
-                p.elevation = queryPoint_.z();
-            }
-
-            n++;
-
-            // Mark all used points as processed.
-            queryPoint_.voxel() = 1;
-            queryPoint_.setModified();
-        }
-    }
-
-    if (n < 1)
-    {
-        return;
-    }
-
-    p.x = p.x / static_cast<double>(n);
-    p.y = p.y / static_cast<double>(n);
-
-    // Append new point.
-    points_.push_back(std::move(p));
-}
@@ -23,7 +23,7 @@
 #define COMPUTE_ELEVATION_ACTION_HPP
 
 // Include 3D Forest.
-#include <Points.hpp>
+#include <ComputeElevationRaster.hpp>
 #include <ProgressActionInterface.hpp>
 #include <Query.hpp>
 class Editor;
@@ -45,28 +45,23 @@ public:
 protected:
     Editor *editor_;
     Query query_;
-    Query queryPoint_;
 
     double voxelRadius_;
 
-    uint64_t numberOfPoints_;
-    uint64_t numberOfGroundPoints_;
-    uint64_t numberOfNonGroundPoints_;
-    size_t pointIndex_;
+    uint64_t nPointsTotal_;
+    uint64_t nPointsInFilter_;
+    uint64_t nPointsElevation_;
+    size_t pageIndex_;
 
     double elevationMinimum_;
     double elevationMaximum_;
-    double zMinimum_;
 
-    Points points_;
+    ComputeElevationRaster raster_;
 
     void stepResetPoints();
-    void stepCountPoints();
     void stepCreateGround();
     void stepCreateIndex();
     void stepComputeElevation();
-
-    void createGroundPoint();
 };
 
 #endif /* COMPUTE_ELEVATION_ACTION_HPP */
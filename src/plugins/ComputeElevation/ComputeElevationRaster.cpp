@@ -0,0 +1,209 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file ComputeElevationRaster.cpp */
+
+// Include std.
+#include <algorithm>
+#include <cmath>
+
+// Include 3D Forest.
+#include <ComputeElevationRaster.hpp>
+
+// Include local.
+#define LOG_MODULE_NAME "ComputeElevationRaster"
+#include <Log.hpp>
+
+ComputeElevationRaster::ComputeElevationRaster()
+{
+    clear();
+}
+
+void ComputeElevationRaster::clear()
+{
+    cellSize_ = 1.0;
+    x0_ = 0;
+    y0_ = 0;
+    nx_ = 0;
+    ny_ = 0;
+    nFilled_ = 0;
+
+    height_.clear();
+    height_.shrink_to_fit();
+    filled_.clear();
+    filled_.shrink_to_fit();
+}
+
+void ComputeElevationRaster::create(const Box<double> &boundary,
+                                    double cellSize,
+                                    size_t cellsMaximum)
+{
+    clear();
+
+    if (!(cellSize > 0))
+    {
+        cellSize = 1.0;
+    }
+
+    double lx = boundary.max(0) - boundary.min(0);
+    double ly = boundary.max(1) - boundary.min(1);
+
+    // Limit memory used by large areas with small cells.
+    double nCells = (lx / cellSize + 1.0) * (ly / cellSize + 1.0);
+    double nCellsMaximum = static_cast<double>(cellsMaximum);
+    if (cellsMaximum > 0 && nCells > nCellsMaximum)
+    {
+        cellSize = cellSize * std::sqrt(nCells / nCellsMaximum);
+    }
+
+    cellSize_ = cellSize;
+    x0_ = boundary.min(0);
+    y0_ = boundary.min(1);
+    nx_ = static_cast<size_t>(lx / cellSize_) + 1;
+    ny_ = static_cast<size_t>(ly / cellSize_) + 1;
+
+    height_.resize(nx_ * ny_, 0);
+    filled_.resize(nx_ * ny_, 0);
+
+    LOG_DEBUG(<< "Created raster <" << nx_ << ", " << ny_
+              << "> with cell size <" << cellSize_ << ">.");
+}
+
+size_t ComputeElevationRaster::index(double x, double y) const
+{
+    size_t ix = 0;
+    size_t iy = 0;
+
+    if (x > x0_)
+    {
+        ix = std::min(static_cast<size_t>((x - x0_) / cellSize_), nx_ - 1);
+    }
+
+    if (y > y0_)
+    {
+        iy = std::min(static_cast<size_t>((y - y0_) / cellSize_), ny_ - 1);
+    }
+
+    return iy * nx_ + ix;
+}
+
+void ComputeElevationRaster::add(size_t cell, double z)
+{
+    if (!filled_[cell])
+    {
+        filled_[cell] = 1;
+        height_[cell] = z;
+        nFilled_++;
+    }
+    else if (z > height_[cell])
+    {
+        height_[cell] = z;
+    }
+}
+
+void ComputeElevationRaster::fill()
+{
+    if (nFilled_ == 0 || nFilled_ == height_.size())
+    {
+        return;
+    }
+
+    // Breadth first search from all filled cells. Each empty cell gets
+    // height of the filled cell which reaches it first.
+    std::vector<size_t> queue;
+    queue.reserve(height_.size());
+
+    for (size_t i = 0; i < height_.size(); i++)
+    {
+        if (filled_[i])
+        {
+            queue.push_back(i);
+        }
+    }
+
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        size_t cell = queue[head];
+        size_t ix = cell % nx_;
+        size_t iy = cell / nx_;
+
+        size_t neighbors[4];
+        size_t n = 0;
+
+        if (ix > 0)
+        {
+            neighbors[n++] = cell - 1;
+        }
+        if (ix + 1 < nx_)
+        {
+            neighbors[n++] = cell + 1;
+        }
+        if (iy > 0)
+        {
+            neighbors[n++] = cell - nx_;
+        }
+        if (iy + 1 < ny_)
+        {
+            neighbors[n++] = cell + nx_;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t next = neighbors[i];
+            if (!filled_[next])
+            {
+                filled_[next] = 1;
+                height_[next] = height_[cell];
+                queue.push_back(next);
+            }
+        }
+    }
+
+    nFilled_ = queue.size();
+
+    LOG_DEBUG(<< "Filled raster <" << nFilled_ << "> cells.");
+}
+
+double ComputeElevationRaster::height(double x, double y) const
+{
+    // Position relative to the center of the first cell.
+    double fx = (x - x0_) / cellSize_ - 0.5;
+    double fy = (y - y0_) / cellSize_ - 0.5;
+
+    double mx = static_cast<double>(nx_ - 1);
+    double my = static_cast<double>(ny_ - 1);
+    fx = std::max(0.0, std::min(fx, mx));
+    fy = std::max(0.0, std::min(fy, my));
+
+    size_t ix1 = static_cast<size_t>(fx);
+    size_t iy1 = static_cast<size_t>(fy);
+    size_t ix2 = std::min(ix1 + 1, nx_ - 1);
+    size_t iy2 = std::min(iy1 + 1, ny_ - 1);
+
+    double tx = fx - static_cast<double>(ix1);
+    double ty = fy - static_cast<double>(iy1);
+
+    double z1 = height_[iy1 * nx_ + ix1] * (1.0 - tx) +
+                height_[iy1 * nx_ + ix2] * tx;
+    double z2 = height_[iy2 * nx_ + ix1] * (1.0 - tx) +
+                height_[iy2 * nx_ + ix2] * tx;
+
+    return z1 * (1.0 - ty) + z2 * ty;
+}
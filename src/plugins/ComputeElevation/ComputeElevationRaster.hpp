@@ -0,0 +1,82 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file ComputeElevationRaster.hpp */
+
+#ifndef COMPUTE_ELEVATION_RASTER_HPP
+#define COMPUTE_ELEVATION_RASTER_HPP
+
+// Include std.
+#include <vector>
+
+// Include 3D Forest.
+#include <Box.hpp>
+
+/** Compute Elevation Raster.
+
+    Digital terrain model in a regular 2D grid. Each cell keeps the maximal
+    Z of ground points in the cell. Empty cells are filled from the nearest
+    filled cell. Ground height at any position is bilinear interpolation
+    between centers of the four surrounding cells.
+*/
+class ComputeElevationRaster
+{
+public:
+    ComputeElevationRaster();
+
+    void clear();
+
+    /** Create empty raster which covers the boundary in X and Y.
+        The cell size is increased when the raster would have more than
+        the maximum number of cells.
+    */
+    void create(const Box<double> &boundary,
+                double cellSize,
+                size_t cellsMaximum = 16777216);
+
+    /** Return index of the cell which contains position [x, y]. */
+    size_t index(double x, double y) const;
+
+    /** Add ground height to the cell. */
+    void add(size_t cell, double z);
+
+    /** Fill empty cells from the nearest non-empty cell. */
+    void fill();
+
+    bool empty() const { return nFilled_ == 0; }
+    size_t size() const { return height_.size(); }
+    double cellSize() const { return cellSize_; }
+
+    /** Return interpolated ground height at position [x, y]. */
+    double height(double x, double y) const;
+
+private:
+    double cellSize_;
+    double x0_;
+    double y0_;
+    size_t nx_;
+    size_t ny_;
+    size_t nFilled_;
+
+    std::vector<double> height_;
+    std::vector<char> filled_;
+};
+
+#endif /* COMPUTE_ELEVATION_RASTER_HPP */
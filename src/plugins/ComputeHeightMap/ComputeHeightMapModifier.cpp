@@ -166,6 +166,11 @@ void ComputeHeightMapModifier::applyModifier(Page *page)
     // Process selected points in this page.
     const std::vector<uint32_t> &selection = page->selection;
 
+    if (source_ != SOURCE_Z_POSITION)
+    {
+        page->readAttribute(PageData::ATTRIBUTE_ELEVATION);
+    }
+
     for (size_t i = 0; i < page->selectionSize; i++)
     {
         // Index of next selected point in this page.
@@ -176,7 +181,7 @@ void ComputeHeightMapModifier::applyModifier(Page *page)
 
         if (source_ == SOURCE_Z_POSITION)
         {
-            height = page->position[3 * row + 2]; // z position from xyz.
+            height = page->z(row);
         }
         else
         {
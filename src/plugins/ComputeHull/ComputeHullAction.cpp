@@ -34,15 +34,14 @@
 #define LOG_MODULE_DEBUG_ENABLED 1
 #include <Log.hpp>
 
-#define COMPUTE_HULL_STEP_RESET_POINTS 0
-#define COMPUTE_HULL_STEP_COUNT_POINTS 1
-#define COMPUTE_HULL_STEP_POINTS_TO_VOXELS 2
-#define COMPUTE_HULL_STEP_CALCULATE_HULL 3
+#define COMPUTE_HULL_STEP_POINTS_TO_VOXELS 0
+#define COMPUTE_HULL_STEP_CALCULATE_HULL 1
+
+#define COMPUTE_HULL_PAGES_PER_STEP 64
 
 ComputeHullAction::ComputeHullAction(Editor *editor)
     : editor_(editor),
-      query_(editor),
-      queryPoint_(editor)
+      voxelGrid_(editor)
 {
     LOG_DEBUG(<< "Create.");
 }
@@ -56,7 +55,8 @@ void ComputeHullAction::clear()
 {
     LOG_DEBUG(<< "Clear.");
 
-    query_.clear();
+    voxelGrid_.clear();
+    crownStart_.clear();
     treesMap_.clear();
     trees_.clear();
 }
@@ -79,24 +79,38 @@ void ComputeHullAction::start(const ComputeHullParameters &parameters)
     treesMap_.clear();
     trees_.clear();
 
+    // Crown points are above crown start height of each tree.
+    crownStart_.clear();
+    const Segments &segments = editor_->segments();
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        const Segment &segment = segments[i];
+        if (segment.id > 0)
+        {
+            crownStart_[segment.id] = segment.boundary.min(2) +
+                                      segment.treeAttributes.crownStartHeight;
+        }
+    }
+
+    // Voxels are created from crown points in the active filter. The voxel
+    // edge is the voxel diameter.
+    voxelGrid_.setAttributes({PageData::ATTRIBUTE_SEGMENT});
+    voxelGrid_.start(editor_->viewports().where(),
+                     2.0 * parameters_.voxelRadius,
+                     editor_->boundary().min(),
+                     [this](const Page &page, size_t row) -> size_t
+                     { return crownTree(page, row); });
+
     // Plan the steps.
     progress_.setMaximumStep(nPointsTotal_, 1000);
-    progress_.setMaximumSteps({25.0, 25.0, 25.0, 25.0});
-    progress_.setValueSteps(COMPUTE_HULL_STEP_RESET_POINTS);
+    progress_.setMaximumSteps({50.0, 50.0});
+    progress_.setValueSteps(COMPUTE_HULL_STEP_POINTS_TO_VOXELS);
 }
 
 void ComputeHullAction::next()
 {
     switch (progress_.valueSteps())
     {
-        case COMPUTE_HULL_STEP_RESET_POINTS:
-            stepResetPoints();
-            break;
-
-        case COMPUTE_HULL_STEP_COUNT_POINTS:
-            stepCountPoints();
-            break;
-
         case COMPUTE_HULL_STEP_POINTS_TO_VOXELS:
             stepPointsToVoxels();
             break;
@@ -111,103 +125,34 @@ void ComputeHullAction::next()
     }
 }
 
-void ComputeHullAction::stepResetPoints()
-{
-    progress_.startTimer();
-
-    if (progress_.valueStep() == 0)
-    {
-        LOG_DEBUG(<< "Reset all <" << nPointsTotal_ << "> points.");
-
-        // Set query to iterate all points. Active filter is ignored.
-        query_.setWhere(QueryWhere());
-        query_.exec();
-    }
-
-    // For each point in all datasets:
-    while (query_.next())
-    {
-        // Set point index to voxel to none.
-        query_.voxel() = SIZE_MAX;
-        query_.setModified();
-
-        progress_.addValueStep(1);
-        if (progress_.timedOut())
-        {
-            return;
-        }
-    }
-
-    progress_.setMaximumStep(nPointsTotal_, 1000);
-    progress_.setValueSteps(COMPUTE_HULL_STEP_COUNT_POINTS);
-}
-
-void ComputeHullAction::stepCountPoints()
+void ComputeHullAction::stepPointsToVoxels()
 {
     progress_.startTimer();
 
-    // Initialize.
-    if (progress_.valueStep() == 0)
-    {
-        // Set query to use active filter.
-        query_.setWhere(editor_->viewports().where());
-        query_.exec();
-    }
-
-    // Count the number of filtered points.
-    while (query_.next())
+    // For each page in filtered datasets, pages are binned in parallel:
+    while (!voxelGrid_.end())
     {
-        nPointsInFilter_++;
+        uint64_t nPoints = voxelGrid_.nPoints();
+        voxelGrid_.next(COMPUTE_HULL_PAGES_PER_STEP);
 
-        progress_.addValueStep(1);
+        progress_.addValueStep(voxelGrid_.nPoints() - nPoints);
         if (progress_.timedOut())
         {
             return;
         }
     }
 
-    LOG_DEBUG(<< "Counted <" << nPointsInFilter_ << "> points in filter.");
-
-    query_.reset();
-
-    progress_.setMaximumStep(nPointsInFilter_, 1000);
-    progress_.setValueSteps(COMPUTE_HULL_STEP_POINTS_TO_VOXELS);
-}
-
-void ComputeHullAction::stepPointsToVoxels()
-{
-    progress_.startTimer();
-
-    const Segments &segments = editor_->segments();
+    nPointsInFilter_ = voxelGrid_.nPoints();
 
-    // For each point in filtered datasets:
-    while (query_.next())
+    // Append voxel centroids to voxel arrays of trees.
+    for (size_t i = 0; i < voxelGrid_.size(); i++)
     {
-        // If point index to voxel is none:
-        if (query_.voxel() == SIZE_MAX)
-        {
-            size_t treeId = query_.segment();
-            if (treeId > 0)
-            {
-                size_t segmentIndex = segments.index(treeId, false);
-                if (segmentIndex != SIZE_MAX)
-                {
-                    const Segment &segment = segments[segmentIndex];
-                    double h = query_.z() - segment.boundary.min(2);
-                    if (h >= segment.treeAttributes.crownStartHeight)
-                    {
-                        // Create new voxel.
-                        createVoxel();
-                    }
-                }
-            }
-        }
+        const VoxelGrid::Voxel &voxel = voxelGrid_[i];
 
-        progress_.addValueStep(1);
-        if (progress_.timedOut())
-        {
-            return;
-        }
+        ComputeHullData &tree = trees_[treeIndex(voxel.group)];
+        tree.points.push_back(voxel.x);
+        tree.points.push_back(voxel.y);
+        tree.points.push_back(voxel.z);
     }
 
     progress_.setMaximumStep(trees_.size(), 1);
@@ -346,53 +291,15 @@ size_t ComputeHullAction::treeIndex(size_t treeId)
     return it->second;
 }
 
-void ComputeHullAction::createVoxel()
+size_t ComputeHullAction::crownTree(const Page &page, size_t row) const
 {
-    // Initialize new voxel point.
-    size_t treeId = query_.segment();
-    double x = 0;
-    double y = 0;
-    double z = 0;
-
-    // Compute point coordinates as average from all neighbour points.
-    // Set value of each neighbour point to index of new voxel.
-    size_t n = 0;
-
-    queryPoint_.where().setSphere(query_.x(),
-                                  query_.y(),
-                                  query_.z(),
-                                  parameters_.voxelRadius);
-    queryPoint_.exec();
-
-    while (queryPoint_.next())
-    {
-        if (queryPoint_.segment() != treeId)
-        {
-            continue;
-        }
-
-        x += queryPoint_.x();
-        y += queryPoint_.y();
-        z += queryPoint_.z();
+    size_t treeId = page.segment[row];
 
-        n++;
-
-        queryPoint_.voxel() = 1;
-        queryPoint_.setModified();
-    }
-
-    if (n < 1)
+    auto it = crownStart_.find(treeId);
+    if (it == crownStart_.end() || page.z(row) < it->second)
     {
-        return;
+        return SIZE_MAX;
     }
 
-    x = x / static_cast<double>(n);
-    y = y / static_cast<double>(n);
-    z = z / static_cast<double>(n);
-
-    // Append new voxel to voxel array.
-    ComputeHullData &tree = trees_[treeIndex(treeId)];
-    tree.points.push_back(x);
-    tree.points.push_back(y);
-    tree.points.push_back(z);
+    return treeId;
 }
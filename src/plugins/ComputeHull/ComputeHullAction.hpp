@@ -29,6 +29,7 @@
 #include <Points.hpp>
 #include <ProgressActionInterface.hpp>
 #include <Query.hpp>
+#include <VoxelGrid.hpp>
 class Editor;
 class Segment;
 
@@ -45,21 +46,19 @@ public:
 
 private:
     Editor *editor_;
-    Query query_;
-    Query queryPoint_;
+    VoxelGrid voxelGrid_;
 
     ComputeHullParameters parameters_;
 
     uint64_t nPointsTotal_;
     uint64_t nPointsInFilter_;
 
-    std::map<size_t, size_t> treesMap_; // [tree ID : tree index]
+    std::map<size_t, double> crownStart_; // [tree ID : crown base z]
+    std::map<size_t, size_t> treesMap_;   // [tree ID : tree index]
     std::vector<ComputeHullData> trees_;
 
     size_t currentTreeIndex_;
 
-    void stepResetPoints();
-    void stepCountPoints();
     void stepPointsToVoxels();
     void stepCalculateHull();
 
@@ -70,8 +69,7 @@ private:
     void calculateAlphaShape2(Segment &segment, const ComputeHullData &data);
 
     size_t treeIndex(size_t treeId);
-
-    void createVoxel();
+    size_t crownTree(const Page &page, size_t row) const;
 };
 
 #endif /* COMPUTE_HULL_ACTION_HPP */
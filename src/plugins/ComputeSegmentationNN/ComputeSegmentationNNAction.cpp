@@ -30,18 +30,19 @@
 #include <Log.hpp>
 
 #define COMPUTE_SEGMENTATION_NN_STEP_RESET_POINTS 0
-#define COMPUTE_SEGMENTATION_NN_STEP_COUNT_POINTS 1
-#define COMPUTE_SEGMENTATION_NN_STEP_POINTS_TO_VOXELS 2
-#define COMPUTE_SEGMENTATION_NN_STEP_CREATE_VOXEL_INDEX 3
-#define COMPUTE_SEGMENTATION_NN_STEP_CREATE_TRUNKS 4
-#define COMPUTE_SEGMENTATION_NN_STEP_CREATE_BRANCHES 5
-#define COMPUTE_SEGMENTATION_NN_STEP_CREATE_SEGMENTS 6
-#define COMPUTE_SEGMENTATION_NN_STEP_VOXELS_TO_POINTS 7
+#define COMPUTE_SEGMENTATION_NN_STEP_POINTS_TO_VOXELS 1
+#define COMPUTE_SEGMENTATION_NN_STEP_CREATE_VOXEL_INDEX 2
+#define COMPUTE_SEGMENTATION_NN_STEP_CREATE_TRUNKS 3
+#define COMPUTE_SEGMENTATION_NN_STEP_CREATE_BRANCHES 4
+#define COMPUTE_SEGMENTATION_NN_STEP_CREATE_SEGMENTS 5
+#define COMPUTE_SEGMENTATION_NN_STEP_VOXELS_TO_POINTS 6
+
+#define COMPUTE_SEGMENTATION_NN_PAGES_PER_STEP 64
 
 ComputeSegmentationNNAction::ComputeSegmentationNNAction(Editor *editor)
     : editor_(editor),
       query_(editor),
-      queryPoint_(editor)
+      voxelGrid_(editor)
 {
     LOG_DEBUG(<< "Create.");
 }
@@ -56,7 +57,7 @@ void ComputeSegmentationNNAction::clear()
     LOG_DEBUG(<< "Clear.");
 
     query_.clear();
-    queryPoint_.clear();
+    voxelGrid_.clear();
 
     nPointsTotal_ = 0;
     nPointsInFilter_ = 0;
@@ -103,7 +104,7 @@ void ComputeSegmentationNNAction::start(
 
     // Plan the steps.
     progress_.setMaximumStep(nPointsTotal_, 1000);
-    progress_.setMaximumSteps({4.0, 1.0, 24.0, 1.0, 25.0, 35.0, 1.0, 9.0});
+    progress_.setMaximumSteps({4.0, 25.0, 1.0, 25.0, 35.0, 1.0, 9.0});
     progress_.setValueSteps(COMPUTE_SEGMENTATION_NN_STEP_RESET_POINTS);
 }
 
@@ -115,10 +116,6 @@ void ComputeSegmentationNNAction::next()
             stepResetPoints();
             break;
 
-        case COMPUTE_SEGMENTATION_NN_STEP_COUNT_POINTS:
-            stepCountPoints();
-            break;
-
         case COMPUTE_SEGMENTATION_NN_STEP_POINTS_TO_VOXELS:
             stepPointsToVoxels();
             break;
@@ -177,9 +174,6 @@ void ComputeSegmentationNNAction::stepResetPoints()
     // For each point in all datasets:
     while (query_.next())
     {
-        // Set point index to voxel to none.
-        query_.voxel() = SIZE_MAX;
-
         // Set point segment to 'unsegmented' segment.
         query_.segment() = 0;
 
@@ -192,39 +186,31 @@ void ComputeSegmentationNNAction::stepResetPoints()
         }
     }
 
-    progress_.setMaximumStep(nPointsTotal_, 1000);
-    progress_.setValueSteps(COMPUTE_SEGMENTATION_NN_STEP_COUNT_POINTS);
-}
-
-void ComputeSegmentationNNAction::stepCountPoints()
-{
-    progress_.startTimer();
-
-    // Initialize.
-    if (progress_.valueStep() == 0)
+    // Voxels are created from points in the active filter. The voxel edge
+    // is the voxel diameter.
+    std::vector<PageData::Attribute> attributes;
+    attributes.push_back(PageData::ATTRIBUTE_ELEVATION);
+    if (parameters_.leafToWoodChannel ==
+        ComputeSegmentationNNParameters::CHANNEL_DESCRIPTOR)
     {
-        // Set query to use active filter.
-        query_.setWhere(editor_->viewports().where());
-        query_.exec();
+        attributes.push_back(PageData::ATTRIBUTE_DESCRIPTOR);
     }
 
-    // Count the number of filtered points.
-    while (query_.next())
-    {
-        nPointsInFilter_++;
-
-        progress_.addValueStep(1);
-        if (progress_.timedOut())
+    voxelGrid_.setAttributes(attributes);
+    voxelGrid_.start(
+        editor_->viewports().where(),
+        2.0 * parameters_.voxelRadius,
+        editor_->boundary().min(),
+        [this](const Page &page, size_t row) -> size_t
         {
-            return;
-        }
-    }
-
-    LOG_DEBUG(<< "Counted <" << nPointsInFilter_ << "> points in filter.");
-
-    query_.reset();
+            if (voxelPoint(page.classification[row], page.elevation[row]))
+            {
+                return 0;
+            }
+            return SIZE_MAX;
+        });
 
-    progress_.setMaximumStep(nPointsInFilter_, 1000);
+    progress_.setMaximumStep(nPointsTotal_, 1000);
     progress_.setValueSteps(COMPUTE_SEGMENTATION_NN_STEP_POINTS_TO_VOXELS);
 }
 
@@ -232,30 +218,46 @@ void ComputeSegmentationNNAction::stepPointsToVoxels()
 {
     progress_.startTimer();
 
-    // For each point in filtered datasets:
-    while (query_.next())
+    // For each page in filtered datasets, pages are binned in parallel:
+    while (!voxelGrid_.end())
     {
-        // If point index to voxel is none:
-        if (query_.voxel() == SIZE_MAX &&
-            query_.classification() != LasFile::CLASS_GROUND &&
-            (parameters_.zCoordinatesAsElevation ||
-             (query_.elevation() >= parameters_.treeBaseElevationMin)))
-        {
-            // Create new voxel.
-            createVoxel();
-        }
+        uint64_t nPoints = voxelGrid_.nPoints();
+        voxelGrid_.next(COMPUTE_SEGMENTATION_NN_PAGES_PER_STEP);
 
-        progress_.addValueStep(1);
+        progress_.addValueStep(voxelGrid_.nPoints() - nPoints);
         if (progress_.timedOut())
         {
             return;
         }
     }
 
-    LOG_DEBUG(<< "Created <" << voxels_.size() << "> voxels.");
-    // voxels_.exportToFile("voxels.json");
+    nPointsInFilter_ = voxelGrid_.nPoints();
+
+    // Append voxel centroids to voxel array in the order of grid voxels.
+    bool descriptor = parameters_.leafToWoodChannel ==
+                      ComputeSegmentationNNParameters::CHANNEL_DESCRIPTOR;
+
+    for (size_t i = 0; i < voxelGrid_.size(); i++)
+    {
+        const VoxelGrid::Voxel &voxel = voxelGrid_[i];
+
+        Point p;
+        p.x = voxel.x;
+        p.y = voxel.y;
+        p.z = voxel.z;
+        p.elevation = voxel.elevation;
+        p.descriptor = descriptor ? voxel.descriptor : voxel.intensity;
+        p.dist = 0;
+        p.next = SIZE_MAX;
+        p.group = SIZE_MAX;
+        p.status = 0;
+
+        voxels_.push_back(std::move(p));
+    }
 
-    query_.reset();
+    LOG_DEBUG(<< "Created <" << voxels_.size() << "> voxels from <"
+              << nPointsInFilter_ << "> points.");
+    // voxels_.exportToFile("voxels.json");
 
     progress_.setMaximumStep(voxels_.size(), 100);
     progress_.setValueSteps(COMPUTE_SEGMENTATION_NN_STEP_CREATE_VOXEL_INDEX);
@@ -322,19 +324,21 @@ void ComputeSegmentationNNAction::stepCreateTrunks()
                 groupPath_.push_back(path_[i]);
             }
 
+            // Find neighbor voxels of the whole path at once.
+            voxels_.findRadius(path_,
+                               parameters_.searchRadiusTrunkPoints,
+                               searchOffsets_,
+                               search_);
+
             // Set the path empty.
             path_.resize(0);
 
             // Try to expand the current group with neighbor voxels:
             for (size_t i = idx; i < groupPath_.size(); i++)
             {
-                Point &a = voxels_[groupPath_[i]];
-                voxels_.findRadius(a.x,
-                                   a.y,
-                                   a.z,
-                                   parameters_.searchRadiusTrunkPoints,
-                                   search_);
-                for (size_t j = 0; j < search_.size(); j++)
+                size_t from = searchOffsets_[i - idx];
+                size_t to = searchOffsets_[i - idx + 1];
+                for (size_t j = from; j < to; j++)
                 {
                     Point &b = voxels_[search_[j]];
                     // If a voxel in search radius is not processed and meets
@@ -505,14 +509,17 @@ void ComputeSegmentationNNAction::stepCreateBranches()
                     // Update nearest neighbors in the path.
                     // Find new nearest unprocessed neighbor V.next for all
                     // voxels which have V.next equal to U.
+                    update_.resize(0);
                     for (size_t i = 0; i < path_.size(); i++)
                     {
-                        Point &b = voxels_[path_[i]];
+                        const Point &b = voxels_[path_[i]];
                         if (b.next != SIZE_MAX && b.next == nextIdx)
                         {
-                            findNearestNeighbor(b);
+                            update_.push_back(path_[i]);
                         }
                     }
+
+                    findNearestNeighbors(update_);
                 }
             }
         }
@@ -533,6 +540,10 @@ void ComputeSegmentationNNAction::stepVoxelsToPoints()
 
     if (progress_.valueStep() == 0)
     {
+        // Set query to use active filter.
+        query_.setWhere(editor_->viewports().where());
+        query_.exec();
+
         // Set segment id to all final groups.
         size_t segmentId = 1;
         for (auto &it : groups_)
@@ -547,7 +558,12 @@ void ComputeSegmentationNNAction::stepVoxelsToPoints()
     while (query_.next())
     {
         // If point belongs to some voxel:
-        size_t pointIndex = query_.voxel();
+        size_t pointIndex = SIZE_MAX;
+        if (voxelPoint(query_.classification(), query_.elevation()))
+        {
+            pointIndex = voxelGrid_.index(query_.x(), query_.y(), query_.z());
+        }
+
         if (pointIndex < voxels_.size())
         {
             // If voxel's group belongs to a segment:
@@ -556,7 +572,7 @@ void ComputeSegmentationNNAction::stepVoxelsToPoints()
             if (it != groups_.end())
             {
                 // Set point segment to the same value as voxel segment.
-                query_.segment() = it->second.segmentId;
+                query_.segment() = static_cast<uint32_t>(it->second.segmentId);
                 query_.setModified();
 
                 // Extend group boundary.
@@ -615,99 +631,49 @@ void ComputeSegmentationNNAction::stepCreateSegments()
     progress_.setValueSteps(progress_.maximumSteps());
 }
 
-void ComputeSegmentationNNAction::createVoxel()
+bool ComputeSegmentationNNAction::voxelPoint(uint8_t classification,
+                                             double elevation) const
 {
-    // Mark index of new voxel in voxel array.
-    size_t idx = voxels_.size();
-
-    // Initialize new voxel point.
-    Point p;
-    p.x = 0;
-    p.y = 0;
-    p.z = 0;
-    p.elevation = 0;
-    p.descriptor = 0;
-    p.dist = 0;
-    p.next = SIZE_MAX;
-    p.group = SIZE_MAX;
-    p.status = 0;
-
-    // Compute point coordinates as average from all neighbour points.
-    // Set value of each neighbour point to index of new voxel.
-    size_t n = 0;
-
-    queryPoint_.where().setSphere(query_.x(),
-                                  query_.y(),
-                                  query_.z(),
-                                  parameters_.voxelRadius);
-    queryPoint_.exec();
-
-    while (queryPoint_.next())
-    {
-        if (queryPoint_.classification() == LasFile::CLASS_GROUND)
-        {
-            continue;
-        }
-
-        p.x += queryPoint_.x();
-        p.y += queryPoint_.y();
-        p.z += queryPoint_.z();
-        p.elevation += queryPoint_.elevation();
+    return classification != LasFile::CLASS_GROUND &&
+           (parameters_.zCoordinatesAsElevation ||
+            elevation >= parameters_.treeBaseElevationMin);
+}
 
-        if (parameters_.leafToWoodChannel ==
-            ComputeSegmentationNNParameters::CHANNEL_DESCRIPTOR)
-        {
-            if (queryPoint_.descriptor() > p.descriptor)
-            {
-                p.descriptor = queryPoint_.descriptor();
-            }
-        }
-        else if (parameters_.leafToWoodChannel ==
-                 ComputeSegmentationNNParameters::CHANNEL_INTENSITY)
-        {
-            if (queryPoint_.intensity() > p.descriptor)
-            {
-                p.descriptor = queryPoint_.intensity();
-            }
-        }
-        else
-        {
-            THROW("ComputeSegmentationNNParameters leafToWoodChannel not "
-                  "implemented.");
-        }
+void ComputeSegmentationNNAction::findNearestNeighbor(Point &a)
+{
+    voxels_.findRadius(a.x,
+                       a.y,
+                       a.z,
+                       parameters_.searchRadiusLeafPoints,
+                       search_);
 
-        n++;
+    setNearestNeighbor(a, 0, search_.size());
+}
 
-        queryPoint_.voxel() = idx;
-        queryPoint_.setModified();
-    }
+void ComputeSegmentationNNAction::findNearestNeighbors(
+    const std::vector<size_t> &voxels)
+{
+    voxels_.findRadius(voxels,
+                       parameters_.searchRadiusLeafPoints,
+                       searchOffsets_,
+                       search_);
 
-    if (n < 1)
+    for (size_t i = 0; i < voxels.size(); i++)
     {
-        return;
+        setNearestNeighbor(voxels_[voxels[i]],
+                           searchOffsets_[i],
+                           searchOffsets_[i + 1]);
     }
-
-    p.x = p.x / static_cast<double>(n);
-    p.y = p.y / static_cast<double>(n);
-    p.z = p.z / static_cast<double>(n);
-    p.elevation = p.elevation / static_cast<double>(n);
-
-    // Append new voxel to voxel array.
-    voxels_.push_back(std::move(p));
 }
 
-void ComputeSegmentationNNAction::findNearestNeighbor(Point &a)
+void ComputeSegmentationNNAction::setNearestNeighbor(Point &a,
+                                                     size_t from,
+                                                     size_t to)
 {
     a.dist = std::numeric_limits<double>::max();
     a.next = SIZE_MAX;
 
-    voxels_.findRadius(a.x,
-                       a.y,
-                       a.z,
-                       parameters_.searchRadiusLeafPoints,
-                       search_);
-
-    for (size_t j = 0; j < search_.size(); j++)
+    for (size_t j = from; j < to; j++)
     {
         Point &b = voxels_[search_[j]];
 
@@ -28,6 +28,7 @@
 #include <Points.hpp>
 #include <ProgressActionInterface.hpp>
 #include <Query.hpp>
+#include <VoxelGrid.hpp>
 class Editor;
 class Segment;
 
@@ -45,7 +46,7 @@ public:
 private:
     Editor *editor_;
     Query query_;
-    Query queryPoint_;
+    VoxelGrid voxelGrid_;
 
     ComputeSegmentationNNParameters parameters_;
 
@@ -53,7 +54,6 @@ private:
     uint64_t nPointsInFilter_;
 
     void stepResetPoints();
-    void stepCountPoints();
     void stepPointsToVoxels();
     void stepCreateVoxelIndex();
     void stepCreateTrunks();
@@ -61,13 +61,17 @@ private:
     void stepCreateSegments();
     void stepVoxelsToPoints();
 
-    void createVoxel();
+    bool voxelPoint(uint8_t classification, double elevation) const;
     void findNearestNeighbor(Point &a);
+    void findNearestNeighbors(const std::vector<size_t> &voxels);
+    void setNearestNeighbor(Point &a, size_t from, size_t to);
     bool trunkVoxel(const Point &a);
 
     Points voxels_;
     std::vector<size_t> path_;
     std::vector<size_t> groupPath_;
+    std::vector<size_t> update_;
+    std::vector<size_t> searchOffsets_;
     std::vector<size_t> search_;
     size_t pointIndex_;
     size_t groupId_;
@@ -36,7 +36,7 @@ void EditPluginResetElevation::run(MainWindow *mainWindow)
 {
     LOG_DEBUG(<< "Start resetting elevation values.");
 
-    double newElevationValue = 0.0;
+    float newElevationValue = 0.0F;
 
     // Editor.
     mainWindow->suspendThreads();
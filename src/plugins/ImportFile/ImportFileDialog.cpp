@@ -27,6 +27,7 @@
 
 // Include Qt.
 #include <QCheckBox>
+#include <QComboBox>
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
@@ -75,6 +76,15 @@ ImportFileDialog::ImportFileDialog(MainWindow *mainWindow)
     randomizePointsCheckBox_ = new QCheckBox;
     randomizePointsCheckBox_->setChecked(true);
 
+    randomizeMethodComboBox_ = new QComboBox;
+    randomizeMethodComboBox_->addItem(tr("Block shuffle"));
+    randomizeMethodComboBox_->addItem(tr("Stride"));
+    randomizeMethodComboBox_->setCurrentIndex(0);
+    connect(randomizePointsCheckBox_,
+            SIGNAL(toggled(bool)),
+            randomizeMethodComboBox_,
+            SLOT(setEnabled(bool)));
+
     copyExtraBytesCheckBox_ = new QCheckBox;
     copyExtraBytesCheckBox_->setChecked(true);
 
@@ -86,6 +96,9 @@ ImportFileDialog::ImportFileDialog(MainWindow *mainWindow)
     lfo->addWidget(new QLabel(tr("Randomize points")), row, 0);
     lfo->addWidget(randomizePointsCheckBox_, row, 1);
     row++;
+    lfo->addWidget(new QLabel(tr("Randomization method")), row, 0);
+    lfo->addWidget(randomizeMethodComboBox_, row, 1);
+    row++;
     lfo->addWidget(new QLabel(tr("Copy extra bytes")), row, 0);
     lfo->addWidget(copyExtraBytesCheckBox_, row, 1);
     row++;
@@ -162,6 +175,14 @@ ImportSettings ImportFileDialog::settings() const
     settings.convertToVersion1Dot4 =
         convertToVersion1Dot4CheckBox_->isChecked();
     settings.randomizePoints = randomizePointsCheckBox_->isChecked();
+    if (randomizeMethodComboBox_->currentIndex() == 1)
+    {
+        settings.randomizeMethod = ImportSettings::RandomizeMethod::STRIDE;
+    }
+    else
+    {
+        settings.randomizeMethod = ImportSettings::RandomizeMethod::SHUFFLE;
+    }
     settings.copyExtraBytes = copyExtraBytesCheckBox_->isChecked();
 
     return settings;
@@ -188,6 +209,11 @@ void ImportFileDialog::slotHelp()
         " to prevent eye popping artifacts caused displaying subsets"
         " of points by level of details. It is possible to uncheck this "
         " option if a file was already randomized.</li>"
+        "<li><b>Randomization method</b> -"
+        " <i>Block shuffle</i> reads the input file by large sequential"
+        " blocks and shuffles the points in memory. <i>Stride</i> reads"
+        " the points one by one with a fixed skip. It is much slower and"
+        " it is kept for comparison of the level of details.</li>"
         "<li><b>Copy extra bytes</b> -"
         " If this option is checked, then the import process preservers"
         " all extra bytes in each point which are stored beyond the size"
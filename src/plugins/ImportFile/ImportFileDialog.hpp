@@ -30,6 +30,7 @@ class InfoDialog;
 // Include Qt.
 #include <QDialog>
 class QCheckBox;
+class QComboBox;
 class QPushButton;
 
 /** Import File Dialog. */
@@ -55,6 +56,7 @@ protected:
 
     QCheckBox *convertToVersion1Dot4CheckBox_;
     QCheckBox *randomizePointsCheckBox_;
+    QComboBox *randomizeMethodComboBox_;
     QCheckBox *copyExtraBytesCheckBox_;
 
     QPushButton *helpButton_;
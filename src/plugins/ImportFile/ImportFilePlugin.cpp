@@ -369,7 +369,7 @@ static void importPluginAddAsNewTree(const std::string &path,
 
     while (query.next())
     {
-        query.segment() = segmentId;
+        query.segment() = static_cast<uint32_t>(segmentId);
         query.setModified();
 
         i++;